@@ -96,16 +96,143 @@ function calculateDefocusBlur(sphere, cylinder, distanceCm, pupilDiameterMm = 4)
     };
 }
 
+// ========== KERNEL REPRESENTATION ==========
+
+/**
+ * Kernels are flat, row-major Float32Arrays:
+ *   { width, height, data: Float32Array, row: Float32Array|null, col: Float32Array|null }
+ * When `row` and `col` are set the kernel is separable (data[y][x] = col[y] * row[x])
+ * and applyKernel runs two 1D passes, O(k) per pixel instead of O(k²).
+ */
+
+/**
+ * Build a flat kernel from row-major values
+ *
+ * @param {number} width - Kernel width (odd)
+ * @param {number} height - Kernel height (odd)
+ * @param {Float32Array} data - width * height values
+ * @returns {Object} Kernel, with separable factors when it is rank 1
+ */
+function createKernel(width, height, data) {
+    const kernel = { width, height, data, row: null, col: null };
+    const factors = findSeparableFactors(kernel);
+    if (factors) {
+        kernel.row = factors.row;
+        kernel.col = factors.col;
+    }
+    return kernel;
+}
+
+/**
+ * Build a separable kernel directly from its 1D factors
+ *
+ * @param {Float32Array} row - Horizontal taps (odd length)
+ * @param {Float32Array} col - Vertical taps (odd length)
+ * @returns {Object} Kernel
+ */
+function createSeparableKernel(row, col) {
+    const data = new Float32Array(row.length * col.length);
+    for (let y = 0; y < col.length; y++) {
+        for (let x = 0; x < row.length; x++) {
+            data[y * row.length + x] = col[y] * row[x];
+        }
+    }
+    return { width: row.length, height: col.length, data, row, col };
+}
+
+/**
+ * Rank-1 test: if every row is a multiple of the pivot row, return the factors
+ *
+ * @param {Object} kernel - Flat kernel
+ * @param {number} tolerance - Max residual relative to the largest tap
+ * @returns {{row: Float32Array, col: Float32Array}|null} Factors, or null when not separable
+ */
+function findSeparableFactors(kernel, tolerance = 1e-5) {
+    const { width, height, data } = kernel;
+
+    // Pivot on the largest-magnitude tap for numerical stability
+    let pivot = 0;
+    for (let i = 1; i < data.length; i++) {
+        if (Math.abs(data[i]) > Math.abs(data[pivot])) pivot = i;
+    }
+    const scale = data[pivot];
+    if (scale === 0) return null;
+
+    const px = pivot % width;
+    const py = Math.floor(pivot / width);
+    const row = new Float32Array(width);
+    const col = new Float32Array(height);
+    for (let x = 0; x < width; x++) row[x] = data[py * width + x] / scale;
+    for (let y = 0; y < height; y++) col[y] = data[y * width + px];
+
+    const limit = Math.abs(scale) * tolerance;
+    for (let y = 0; y < height; y++) {
+        for (let x = 0; x < width; x++) {
+            if (Math.abs(data[y * width + x] - col[y] * row[x]) > limit) return null;
+        }
+    }
+
+    return { row, col };
+}
+
+/**
+ * Convert a nested-array kernel (older API) to the flat representation
+ *
+ * @param {Object|Array<Array<number>>} kernel - Flat kernel or 2D array
+ * @returns {Object} Flat kernel
+ */
+function toKernel(kernel) {
+    if (!Array.isArray(kernel)) return kernel;
+
+    const height = kernel.length;
+    const width = kernel[0].length;
+    const data = new Float32Array(width * height);
+    for (let y = 0; y < height; y++) {
+        for (let x = 0; x < width; x++) {
+            data[y * width + x] = kernel[y][x];
+        }
+    }
+    return createKernel(width, height, data);
+}
+
+/**
+ * Normalized 1D Gaussian taps
+ *
+ * @param {number} sigma - Standard deviation in pixels
+ * @param {number} size - Number of taps (odd)
+ * @returns {Float32Array} Taps summing to 1
+ */
+function gaussian1D(sigma, size) {
+    const taps = new Float32Array(size);
+    if (sigma <= 0) {
+        taps[Math.floor(size / 2)] = 1;
+        return taps;
+    }
+
+    const center = Math.floor(size / 2);
+    let sum = 0;
+    for (let i = 0; i < size; i++) {
+        const d = i - center;
+        taps[i] = Math.exp(-(d * d) / (2 * sigma * sigma));
+        sum += taps[i];
+    }
+    for (let i = 0; i < size; i++) {
+        taps[i] /= sum;
+    }
+    return taps;
+}
+
 // ========== KERNEL GENERATION ==========
 
 /**
  * Generate a Gaussian blur kernel for simulating defocus
  * 
  * Gaussian function: G(x,y) = (1/(2πσ²)) * exp(-(x²+y²)/(2σ²))
+ * G(x,y) = g(x)·g(y), so the kernel is built directly in separable form.
  * 
  * @param {number} sigma - Standard deviation (related to blur radius)
  * @param {number} size - Kernel size (should be odd, e.g., 5, 7, 9)
- * @returns {Array<Array<number>>} 2D Gaussian kernel
+ * @returns {Object} Separable flat kernel
  */
 function generateGaussianKernel(sigma, size = null) {
     // Auto-calculate size if not provided
@@ -114,40 +241,19 @@ function generateGaussianKernel(sigma, size = null) {
         if (size < 3) size = 3;
     }
     
-    const kernel = [];
-    const center = Math.floor(size / 2);
-    let sum = 0;
-    
-    // Generate Gaussian values
-    for (let y = 0; y < size; y++) {
-        kernel[y] = [];
-        for (let x = 0; x < size; x++) {
-            const dx = x - center;
-            const dy = y - center;
-            const value = Math.exp(-(dx * dx + dy * dy) / (2 * sigma * sigma));
-            kernel[y][x] = value;
-            sum += value;
-        }
-    }
-    
-    // Normalize kernel so sum = 1
-    for (let y = 0; y < size; y++) {
-        for (let x = 0; x < size; x++) {
-            kernel[y][x] /= sum;
-        }
-    }
-    
-    return kernel;
+    const taps = gaussian1D(sigma, size);
+    return createSeparableKernel(taps, taps);
 }
 
 /**
  * Generate an anisotropic Gaussian kernel for astigmatism correction
+ * Axis-aligned orientations (multiples of 90°) come out separable.
  * 
  * @param {number} sigmaH - Horizontal blur standard deviation
  * @param {number} sigmaV - Vertical blur standard deviation
  * @param {number} angle - Rotation angle in radians
  * @param {number} size - Kernel size
- * @returns {Array<Array<number>>} 2D anisotropic Gaussian kernel
+ * @returns {Object} Flat kernel
  */
 function generateAnisotropicKernel(sigmaH, sigmaV, angle = 0, size = null) {
     if (size === null) {
@@ -155,15 +261,22 @@ function generateAnisotropicKernel(sigmaH, sigmaV, angle = 0, size = null) {
         if (size < 3) size = 3;
     }
     
-    const kernel = [];
-    const center = Math.floor(size / 2);
-    let sum = 0;
-    
     const cos_a = Math.cos(angle);
     const sin_a = Math.sin(angle);
     
+    // Axis-aligned: the rotated Gaussian is a product of two 1D Gaussians
+    if (Math.abs(sin_a) < 1e-6) {
+        return createSeparableKernel(gaussian1D(sigmaH, size), gaussian1D(sigmaV, size));
+    }
+    if (Math.abs(cos_a) < 1e-6) {
+        return createSeparableKernel(gaussian1D(sigmaV, size), gaussian1D(sigmaH, size));
+    }
+    
+    const data = new Float32Array(size * size);
+    const center = Math.floor(size / 2);
+    let sum = 0;
+    
     for (let y = 0; y < size; y++) {
-        kernel[y] = [];
         for (let x = 0; x < size; x++) {
             const dx = x - center;
             const dy = y - center;
@@ -175,19 +288,17 @@ function generateAnisotropicKernel(sigmaH, sigmaV, angle = 0, size = null) {
             // Apply anisotropic Gaussian
             const value = Math.exp(-((xr * xr) / (2 * sigmaH * sigmaH) + 
                                      (yr * yr) / (2 * sigmaV * sigmaV)));
-            kernel[y][x] = value;
+            data[y * size + x] = value;
             sum += value;
         }
     }
     
     // Normalize
-    for (let y = 0; y < size; y++) {
-        for (let x = 0; x < size; x++) {
-            kernel[y][x] /= sum;
-        }
+    for (let i = 0; i < data.length; i++) {
+        data[i] /= sum;
     }
     
-    return kernel;
+    return createKernel(size, size, data);
 }
 
 /**
@@ -195,40 +306,36 @@ function generateAnisotropicKernel(sigmaH, sigmaV, angle = 0, size = null) {
  * Using a pillbox (circular) PSF model
  * 
  * @param {number} radius - Blur radius in pixels
- * @returns {Array<Array<number>>} Circular PSF kernel
+ * @returns {Object} Circular PSF kernel (flat, not separable)
  */
 function generateCircularPSF(radius) {
     const size = Math.ceil(radius * 2) + 1;
-    if (size < 3) return [[1]];
+    if (size < 3) return createKernel(1, 1, new Float32Array([1]));
     
-    const kernel = [];
+    const data = new Float32Array(size * size);
     const center = Math.floor(size / 2);
     let sum = 0;
     
     for (let y = 0; y < size; y++) {
-        kernel[y] = [];
         for (let x = 0; x < size; x++) {
             const dx = x - center;
             const dy = y - center;
-            const distance = Math.sqrt(dx * dx + dy * dy);
             
             // Circular aperture (pillbox function)
-            const value = distance <= radius ? 1 : 0;
-            kernel[y][x] = value;
+            const value = dx * dx + dy * dy <= radius * radius ? 1 : 0;
+            data[y * size + x] = value;
             sum += value;
         }
     }
     
     // Normalize
     if (sum > 0) {
-        for (let y = 0; y < size; y++) {
-            for (let x = 0; x < size; x++) {
-                kernel[y][x] /= sum;
-            }
+        for (let i = 0; i < data.length; i++) {
+            data[i] /= sum;
         }
     }
     
-    return kernel;
+    return createKernel(size, size, data);
 }
 
 // ========== PRE-CORRECTION CALCULATIONS ==========
@@ -286,7 +393,7 @@ function calculatePreCorrection(sphere, cylinder = 0, distanceCm = 60, axis = 0)
  * This approximates the inverse of blur
  * 
  * @param {number} amount - Sharpening amount (proportional to blur correction needed)
- * @returns {Array<Array<number>>} Sharpening kernel
+ * @returns {Object} Sharpening kernel (flat 3x3)
  */
 function generateSharpeningKernel(amount) {
     // Unsharp mask: Original + amount * (Original - Blurred)
@@ -295,107 +402,737 @@ function generateSharpeningKernel(amount) {
     const strength = Math.min(amount / 5, 2); // Scale and limit strength
     
     // 3x3 Laplacian-based sharpening kernel
-    const kernel = [
-        [0, -strength, 0],
-        [-strength, 1 + 4 * strength, -strength],
-        [0, -strength, 0]
-    ];
-    
-    return kernel;
+    return createKernel(3, 3, new Float32Array([
+        0, -strength, 0,
+        -strength, 1 + 4 * strength, -strength,
+        0, -strength, 0
+    ]));
 }
 
 /**
- * Generate a Wiener deconvolution approximation for inverse filtering
+ * Generate a Wiener deconvolution inverse kernel
  * 
- * @param {Array<Array<number>>} blurKernel - The forward blur kernel
- * @param {number} noiseLevel - Regularization parameter (0.01 - 0.1)
- * @returns {Array<Array<number>>} Approximate inverse kernel
- */
-function generateInverseKernel(blurKernel, noiseLevel = 0.01) {
-    // Simple inverse approximation using reciprocal
-    // Full Wiener deconvolution requires frequency domain processing
-    const size = blurKernel.length;
-    const center = Math.floor(size / 2);
-    const inverseKernel = [];
+ * W(f) = H*(f) / (|H(f)|² + K) is computed in the frequency domain, brought
+ * back to the spatial domain, and truncated with a raised-cosine window so it
+ * can run through applyKernel or fftConvolve.
+ * 
+ * @param {Object|Array<Array<number>>} blurKernel - The forward blur kernel (PSF)
+ * @param {number} noiseLevel - Regularization parameter K (0.01 - 0.1)
+ * @param {number} supportSize - Inverse kernel size (odd; default 2× the PSF + 1)
+ * @returns {Object} Inverse kernel
+ */
+function generateInverseKernel(blurKernel, noiseLevel = 0.01, supportSize = null) {
+    const psf = toKernel(blurKernel);
+    if (supportSize === null) {
+        supportSize = Math.max(psf.width, psf.height) * 2 + 1;
+    }
+    supportSize |= 1;
     
-    // Get center value
-    const centerValue = blurKernel[center][center];
+    // Transform at a size well above the support so circular wrap is negligible
+    const n = nextPowerOfTwo(supportSize * 2);
+    const spectrum = kernelSpectrum(psf, n);
+    const re = new Float32Array(n * n);
+    const im = new Float32Array(n * n);
     
-    for (let y = 0; y < size; y++) {
-        inverseKernel[y] = [];
-        for (let x = 0; x < size; x++) {
-            if (x === center && y === center) {
-                // Amplify center
-                inverseKernel[y][x] = 2 + noiseLevel;
-            } else {
-                // Invert surround
-                const value = blurKernel[y][x];
-                inverseKernel[y][x] = -value / (centerValue + noiseLevel);
-            }
+    for (let i = 0; i < n * n; i++) {
+        const hr = spectrum.re[i];
+        const hi = spectrum.im[i];
+        const denom = hr * hr + hi * hi + noiseLevel;
+        re[i] = hr / denom;
+        im[i] = -hi / denom;
+    }
+    fft2D(re, im, n, true);
+    
+    // The kernel is centered at the origin; crop around it with a window
+    const half = Math.floor(supportSize / 2);
+    const data = new Float32Array(supportSize * supportSize);
+    let sum = 0;
+    for (let y = -half; y <= half; y++) {
+        const wy = 0.5 + 0.5 * Math.cos((Math.PI * y) / (half + 1));
+        for (let x = -half; x <= half; x++) {
+            const wx = 0.5 + 0.5 * Math.cos((Math.PI * x) / (half + 1));
+            const value = re[((y + n) % n) * n + ((x + n) % n)] * wx * wy;
+            data[(y + half) * supportSize + (x + half)] = value;
+            sum += value;
         }
     }
     
-    return inverseKernel;
+    // Keep unit DC gain so flat regions keep their brightness
+    if (sum !== 0) {
+        for (let i = 0; i < data.length; i++) {
+            data[i] /= sum;
+        }
+    }
+    
+    return createKernel(supportSize, supportSize, data);
 }
 
-// ========== UTILITY FUNCTIONS ==========
+// ========== CONVOLUTION ENGINE ==========
+
+// Scratch planes reused across calls (grown on demand, never shrunk)
+const convolutionScratch = {};
+
+function scratchBuffer(name, length) {
+    if (!convolutionScratch[name] || convolutionScratch[name].length < length) {
+        convolutionScratch[name] = new Float32Array(length);
+    }
+    return convolutionScratch[name];
+}
+
+/**
+ * Copy RGB into a float plane padded by (padX, padY) with edge replication,
+ * so the convolution loops never clamp coordinates
+ *
+ * @returns {Float32Array} Padded RGB plane of (width + 2·padX) × (height + 2·padY)
+ */
+function padImageRGB(data, width, height, padX, padY) {
+    const paddedWidth = width + 2 * padX;
+    const paddedHeight = height + 2 * padY;
+    const padded = scratchBuffer('padded', paddedWidth * paddedHeight * 3);
+
+    for (let py = 0; py < paddedHeight; py++) {
+        const sy = Math.min(Math.max(py - padY, 0), height - 1);
+        const srcRow = sy * width * 4;
+        let dst = py * paddedWidth * 3;
+
+        // Left strip replicates the first pixel
+        for (let i = 0; i < padX; i++, dst += 3) {
+            padded[dst] = data[srcRow];
+            padded[dst + 1] = data[srcRow + 1];
+            padded[dst + 2] = data[srcRow + 2];
+        }
+        for (let x = 0, src = srcRow; x < width; x++, src += 4, dst += 3) {
+            padded[dst] = data[src];
+            padded[dst + 1] = data[src + 1];
+            padded[dst + 2] = data[src + 2];
+        }
+        // Right strip replicates the last pixel
+        const last = srcRow + (width - 1) * 4;
+        for (let i = 0; i < padX; i++, dst += 3) {
+            padded[dst] = data[last];
+            padded[dst + 1] = data[last + 1];
+            padded[dst + 2] = data[last + 2];
+        }
+    }
+
+    return padded;
+}
 
 /**
  * Apply a convolution kernel to image data
- * Note: This is a reference implementation. For actual image processing,
- * use Canvas API or WebGL for better performance
+ * Separable kernels run as a horizontal then a vertical 1D pass; others run
+ * as a dense 2D loop. Borders replicate edge pixels.
  * 
  * @param {ImageData} imageData - Input image data
- * @param {Array<Array<number>>} kernel - Convolution kernel
+ * @param {Object|Array<Array<number>>} kernel - Flat kernel (or nested array)
+ * @param {ImageData} output - Optional destination of the same size (reused across frames)
  * @returns {ImageData} Filtered image data
  */
-function applyKernel(imageData, kernel) {
+function applyKernel(imageData, kernel, output = null) {
     const width = imageData.width;
     const height = imageData.height;
     const data = imageData.data;
-    const kSize = kernel.length;
-    const kHalf = Math.floor(kSize / 2);
+    const k = toKernel(kernel);
+    const halfX = Math.floor(k.width / 2);
+    const halfY = Math.floor(k.height / 2);
     
-    const output = new ImageData(width, height);
+    if (!output) {
+        output = new ImageData(width, height);
+    } else if (output.width !== width || output.height !== height) {
+        throw new Error('applyKernel: output size must match input');
+    }
+    const out = output.data;
+    
+    const padded = padImageRGB(data, width, height, halfX, halfY);
+    const paddedWidth = width + 2 * halfX;
+    const paddedHeight = height + 2 * halfY;
+    
+    if (k.row && k.col) {
+        // Horizontal pass over every padded row (keeps the vertical padding)
+        const row = k.row;
+        const pass = scratchBuffer('pass', width * paddedHeight * 3);
+        for (let y = 0; y < paddedHeight; y++) {
+            const srcRow = y * paddedWidth * 3;
+            let dst = y * width * 3;
+            for (let x = 0; x < width; x++, dst += 3) {
+                let r = 0, g = 0, b = 0;
+                for (let t = 0, src = srcRow + x * 3; t < row.length; t++, src += 3) {
+                    const w = row[t];
+                    r += padded[src] * w;
+                    g += padded[src + 1] * w;
+                    b += padded[src + 2] * w;
+                }
+                pass[dst] = r;
+                pass[dst + 1] = g;
+                pass[dst + 2] = b;
+            }
+        }
+        
+        // Vertical pass; Uint8ClampedArray does the 0-255 clamp on store
+        const col = k.col;
+        const stride = width * 3;
+        for (let y = 0; y < height; y++) {
+            for (let x = 0; x < width; x++) {
+                let r = 0, g = 0, b = 0;
+                for (let t = 0, src = y * stride + x * 3; t < col.length; t++, src += stride) {
+                    const w = col[t];
+                    r += pass[src] * w;
+                    g += pass[src + 1] * w;
+                    b += pass[src + 2] * w;
+                }
+                const idx = (y * width + x) * 4;
+                out[idx] = r;
+                out[idx + 1] = g;
+                out[idx + 2] = b;
+                out[idx + 3] = data[idx + 3]; // Alpha channel
+            }
+        }
+        
+        return output;
+    }
     
+    // Dense 2D kernel
+    const taps = k.data;
+    const kw = k.width;
+    const kh = k.height;
     for (let y = 0; y < height; y++) {
         for (let x = 0; x < width; x++) {
             let r = 0, g = 0, b = 0;
             
-            // Apply kernel
-            for (let ky = 0; ky < kSize; ky++) {
-                for (let kx = 0; kx < kSize; kx++) {
-                    const px = Math.min(Math.max(x + kx - kHalf, 0), width - 1);
-                    const py = Math.min(Math.max(y + ky - kHalf, 0), height - 1);
-                    const idx = (py * width + px) * 4;
-                    const k = kernel[ky][kx];
-                    
-                    r += data[idx] * k;
-                    g += data[idx + 1] * k;
-                    b += data[idx + 2] * k;
+            for (let ky = 0; ky < kh; ky++) {
+                let src = ((y + ky) * paddedWidth + x) * 3;
+                const kRow = ky * kw;
+                for (let kx = 0; kx < kw; kx++, src += 3) {
+                    const w = taps[kRow + kx];
+                    r += padded[src] * w;
+                    g += padded[src + 1] * w;
+                    b += padded[src + 2] * w;
                 }
             }
             
             const idx = (y * width + x) * 4;
-            output.data[idx] = Math.min(Math.max(r, 0), 255);
-            output.data[idx + 1] = Math.min(Math.max(g, 0), 255);
-            output.data[idx + 2] = Math.min(Math.max(b, 0), 255);
-            output.data[idx + 3] = data[idx + 3]; // Alpha channel
+            out[idx] = r;
+            out[idx + 1] = g;
+            out[idx + 2] = b;
+            out[idx + 3] = data[idx + 3]; // Alpha channel
         }
     }
     
     return output;
 }
 
+// ========== KERNEL CACHE ==========
+
+/**
+ * Kernels keyed on the Rx quantized to clinical steps (0.25 D, 1°, 1 cm), so
+ * slider moves within a step reuse a kernel and each step is built once.
+ * The LRU is bounded by bytes (kernel data and FFT spectra), not entry count,
+ * since a high-myopia PSF is orders of magnitude larger than a mild one.
+ */
+
+const RX_QUANTUM = { sphere: 0.25, cylinder: 0.25, axis: 1, distanceCm: 1 };
+
+// Neighbors prefetched around the current Rx: one slider step in each direction
+const RX_NEIGHBOR_STEPS = { sphere: 0.25, cylinder: 0.25, axis: 1, distanceCm: 5 };
+
+const KERNEL_CACHE_BYTES = 64 * 1024 * 1024;
+
+function quantize(value, step) {
+    // + 0 folds −0 into 0 so both produce the same key
+    return Math.round(value / step) * step + 0;
+}
+
+/**
+ * Snap an Rx to clinical steps; axis wraps to [0, 180)
+ *
+ * @returns {{sphere: number, cylinder: number, axis: number, distanceCm: number}}
+ */
+function quantizeRx(sphere, cylinder = 0, axis = 0, distanceCm = 60) {
+    return {
+        sphere: quantize(sphere, RX_QUANTUM.sphere),
+        cylinder: quantize(cylinder, RX_QUANTUM.cylinder),
+        axis: ((quantize(axis, RX_QUANTUM.axis) % 180) + 180) % 180,
+        distanceCm: quantize(distanceCm, RX_QUANTUM.distanceCm)
+    };
+}
+
+function rxKey(rx) {
+    return `${rx.sphere}|${rx.cylinder}|${rx.axis}|${rx.distanceCm}`;
+}
+
+function kernelBytes(kernel) {
+    return kernel.data.byteLength +
+        (kernel.row ? kernel.row.byteLength + kernel.col.byteLength : 0);
+}
+
+/**
+ * Byte-bounded LRU (Map insertion order is the recency order)
+ *
+ * @param {number} maxBytes - Eviction threshold
+ */
+function createKernelCache(maxBytes = KERNEL_CACHE_BYTES) {
+    const entries = new Map();
+    let bytes = 0;
+    
+    const cache = {
+        get(key) {
+            const entry = entries.get(key);
+            if (!entry) return undefined;
+            entries.delete(key);
+            entries.set(key, entry);
+            return entry.value;
+        },
+        
+        has(key) {
+            return entries.has(key);
+        },
+        
+        set(key, value, size) {
+            const existing = entries.get(key);
+            if (existing) {
+                bytes -= existing.size;
+                entries.delete(key);
+            }
+            entries.set(key, { value, size });
+            bytes += size;
+            
+            // Never evict the entry just added, even if it alone is over budget
+            for (const [oldKey, entry] of entries) {
+                if (bytes <= maxBytes || oldKey === key) break;
+                entries.delete(oldKey);
+                bytes -= entry.size;
+            }
+            return value;
+        },
+        
+        getOrCreate(key, build, sizeOf = kernelBytes) {
+            const cached = cache.get(key);
+            if (cached !== undefined) return cached;
+            const value = build();
+            return cache.set(key, value, sizeOf(value));
+        },
+        
+        clear() {
+            entries.clear();
+            bytes = 0;
+        },
+        
+        stats() {
+            return { entries: entries.size, bytes, maxBytes };
+        }
+    };
+    return cache;
+}
+
+const kernelCache = createKernelCache();
+
+/**
+ * Forward blur kernel (PSF) for a quantized Rx, cached
+ * The returned kernel carries `cacheKey` so its FFT spectra share the cache.
+ */
+function getForwardKernel(sphere, cylinder = 0, axis = 0, distanceCm = 60, pupilDiameterMm = 4) {
+    const rx = quantizeRx(sphere, cylinder, axis, distanceCm);
+    const key = `psf|${rxKey(rx)}|${pupilDiameterMm}`;
+    
+    return kernelCache.getOrCreate(key, () => {
+        const blur = calculateDefocusBlur(rx.sphere, rx.cylinder, rx.distanceCm, pupilDiameterMm);
+        const sigmaH = blur.horizontal / 2.5;
+        const sigmaV = blur.vertical / 2.5;
+        const kernel = rx.cylinder !== 0
+            ? generateAnisotropicKernel(sigmaH, sigmaV, (rx.axis * Math.PI) / 180)
+            : generateGaussianKernel(sigmaH);
+        kernel.cacheKey = key;
+        return kernel;
+    });
+}
+
+/**
+ * Circular (pillbox) PSF cached on radius quantized to 0.25 px
+ */
+function getCircularPSF(radius) {
+    const r = quantize(radius, 0.25);
+    const key = `disk|${r}`;
+    return kernelCache.getOrCreate(key, () => {
+        const kernel = generateCircularPSF(r);
+        kernel.cacheKey = key;
+        return kernel;
+    });
+}
+
+/**
+ * calculatePreCorrection on the quantized Rx, cached
+ * Results are shared; callers must treat the kernels as read-only.
+ */
+function getPreCorrection(sphere, cylinder = 0, distanceCm = 60, axis = 0) {
+    const rx = quantizeRx(sphere, cylinder, axis, distanceCm);
+    return kernelCache.getOrCreate(
+        `pre|${rxKey(rx)}`,
+        () => calculatePreCorrection(rx.sphere, rx.cylinder, rx.distanceCm, rx.axis),
+        (pre) => kernelBytes(pre.forwardKernel) + kernelBytes(pre.preCorrectionKernel)
+    );
+}
+
+// Idle callback where available so prefetching never competes with a frame
+const scheduleIdle = typeof requestIdleCallback === 'function'
+    ? (fn) => requestIdleCallback(fn, { timeout: 500 })
+    : (fn) => setTimeout(() => fn({ timeRemaining: () => 8, didTimeout: false }), 0);
+
+let neighborQueue = [];
+let neighborScheduled = false;
+
+function drainNeighborQueue(deadline) {
+    while (neighborQueue.length > 0 && (deadline.didTimeout || deadline.timeRemaining() > 1)) {
+        neighborQueue.shift()();
+    }
+    if (neighborQueue.length > 0) {
+        scheduleIdle(drainNeighborQueue);
+    } else {
+        neighborScheduled = false;
+    }
+}
+
+/**
+ * Build kernels one slider step around an Rx in idle time
+ * A newer call replaces any neighbors still queued from an older Rx.
+ *
+ * @param {Object} rx - { sphere, cylinder, axis, distanceCm }
+ * @param {Function} build - Called per neighbor (sphere, cylinder, axis, distanceCm);
+ *                           defaults to warming getPreCorrection and getForwardKernel
+ */
+function precomputeNeighborKernels(rx, build = null) {
+    const warm = build || ((sphere, cylinder, axis, distanceCm) => {
+        getPreCorrection(sphere, cylinder, distanceCm, axis);
+        getForwardKernel(sphere, cylinder, axis, distanceCm);
+    });
+    const base = quantizeRx(rx.sphere, rx.cylinder, rx.axis, rx.distanceCm);
+    
+    neighborQueue = [];
+    for (const param of Object.keys(RX_NEIGHBOR_STEPS)) {
+        for (const direction of [-1, 1]) {
+            const next = { ...base, [param]: base[param] + direction * RX_NEIGHBOR_STEPS[param] };
+            neighborQueue.push(() => warm(next.sphere, next.cylinder, next.axis, next.distanceCm));
+        }
+    }
+    
+    if (!neighborScheduled) {
+        neighborScheduled = true;
+        scheduleIdle(drainNeighborQueue);
+    }
+}
+
+// ========== FREQUENCY-DOMAIN DECONVOLUTION ==========
+
+/**
+ * Radix-2 FFTs on Float32Array (re, im) pairs. 2D transforms run rows then
+ * columns. Image channels are real, so two channels are packed as one complex
+ * plane (R + iG, then B): a real kernel's spectrum is Hermitian, so the real
+ * and imaginary parts of the result are the two filtered channels.
+ * Large frames go through overlap-add tiles, so the cost is O(N log N) per
+ * tile whatever the PSF size.
+ */
+
+const fftTables = new Map();
+
+function nextPowerOfTwo(n) {
+    let size = 1;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+/**
+ * Twiddles and bit-reversal permutation for a transform size (cached)
+ */
+function fftTable(n) {
+    let table = fftTables.get(n);
+    if (!table) {
+        const cos = new Float32Array(n / 2);
+        const sin = new Float32Array(n / 2);
+        for (let k = 0; k < n / 2; k++) {
+            cos[k] = Math.cos((2 * Math.PI * k) / n);
+            sin[k] = Math.sin((2 * Math.PI * k) / n);
+        }
+        const reverse = new Uint32Array(n);
+        const bits = Math.log2(n);
+        for (let i = 0; i < n; i++) {
+            let r = 0;
+            for (let b = 0; b < bits; b++) r |= ((i >> b) & 1) << (bits - 1 - b);
+            reverse[i] = r;
+        }
+        table = { cos, sin, reverse };
+        fftTables.set(n, table);
+    }
+    return table;
+}
+
+/**
+ * In-place iterative radix-2 FFT of n points starting at `offset`
+ *
+ * @param {Float32Array} re - Real parts
+ * @param {Float32Array} im - Imaginary parts
+ * @param {number} offset - First element
+ * @param {number} n - Transform size (power of two)
+ * @param {boolean} inverse - Inverse transform (scaled by 1/n)
+ */
+function fft(re, im, offset, n, inverse = false) {
+    const { cos, sin, reverse } = fftTable(n);
+    
+    for (let i = 0; i < n; i++) {
+        const j = reverse[i];
+        if (j > i) {
+            let t = re[offset + i]; re[offset + i] = re[offset + j]; re[offset + j] = t;
+            t = im[offset + i]; im[offset + i] = im[offset + j]; im[offset + j] = t;
+        }
+    }
+    
+    const sign = inverse ? 1 : -1;
+    for (let size = 2; size <= n; size <<= 1) {
+        const half = size >> 1;
+        const step = n / size;
+        for (let start = 0; start < n; start += size) {
+            for (let j = 0; j < half; j++) {
+                const wr = cos[j * step];
+                const wi = sign * sin[j * step];
+                const a = offset + start + j;
+                const b = a + half;
+                const tr = re[b] * wr - im[b] * wi;
+                const ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+    
+    if (inverse) {
+        for (let i = 0; i < n; i++) {
+            re[offset + i] /= n;
+            im[offset + i] /= n;
+        }
+    }
+}
+
+/**
+ * In-place 2D FFT of an n×n plane (rows, then columns through a scratch line)
+ */
+function fft2D(re, im, n, inverse = false) {
+    for (let y = 0; y < n; y++) {
+        fft(re, im, y * n, n, inverse);
+    }
+    
+    const colRe = scratchBuffer('fftColRe', n);
+    const colIm = scratchBuffer('fftColIm', n);
+    for (let x = 0; x < n; x++) {
+        for (let y = 0; y < n; y++) {
+            colRe[y] = re[y * n + x];
+            colIm[y] = im[y * n + x];
+        }
+        fft(colRe, colIm, 0, n, inverse);
+        for (let y = 0; y < n; y++) {
+            re[y * n + x] = colRe[y];
+            im[y * n + x] = colIm[y];
+        }
+    }
+}
+
+// Spectra per kernel object and transform size (kernels without a cacheKey)
+const kernelSpectra = new WeakMap();
+
+/**
+ * Spectrum of a kernel zero-padded to n×n with its center moved to the origin
+ * Cache-built kernels (with `cacheKey`) keep their spectra in kernelCache so
+ * they count against its byte budget and evict with it.
+ *
+ * @param {Object} kernel - Flat kernel
+ * @param {number} n - Transform size (power of two ≥ kernel size)
+ * @returns {{re: Float32Array, im: Float32Array}} Spectrum
+ */
+function kernelSpectrum(kernel, n) {
+    if (kernel.cacheKey) {
+        return kernelCache.getOrCreate(
+            `fft|${kernel.cacheKey}|${n}`,
+            () => computeKernelSpectrum(kernel, n),
+            (spectrum) => spectrum.re.byteLength + spectrum.im.byteLength
+        );
+    }
+    
+    let bySize = kernelSpectra.get(kernel);
+    if (!bySize) {
+        bySize = new Map();
+        kernelSpectra.set(kernel, bySize);
+    }
+    let spectrum = bySize.get(n);
+    if (!spectrum) {
+        spectrum = computeKernelSpectrum(kernel, n);
+        bySize.set(n, spectrum);
+    }
+    return spectrum;
+}
+
+function computeKernelSpectrum(kernel, n) {
+    const re = new Float32Array(n * n);
+    const im = new Float32Array(n * n);
+    const halfX = Math.floor(kernel.width / 2);
+    const halfY = Math.floor(kernel.height / 2);
+    for (let y = 0; y < kernel.height; y++) {
+        const ty = (y - halfY + n) % n;
+        for (let x = 0; x < kernel.width; x++) {
+            re[ty * n + ((x - halfX + n) % n)] = kernel.data[y * kernel.width + x];
+        }
+    }
+    fft2D(re, im, n);
+    return { re, im };
+}
+
+/**
+ * Convolve image data with a kernel by FFT overlap-add
+ * Same result as applyKernel (edge-replicated borders) but O(N log N) per
+ * tile, so large PSFs and Wiener inverse kernels stay affordable.
+ * 
+ * @param {ImageData} imageData - Input image data
+ * @param {Object|Array<Array<number>>} kernel - Flat kernel (or nested array)
+ * @param {ImageData} output - Optional destination of the same size
+ * @param {number} tileSize - Minimum FFT size per tile (power of two)
+ * @returns {ImageData} Filtered image data
+ */
+function fftConvolve(imageData, kernel, output = null, tileSize = 256) {
+    const width = imageData.width;
+    const height = imageData.height;
+    const data = imageData.data;
+    const k = toKernel(kernel);
+    const halfX = Math.floor(k.width / 2);
+    const halfY = Math.floor(k.height / 2);
+    
+    if (!output) {
+        output = new ImageData(width, height);
+    } else if (output.width !== width || output.height !== height) {
+        throw new Error('fftConvolve: output size must match input');
+    }
+    const out = output.data;
+    
+    // Each tile's linear convolution (block + kernel − 1) must fit in n
+    const n = nextPowerOfTwo(Math.max(tileSize, 2 * Math.max(k.width, k.height)));
+    const block = n - Math.max(k.width, k.height) + 1;
+    const spectrum = kernelSpectrum(k, n);
+    
+    // Work on the edge-replicated padded plane, keep only its interior
+    const padded = padImageRGB(data, width, height, halfX, halfY);
+    const paddedWidth = width + 2 * halfX;
+    const paddedHeight = height + 2 * halfY;
+    const accum = scratchBuffer('fftAccum', paddedWidth * paddedHeight * 3);
+    accum.fill(0, 0, paddedWidth * paddedHeight * 3);
+    
+    const re = scratchBuffer('fftRe', n * n);
+    const im = scratchBuffer('fftIm', n * n);
+    const channelPairs = [[0, 1], [2, -1]]; // (R + iG), (B + 0i)
+    
+    for (let by = 0; by < paddedHeight; by += block) {
+        for (let bx = 0; bx < paddedWidth; bx += block) {
+            const bw = Math.min(block, paddedWidth - bx);
+            const bh = Math.min(block, paddedHeight - by);
+            
+            for (const [c1, c2] of channelPairs) {
+                re.fill(0, 0, n * n);
+                im.fill(0, 0, n * n);
+                for (let y = 0; y < bh; y++) {
+                    const src = ((by + y) * paddedWidth + bx) * 3;
+                    for (let x = 0; x < bw; x++) {
+                        re[y * n + x] = padded[src + x * 3 + c1];
+                        if (c2 >= 0) im[y * n + x] = padded[src + x * 3 + c2];
+                    }
+                }
+                
+                fft2D(re, im, n);
+                for (let i = 0; i < n * n; i++) {
+                    const hr = spectrum.re[i];
+                    const hi = spectrum.im[i];
+                    const zr = re[i];
+                    re[i] = zr * hr - im[i] * hi;
+                    im[i] = zr * hi + im[i] * hr;
+                }
+                fft2D(re, im, n, true);
+                
+                // Scatter the tile's full linear result; negative offsets wrapped to the end
+                for (let ty = 0; ty < n; ty++) {
+                    const oy = by + (ty < bh + halfY ? ty : ty - n);
+                    if (oy < 0 || oy >= paddedHeight) continue;
+                    for (let tx = 0; tx < n; tx++) {
+                        const ox = bx + (tx < bw + halfX ? tx : tx - n);
+                        if (ox < 0 || ox >= paddedWidth) continue;
+                        const dst = (oy * paddedWidth + ox) * 3;
+                        accum[dst + c1] += re[ty * n + tx];
+                        if (c2 >= 0) accum[dst + c2] += im[ty * n + tx];
+                    }
+                }
+            }
+        }
+    }
+    
+    for (let y = 0; y < height; y++) {
+        for (let x = 0; x < width; x++) {
+            const src = ((y + halfY) * paddedWidth + (x + halfX)) * 3;
+            const idx = (y * width + x) * 4;
+            out[idx] = accum[src];
+            out[idx + 1] = accum[src + 1];
+            out[idx + 2] = accum[src + 2];
+            out[idx + 3] = data[idx + 3]; // Alpha channel
+        }
+    }
+    
+    return output;
+}
+
+/**
+ * Wiener pre-correction kernel for an Rx, cached on the quantized Rx
+ * Its FFT spectra are cached alongside under the same key.
+ * 
+ * @returns {Object} Inverse kernel for fftConvolve / applyKernel
+ */
+function getWienerPreCorrectionKernel(sphere, cylinder = 0, axis = 0, distanceCm = 60, pupilDiameterMm = 4, noiseLevel = 0.01) {
+    const rx = quantizeRx(sphere, cylinder, axis, distanceCm);
+    const key = `wiener|${rxKey(rx)}|${pupilDiameterMm}|${noiseLevel}`;
+    
+    return kernelCache.getOrCreate(key, () => {
+        const psf = getForwardKernel(rx.sphere, rx.cylinder, rx.axis, rx.distanceCm, pupilDiameterMm);
+        const kernel = generateInverseKernel(psf, noiseLevel);
+        kernel.cacheKey = key;
+        return kernel;
+    });
+}
+
+/**
+ * Pre-correct an image for an Rx with Wiener deconvolution
+ * 
+ * @param {ImageData} imageData - Input image data
+ * @param {Object} rx - { sphere, cylinder, axis, distanceCm, pupilDiameterMm, noiseLevel }
+ * @param {ImageData} output - Optional destination of the same size
+ * @returns {ImageData} Pre-corrected image data
+ */
+function applyWienerPreCorrection(imageData, rx, output = null) {
+    const kernel = getWienerPreCorrectionKernel(
+        rx.sphere,
+        rx.cylinder,
+        rx.axis,
+        rx.distanceCm,
+        rx.pupilDiameterMm,
+        rx.noiseLevel
+    );
+    return fftConvolve(imageData, kernel, output);
+}
+
+// ========== UTILITY FUNCTIONS ==========
+
 /**
  * Format kernel for display
  * 
- * @param {Array<Array<number>>} kernel - Convolution kernel
+ * @param {Object|Array<Array<number>>} kernel - Convolution kernel
  * @returns {string} Formatted kernel string
  */
 function formatKernel(kernel) {
+    const { width, height, data } = toKernel(kernel);
     let output = '';
-    for (let row of kernel) {
+    for (let y = 0; y < height; y++) {
+        const row = Array.from(data.subarray(y * width, (y + 1) * width));
         output += row.map(v => v.toFixed(4).padStart(8)).join(' ') + '\n';
     }
     return output;
@@ -436,7 +1173,12 @@ if (typeof module !== 'undefined' && module.exports) {
         calculateDefocusBlur,
         calculateSphericalEquivalent,
         
-        // Kernel generation
+        // Kernels
+        createKernel,
+        createSeparableKernel,
+        findSeparableFactors,
+        toKernel,
+        gaussian1D,
         generateGaussianKernel,
         generateAnisotropicKernel,
         generateCircularPSF,
@@ -445,9 +1187,23 @@ if (typeof module !== 'undefined' && module.exports) {
         
         // Pre-correction
         calculatePreCorrection,
+        getWienerPreCorrectionKernel,
+        applyWienerPreCorrection,
+        
+        // Kernel cache
+        quantizeRx,
+        createKernelCache,
+        kernelCache,
+        getForwardKernel,
+        getCircularPSF,
+        getPreCorrection,
+        precomputeNeighborKernels,
         
         // Utilities
         applyKernel,
+        fft,
+        fft2D,
+        fftConvolve,
         formatKernel,
         
         // Examples
@@ -462,13 +1218,30 @@ if (typeof window !== 'undefined') {
         calculateBlurRadius,
         calculateDefocusBlur,
         calculateSphericalEquivalent,
+        createKernel,
+        createSeparableKernel,
+        findSeparableFactors,
+        toKernel,
+        gaussian1D,
         generateGaussianKernel,
         generateAnisotropicKernel,
         generateCircularPSF,
         generateSharpeningKernel,
         generateInverseKernel,
         calculatePreCorrection,
+        getWienerPreCorrectionKernel,
+        applyWienerPreCorrection,
+        quantizeRx,
+        createKernelCache,
+        kernelCache,
+        getForwardKernel,
+        getCircularPSF,
+        getPreCorrection,
+        precomputeNeighborKernels,
         applyKernel,
+        fft,
+        fft2D,
+        fftConvolve,
         formatKernel,
         exampleUsage
     };
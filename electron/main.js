@@ -1,8 +1,9 @@
-import { app, BrowserWindow, globalShortcut, ipcMain } from 'electron';
+import { app, BrowserWindow, desktopCapturer, globalShortcut, ipcMain, session } from 'electron';
 import { fileURLToPath } from 'url';
 import path from 'path';
-import { spawn } from 'child_process';
+import { fork, spawn } from 'child_process';
 import fs from 'fs';
+import http from 'http';
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
@@ -10,14 +11,25 @@ const __dirname = path.dirname(__filename);
 let mainWindow;
 let eyeTestWindow;
 let eyeTestProcess = null;
-let prescriptionWatcher = null;
+let eyeTestReady = null;
+let prescriptionStream = null;
+let latestPrescription = null;
 
 const rootDir = path.resolve(__dirname, '..');
 const overlayDevUrl = 'http://localhost:5123';
 const eyeTestDir = path.join(rootDir, 'eye-test-app');
 const eyeTestResultsDir = path.join(eyeTestDir, 'results');
+const eyeTestApiDir = path.join(eyeTestDir, 'apps', 'api');
+const eyeTestApiEntry = path.join(eyeTestApiDir, 'dist', 'index.js');
+const eyeTestWebDist = path.join(eyeTestDir, 'apps', 'web', 'dist');
+const eyeTestApiPort = Number(process.env.OPTIX_API_PORT) || 8787;
+const EYE_TEST_READY_TIMEOUT_MS = Number(process.env.OPTIX_EYE_TEST_READY_TIMEOUT_MS) || 15000;
 const prescriptionFile = path.join(eyeTestResultsDir, 'latest-prescription.json');
+const apiUrl = process.env.OPTIX_API_URL || `http://localhost:${eyeTestApiPort}`;
+const PRESCRIPTION_RECONNECT_MS = 2000;
+const PRESCRIPTION_DEBOUNCE_MS = 16;
 
+// Persistence fallback only: the API writes this file after pushing the Rx
 function readLatestPrescription() {
   try {
     if (!fs.existsSync(prescriptionFile)) {
@@ -31,39 +43,129 @@ function readLatestPrescription() {
   }
 }
 
-function broadcastPrescription() {
-  const data = readLatestPrescription();
+function currentPrescription() {
+  if (!latestPrescription) {
+    latestPrescription = readLatestPrescription();
+  }
+  return latestPrescription;
+}
+
+function broadcastPrescription(data = currentPrescription()) {
   if (data && mainWindow && !mainWindow.isDestroyed()) {
     console.log('📡 Broadcasting updated prescription to renderer');
     mainWindow.webContents.send('eye-test:updated', data);
   }
 }
 
-function ensurePrescriptionWatcher() {
-  if (prescriptionWatcher) return;
-
-  if (!fs.existsSync(eyeTestResultsDir)) {
-    fs.mkdirSync(eyeTestResultsDir, { recursive: true });
-  }
+// Coalesce bursts (e.g. replay on reconnect) into one renderer update
+let broadcastTimer = null;
+function scheduleBroadcast() {
+  if (broadcastTimer) return;
+  broadcastTimer = setTimeout(() => {
+    broadcastTimer = null;
+    broadcastPrescription();
+  }, PRESCRIPTION_DEBOUNCE_MS);
+}
 
-  try {
-    prescriptionWatcher = fs.watch(eyeTestResultsDir, (eventType, filename) => {
-      if (filename === 'latest-prescription.json') {
-        console.log('📁 Detected prescription file change');
-        broadcastPrescription();
+/**
+ * Subscribe to the API's prescription SSE stream (GET /api/summary/stream)
+ * Reconnects until stopped; the API replays the current Rx on each connect.
+ */
+function ensurePrescriptionStream() {
+  if (prescriptionStream) return;
+  prescriptionStream = { request: null, retryTimer: null, stopped: false };
+  const stream = prescriptionStream;
+
+  const reconnect = () => {
+    if (stream.stopped || stream.retryTimer) return;
+    stream.retryTimer = setTimeout(() => {
+      stream.retryTimer = null;
+      connect();
+    }, PRESCRIPTION_RECONNECT_MS);
+  };
+
+  const connect = () => {
+    stream.request = http.get(`${apiUrl}/api/summary/stream`, { headers: { Accept: 'text/event-stream' } }, (res) => {
+      if (res.statusCode !== 200) {
+        res.resume();
+        reconnect();
+        return;
       }
+      console.log('🔌 Subscribed to prescription stream at', apiUrl);
+
+      let buffer = '';
+      res.setEncoding('utf-8');
+      res.on('data', (chunk) => {
+        buffer += chunk;
+        let boundary;
+        while ((boundary = buffer.indexOf('\n\n')) !== -1) {
+          const frame = buffer.slice(0, boundary);
+          buffer = buffer.slice(boundary + 2);
+
+          let event = 'message';
+          let data = '';
+          for (const line of frame.split('\n')) {
+            if (line.startsWith('event:')) event = line.slice(6).trim();
+            else if (line.startsWith('data:')) data += line.slice(5).trim();
+          }
+          if (event !== 'prescription' || !data) continue;
+
+          try {
+            latestPrescription = JSON.parse(data);
+            scheduleBroadcast();
+          } catch (error) {
+            console.error('❌ Malformed prescription event:', error);
+          }
+        }
+      });
+      res.on('end', reconnect);
+      res.on('error', reconnect);
     });
-    console.log('👀 Watching for prescription updates in', eyeTestResultsDir);
-  } catch (error) {
-    console.error('❌ Failed to watch prescription directory:', error);
+    // API not up yet (or restarting): keep retrying quietly
+    stream.request.on('error', reconnect);
+  };
+
+  connect();
+}
+
+function stopPrescriptionStream() {
+  if (!prescriptionStream) return;
+  prescriptionStream.stopped = true;
+  clearTimeout(prescriptionStream.retryTimer);
+  prescriptionStream.request?.destroy();
+  prescriptionStream = null;
+}
+
+/**
+ * Eye test launch mode
+ *   prod: prebuilt apps/web bundle served by the built API (one node process)
+ *   dev:  `pnpm dev` (Vite with on-demand transforms, tens of seconds to boot)
+ * OPTIX_EYE_TEST_MODE overrides; packaged apps default to prod. Prod falls
+ * back to dev when the bundles haven't been built (`npm run eye-test:build`).
+ */
+let resolvedEyeTestMode = null;
+function eyeTestMode() {
+  if (!resolvedEyeTestMode) {
+    resolvedEyeTestMode = detectEyeTestMode();
+    console.log(`👁️ Eye test launch mode: ${resolvedEyeTestMode}`);
   }
+  return resolvedEyeTestMode;
 }
 
-function stopPrescriptionWatcher() {
-  if (prescriptionWatcher) {
-    prescriptionWatcher.close();
-    prescriptionWatcher = null;
+function detectEyeTestMode() {
+  const requested = process.env.OPTIX_EYE_TEST_MODE || (app.isPackaged ? 'prod' : 'dev');
+  if (requested !== 'prod') return 'dev';
+
+  const built = fs.existsSync(eyeTestApiEntry) && fs.existsSync(path.join(eyeTestWebDist, 'index.html'));
+  if (!built) {
+    console.warn('⚠️ Eye test bundles not built, falling back to pnpm dev');
+    return 'dev';
   }
+  return 'prod';
+}
+
+function eyeTestUrl() {
+  return eyeTestMode() === 'prod' ? `http://localhost:${eyeTestApiPort}` : 'http://localhost:5173';
 }
 
 async function isEyeTestRunning() {
@@ -75,35 +177,100 @@ async function isEyeTestRunning() {
   }
 }
 
-async function ensureEyeTestProcess() {
-  if (await isEyeTestRunning()) {
-    console.log('🔁 Eye test server already running on port 5173');
-    return;
-  }
+function pipeEyeTestOutput(child) {
+  child.stdout.on('data', (data) => {
+    console.log(`[EyeTest] ${data.toString().trim()}`);
+  });
 
-  if (eyeTestProcess && !eyeTestProcess.killed) {
-    return;
-  }
+  child.stderr.on('data', (data) => {
+    console.error(`[EyeTest:err] ${data.toString().trim()}`);
+  });
+
+  child.on('close', (code) => {
+    console.log(`👁️ Eye test process exited with code ${code}`);
+    eyeTestProcess = null;
+    eyeTestReady = null;
+  });
+}
+
+/**
+ * Fork the built API (serving the web bundle too) and resolve when it
+ * reports { type: 'ready' } over the IPC channel
+ * Runs on the system node, which better-sqlite3's native build targets.
+ */
+function forkEyeTestApi() {
+  const child = fork(eyeTestApiEntry, [], {
+    cwd: eyeTestApiDir,
+    execPath: process.env.OPTIX_NODE_PATH || 'node',
+    env: {
+      ...process.env,
+      NODE_ENV: 'production',
+      PORT: String(eyeTestApiPort),
+      WEB_DIST_DIR: eyeTestWebDist,
+    },
+    stdio: ['ignore', 'pipe', 'pipe', 'ipc'],
+  });
+  eyeTestProcess = child;
+  pipeEyeTestOutput(child);
+
+  const startedAt = Date.now();
+  return new Promise((resolve, reject) => {
+    const timer = setTimeout(() => {
+      reject(new Error(`Eye test API not ready after ${EYE_TEST_READY_TIMEOUT_MS}ms`));
+    }, EYE_TEST_READY_TIMEOUT_MS);
+
+    child.on('message', (message) => {
+      if (message?.type !== 'ready') return;
+      clearTimeout(timer);
+      console.log(`✅ Eye test API ready in ${Date.now() - startedAt}ms`);
+      resolve();
+    });
+    child.once('exit', (code) => {
+      clearTimeout(timer);
+      reject(new Error(`Eye test API exited with code ${code} before ready`));
+    });
+  });
+}
 
+function spawnEyeTestDev() {
   const command = process.platform === 'win32' ? 'pnpm.cmd' : 'pnpm';
   eyeTestProcess = spawn(command, ['dev'], {
     cwd: eyeTestDir,
     shell: false,
     env: { ...process.env },
   });
+  pipeEyeTestOutput(eyeTestProcess);
+}
 
-  eyeTestProcess.stdout.on('data', (data) => {
-    console.log(`[EyeTest] ${data.toString().trim()}`);
-  });
+/**
+ * Start the eye test backend once; callers share the readiness promise
+ * In prod mode this runs at app start, so the exam is warm before it's opened.
+ */
+async function ensureEyeTestProcess() {
+  if (eyeTestReady) return eyeTestReady;
+
+  if (eyeTestMode() === 'prod') {
+    eyeTestReady = forkEyeTestApi().catch((error) => {
+      console.error('❌ Eye test API failed to start:', error);
+      eyeTestReady = null;
+      if (eyeTestProcess && !eyeTestProcess.killed) {
+        eyeTestProcess.kill();
+      }
+      throw error;
+    });
+    return eyeTestReady;
+  }
 
-  eyeTestProcess.stderr.on('data', (data) => {
-    console.error(`[EyeTest:err] ${data.toString().trim()}`);
-  });
+  if (await isEyeTestRunning()) {
+    console.log('🔁 Eye test server already running on port 5173');
+    return;
+  }
 
-  eyeTestProcess.on('close', (code) => {
-    console.log(`👁️ Eye test process exited with code ${code}`);
-    eyeTestProcess = null;
-  });
+  if (eyeTestProcess && !eyeTestProcess.killed) {
+    return;
+  }
+
+  spawnEyeTestDev();
 }
 
 function openEyeTestWindow() {
@@ -122,8 +289,7 @@ function openEyeTestWindow() {
     },
   });
 
-  const eyeTestUrl = 'http://localhost:5173';
-  eyeTestWindow.loadURL(eyeTestUrl);
+  eyeTestWindow.loadURL(eyeTestUrl());
   eyeTestWindow.on('closed', () => {
     eyeTestWindow = null;
   });
@@ -148,6 +314,10 @@ function createWindow() {
   // Make window full screen but not truly fullscreen (so it stays transparent)
   mainWindow.maximize();
 
+  // Keep the overlay out of its own screen capture (Windows/macOS), otherwise
+  // the pre-correction would be applied to its previous output
+  mainWindow.setContentProtection(true);
+
   // Enable click-through for transparent areas, but allow clicking on visible elements
   mainWindow.setIgnoreMouseEvents(true, { forward: true });
 
@@ -168,7 +338,7 @@ function createWindow() {
     console.log('✅ Page finished loading');
   });
 
-  ensurePrescriptionWatcher();
+  ensurePrescriptionStream();
   broadcastPrescription();
 }
 
@@ -232,18 +402,47 @@ ipcMain.on('update-parameters', (event, parameters) => {
 ipcMain.handle('eye-test:start', async () => {
   console.log('🟢 Launching eye test pipeline');
   await ensureEyeTestProcess();
-  ensurePrescriptionWatcher();
+  ensurePrescriptionStream();
   openEyeTestWindow();
-  return readLatestPrescription();
+  return currentPrescription();
 });
 
 ipcMain.handle('eye-test:get-results', async () => {
-  return readLatestPrescription();
+  return currentPrescription();
 });
 
+// Content protection only keeps the overlay out of screen capture on
+// Windows and macOS; elsewhere it would capture (and re-sharpen) itself
+const captureExcludesOverlay = process.platform === 'win32' || process.platform === 'darwin';
+
+// Answer the overlay's getDisplayMedia() with the primary screen, no picker.
+// Refusing the request sends the renderer down its tint fallback.
+function registerDisplayMediaHandler() {
+  session.defaultSession.setDisplayMediaRequestHandler(async (request, callback) => {
+    if (!captureExcludesOverlay) {
+      console.log(`ℹ️ Screen pre-correction unavailable on ${process.platform}, using tint fallback`);
+      callback({});
+      return;
+    }
+    try {
+      const sources = await desktopCapturer.getSources({ types: ['screen'] });
+      callback(sources.length > 0 ? { video: sources[0] } : {});
+    } catch (error) {
+      console.error('❌ Screen capture source lookup failed:', error);
+      callback({});
+    }
+  });
+}
+
 app.whenReady().then(() => {
+  registerDisplayMediaHandler();
   createWindow();
 
+  // Pre-fork the production backend so "start eye test" only opens a window
+  if (eyeTestMode() === 'prod') {
+    ensureEyeTestProcess().catch(() => {});
+  }
+
   app.on('activate', () => {
     if (BrowserWindow.getAllWindows().length === 0) {
       createWindow();
@@ -260,7 +459,7 @@ app.on('window-all-closed', () => {
 app.on('will-quit', () => {
   // Unregister all shortcuts
   globalShortcut.unregisterAll();
-  stopPrescriptionWatcher();
+  stopPrescriptionStream();
   if (eyeTestProcess && !eyeTestProcess.killed) {
     eyeTestProcess.kill();
   }
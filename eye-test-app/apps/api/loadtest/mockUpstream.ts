@@ -0,0 +1,108 @@
+/**
+ * Mock xAI upstream for load tests
+ *
+ * Answers chat completions after a delay drawn either from a recorded list
+ * of latencies (ms) or from a lognormal fitted to a median and p99, so the
+ * API's hint pipeline, deadlines and breakers see realistic timing without
+ * spending real tokens.
+ */
+
+import fs from "fs";
+import http from "http";
+import { AddressInfo } from "net";
+import { Rng } from "../../../packages/core/sim/observer";
+
+export interface LatencyModel {
+  medianMs: number;
+  p99Ms: number;
+  recorded?: number[];   // Sampled uniformly when present
+  errorRate: number;     // Fraction answered with 503
+}
+
+const Z_99 = 2.3263;
+
+/**
+ * Latency sampler for a model; lognormal via Box-Muller
+ */
+export function latencySampler(model: LatencyModel, rng: Rng): () => number {
+  if (model.recorded && model.recorded.length > 0) {
+    const recorded = model.recorded;
+    return () => recorded[Math.floor(rng() * recorded.length)];
+  }
+
+  const mu = Math.log(model.medianMs);
+  const sigma = Math.max(0, Math.log(model.p99Ms / model.medianMs) / Z_99);
+  return () => {
+    const u = Math.max(rng(), Number.EPSILON);
+    const z = Math.sqrt(-2 * Math.log(u)) * Math.cos(2 * Math.PI * rng());
+    return Math.exp(mu + sigma * z);
+  };
+}
+
+/**
+ * Recorded latencies: a JSON array of ms, or {latencies: [...]}
+ */
+export function loadRecordedLatencies(file: string): number[] {
+  const data = JSON.parse(fs.readFileSync(file, "utf8"));
+  const latencies = Array.isArray(data) ? data : data.latencies;
+  if (!Array.isArray(latencies) || latencies.length === 0) {
+    throw new Error(`No latencies in ${file}`);
+  }
+  return latencies.map(Number).filter((ms) => Number.isFinite(ms) && ms >= 0);
+}
+
+const HINTS = [
+  "Reduce step size for finer convergence.",
+  "Repeat the last line to verify.",
+  "Continue the current protocol.",
+  "Enough data collected, complete this eye.",
+];
+
+/**
+ * Start the mock on an ephemeral port; resolves with its base URL
+ */
+export function startMockUpstream(
+  model: LatencyModel,
+  rng: Rng
+): Promise<{ url: string; requests: () => number; close: () => Promise<void> }> {
+  const sample = latencySampler(model, rng);
+  let requests = 0;
+
+  const server = http.createServer((req, res) => {
+    requests++;
+    // Drain the body before answering, like a real upstream
+    req.resume();
+    req.once("end", () => {
+      const timer = setTimeout(() => {
+        if (rng() < model.errorRate) {
+          res.writeHead(503, { "Content-Type": "application/json" });
+          res.end(JSON.stringify({ error: "mock overload" }));
+          return;
+        }
+        res.writeHead(200, { "Content-Type": "application/json" });
+        res.end(
+          JSON.stringify({
+            choices: [{ message: { role: "assistant", content: HINTS[Math.floor(rng() * HINTS.length)] } }],
+          })
+        );
+      }, sample());
+      // Callers that hit their deadline abort; don't answer into a closed socket
+      res.once("close", () => clearTimeout(timer));
+    });
+  });
+
+  return new Promise((resolve) => {
+    server.listen(0, "127.0.0.1", () => {
+      const { port } = server.address() as AddressInfo;
+      resolve({
+        url: `http://127.0.0.1:${port}/v1/chat/completions`,
+        requests: () => requests,
+        close: () =>
+          new Promise((done) => {
+            server.closeAllConnections();
+            server.close(() => done());
+          }),
+      });
+    });
+  });
+}
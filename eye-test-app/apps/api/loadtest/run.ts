@@ -0,0 +1,386 @@
+/**
+ * Exam load test: virtual patients driving the real HTTP routes
+ *
+ *   pnpm --filter @OptiX/api loadtest -- --rate=20 --duration=60
+ *   pnpm --filter @OptiX/api loadtest -- --rate=50 --think-ms=1500 --ai-median-ms=400 --ai-p99-ms=2500
+ *   pnpm --filter @OptiX/api loadtest -- --url=http://localhost:8787 --rate=5
+ *
+ * Exams arrive open-loop (Poisson at --rate per second), so a slow server
+ * builds a backlog instead of quietly lowering the offered load. Each exam
+ * creates a session, runs the threshold search and JCC for both eyes with
+ * answers from the core simulation's virtual patients, logs events and
+ * saves the Rx. By default the API is forked on a scratch database with the
+ * xAI upstream pointed at a local mock (see mockUpstream.ts).
+ */
+
+import { ChildProcess, fork } from "child_process";
+import fs from "fs";
+import os from "os";
+import path from "path";
+import {
+  PatientOptions,
+  Rng,
+  createPatient,
+  createRng,
+  respondAcuity,
+  respondJcc,
+} from "../../../packages/core/sim/observer";
+import { HistogramFamily } from "../src/metrics";
+import { LatencyModel, loadRecordedLatencies, startMockUpstream } from "./mockUpstream";
+
+interface Options {
+  url?: string;
+  rate: number;
+  durationS: number;
+  thinkMs: number;
+  maxTrials: number;
+  eventBatch: number;
+  engine: string;
+  seed: number;
+  patient: PatientOptions;
+  ai: LatencyModel;
+  json: boolean;
+}
+
+const EYES = ["OD", "OS"] as const;
+
+// Client-side latency per route (the server keeps its own at /metrics)
+const clientSeconds = new HistogramFamily("loadtest_request_seconds", "Client-observed latency", [
+  "route",
+  "status",
+]);
+const examSeconds = new HistogramFamily("loadtest_exam_seconds", "Whole-exam duration", ["outcome"]);
+
+function parseArgs(argv: string[]): Record<string, string> {
+  const args: Record<string, string> = {};
+  for (const arg of argv) {
+    const match = /^--([^=]+)(?:=(.*))?$/.exec(arg);
+    if (match) args[match[1]] = match[2] ?? "true";
+  }
+  return args;
+}
+
+function optionalNumber(value: string | undefined): number | undefined {
+  return value === undefined ? undefined : Number(value);
+}
+
+function toOptions(args: Record<string, string>): Options {
+  return {
+    url: args.url,
+    rate: Number(args.rate) || 5,
+    durationS: Number(args.duration) || 60,
+    thinkMs: Number(args["think-ms"]) || 0,
+    maxTrials: Number(args["max-trials"]) || 80,
+    eventBatch: Number(args["event-batch"] ?? 8),
+    engine: args.engine || "quest",
+    seed: Number(args.seed) || 1,
+    patient: {
+      trueLogMAR: optionalNumber(args.logmar),
+      guessRate: optionalNumber(args.guess),
+      lapseRate: optionalNumber(args.lapse),
+    },
+    ai: {
+      medianMs: Number(args["ai-median-ms"]) || 350,
+      p99Ms: Number(args["ai-p99-ms"]) || 1500,
+      recorded: args["ai-latencies"] ? loadRecordedLatencies(args["ai-latencies"]) : undefined,
+      errorRate: Number(args["ai-error-rate"]) || 0,
+    },
+    json: Boolean(args.json),
+  };
+}
+
+class ApiClient {
+  constructor(private readonly baseUrl: string) {}
+
+  /**
+   * JSON request; `route` is the pattern used as the histogram label
+   */
+  async call(route: string, pathname: string, body?: unknown): Promise<any> {
+    const method = route.split(" ")[0];
+    const start = performance.now();
+    let status = "network";
+    try {
+      const response = await fetch(this.baseUrl + pathname, {
+        method,
+        headers: body !== undefined ? { "Content-Type": "application/json" } : undefined,
+        body: body !== undefined ? JSON.stringify(body) : undefined,
+      });
+      status = String(response.status);
+      const data: any = await response.json();
+      if (!response.ok) {
+        throw new Error(`${route} → ${response.status}: ${data?.error ?? "unknown error"}`);
+      }
+      return data;
+    } finally {
+      clientSeconds.observe({ route, status }, (performance.now() - start) / 1000);
+    }
+  }
+
+  text(pathname: string): Promise<string> {
+    return fetch(this.baseUrl + pathname).then((response) => response.text());
+  }
+}
+
+function sleep(ms: number): Promise<void> {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+/**
+ * Patient think time: exponential around --think-ms
+ */
+function think(options: Options, rng: Rng): Promise<void> {
+  if (options.thinkMs <= 0) return Promise.resolve();
+  return sleep(-Math.log(Math.max(rng(), Number.EPSILON)) * options.thinkMs);
+}
+
+/**
+ * One full exam, both eyes
+ */
+async function runExam(api: ApiClient, options: Options, index: number): Promise<void> {
+  const rng = createRng(options.seed * 7919 + index);
+  const { sessionId } = await api.call("POST /api/session", "/api/session", {
+    deviceInfo: "loadtest",
+    distanceCm: 60,
+    screenPpi: 110,
+  });
+
+  let events: any[] = [];
+  const flushEvents = async (force = false) => {
+    if (events.length === 0 || (!force && events.length < options.eventBatch)) return;
+    const batch = events;
+    events = [];
+    if (batch.length === 1) await api.call("POST /api/event", "/api/event", batch[0]);
+    else await api.call("POST /api/event/batch", "/api/event/batch", { events: batch });
+  };
+
+  const results: Record<string, any> = {};
+
+  for (const eye of EYES) {
+    const patient = createPatient(options.patient, rng, eye);
+
+    // Acuity threshold
+    let { state } = await api.call("POST /api/staircase/init", "/api/staircase/init", {
+      sessionId,
+      eye,
+      engine: options.engine,
+    });
+    let sphere: any = null;
+    for (let trial = 0; trial < options.maxTrials; trial++) {
+      await think(options, rng);
+      const wasCorrect = respondAcuity(patient, state.sizeIndex, rng);
+      const latencyMs = Math.round(600 + rng() * 1800);
+      sphere = await api.call("POST /api/staircase/next", "/api/staircase/next", {
+        sessionId,
+        eye,
+        wasCorrect,
+        latencyMs,
+      });
+      events.push({
+        sessionId,
+        t: Date.now(),
+        step: `sphere_${eye}`,
+        correct: wasCorrect,
+        latencyMs,
+        params: { sizeIndex: state.sizeIndex },
+      });
+      await flushEvents();
+      state = sphere.state;
+      if (sphere.complete) break;
+    }
+
+    // Cylinder/axis
+    let jcc: any = await api.call("POST /api/jcc/init", "/api/jcc/init", { sessionId, eye });
+    for (let trial = 0; trial < options.maxTrials && !jcc.complete; trial++) {
+      await think(options, rng);
+      // The JCC summary carries stage/axisDeg/cyl, all the observer reads
+      const choice = respondJcc(patient, jcc.state, rng);
+      jcc = await api.call("POST /api/jcc/next", "/api/jcc/next", { sessionId, eye, choice });
+      events.push({ sessionId, t: Date.now(), step: `jcc_${eye}`, params: { choice } });
+      await flushEvents();
+    }
+
+    results[eye] = {
+      S: sphere?.sphere ?? 0,
+      C: jcc.result?.cyl ?? 0,
+      Axis: jcc.result?.axis ?? 0,
+      VA_logMAR: sphere?.threshold ?? null,
+      confidence: sphere?.confidence ?? null,
+    };
+  }
+
+  await flushEvents(true);
+  await api.call("POST /api/summary", "/api/summary", { sessionId, results });
+  await api.call("GET /api/summary/:sessionId", `/api/summary/${sessionId}`);
+}
+
+/**
+ * Fork the API on a scratch database; resolves once it reports ready
+ */
+function spawnApi(env: NodeJS.ProcessEnv): Promise<{ child: ChildProcess; url: string }> {
+  const port = 18000 + Math.floor(Math.random() * 2000);
+  // Inherit execArgv so the tsx loader is registered in the child too
+  const child = fork(path.join(__dirname, "../src/index.ts"), [], {
+    execArgv: process.execArgv,
+    env: { ...env, PORT: String(port) },
+    stdio: ["ignore", "ignore", "inherit", "ipc"],
+  });
+
+  return new Promise((resolve, reject) => {
+    const timer = setTimeout(() => reject(new Error("API did not become ready in 30s")), 30000);
+    child.on("message", (message: any) => {
+      if (message?.type === "ready") {
+        clearTimeout(timer);
+        resolve({ child, url: `http://127.0.0.1:${message.port}` });
+      }
+    });
+    child.once("exit", (code) => {
+      clearTimeout(timer);
+      reject(new Error(`API exited with code ${code} before becoming ready`));
+    });
+  });
+}
+
+/**
+ * Sum of a Prometheus counter across its label sets
+ */
+function sumCounter(text: string, name: string): number {
+  let total = 0;
+  for (const line of text.split("\n")) {
+    if (line.startsWith(name + "{") || line.startsWith(name + " ")) {
+      total += Number(line.slice(line.lastIndexOf(" ") + 1)) || 0;
+    }
+  }
+  return total;
+}
+
+async function main() {
+  const options = toOptions(parseArgs(process.argv.slice(2)));
+  const rng = createRng(options.seed);
+
+  let child: ChildProcess | null = null;
+  let mock: Awaited<ReturnType<typeof startMockUpstream>> | null = null;
+  let scratchDir: string | null = null;
+  let baseUrl = options.url;
+
+  if (!baseUrl) {
+    mock = await startMockUpstream(options.ai, createRng(options.seed + 1));
+    scratchDir = fs.mkdtempSync(path.join(os.tmpdir(), "optix-loadtest-"));
+    const spawned = await spawnApi({
+      ...process.env,
+      DATABASE_URL: `file:${path.join(scratchDir, "loadtest.sqlite")}`,
+      XAI_API_URL: mock.url,
+      XAI_GROK_API_KEY: "loadtest",
+      ELEVENLABS_API_KEY: "",
+      GEMINI_API_KEY: "",
+      LOG_LEVEL: process.env.LOG_LEVEL || "warn",
+    });
+    child = spawned.child;
+    baseUrl = spawned.url;
+  }
+
+  const api = new ApiClient(baseUrl);
+  const busyBefore = sumCounter(await api.text("/metrics"), "optix_sqlite_busy_total");
+
+  console.log(
+    `🏋️ Load test: ${options.rate} exams/s for ${options.durationS}s against ${baseUrl}` +
+      (mock ? ` (mock AI median ${options.ai.medianMs}ms, p99 ${options.ai.p99Ms}ms)` : "")
+  );
+
+  let started = 0;
+  let completed = 0;
+  let failed = 0;
+  let inflight = 0;
+  let peakInflight = 0;
+  const errors = new Map<string, number>();
+  const exams: Promise<void>[] = [];
+
+  const startedAt = performance.now();
+  const endAt = startedAt + options.durationS * 1000;
+  let nextArrival = startedAt;
+
+  const progress = setInterval(() => {
+    console.log(`   … started=${started} completed=${completed} failed=${failed} inflight=${inflight}`);
+  }, 5000);
+
+  // Open loop: arrival times are fixed in advance of any response
+  while (nextArrival < endAt) {
+    const wait = nextArrival - performance.now();
+    if (wait > 0) await sleep(wait);
+
+    const index = started++;
+    inflight++;
+    peakInflight = Math.max(peakInflight, inflight);
+    const examStart = performance.now();
+    exams.push(
+      runExam(api, options, index)
+        .then(() => {
+          completed++;
+          examSeconds.observe({ outcome: "ok" }, (performance.now() - examStart) / 1000);
+        })
+        .catch((error) => {
+          failed++;
+          examSeconds.observe({ outcome: "error" }, (performance.now() - examStart) / 1000);
+          const key = String(error?.message ?? error).slice(0, 120);
+          errors.set(key, (errors.get(key) ?? 0) + 1);
+        })
+        .finally(() => inflight--)
+    );
+
+    nextArrival += (-Math.log(Math.max(rng(), Number.EPSILON)) / options.rate) * 1000;
+  }
+
+  await Promise.all(exams);
+  clearInterval(progress);
+  const elapsedS = (performance.now() - startedAt) / 1000;
+
+  const metricsText = await api.text("/metrics");
+  const server = await api.call("GET /metrics/summary", "/metrics/summary");
+  const requests = clientSeconds.summary();
+  const totalRequests = requests.reduce((sum, row) => sum + row.count, 0);
+
+  const report = {
+    offeredExamsPerSec: options.rate,
+    examsStarted: started,
+    examsCompleted: completed,
+    examsFailed: failed,
+    examsPerSec: Math.round((completed / elapsedS) * 100) / 100,
+    requestsPerSec: Math.round(totalRequests / elapsedS),
+    peakInflightExams: peakInflight,
+    sqliteBusy: sumCounter(metricsText, "optix_sqlite_busy_total") - busyBefore,
+    mockAiRequests: mock?.requests() ?? null,
+  };
+
+  console.log("\n📈 Throughput");
+  console.table([report]);
+  console.log("⏱️ Client latency by route");
+  console.table(requests);
+  console.log("⏱️ Exam duration");
+  console.table(examSeconds.summary());
+  console.log("🗄️ SQLite statements (server-side, slowest p99 first)");
+  console.table([...server.sqlite].sort((a: any, b: any) => b.p99Ms - a.p99Ms).slice(0, 15));
+  console.log("🧩 Pipeline stages (server-side)");
+  console.table(server.stages);
+
+  if (errors.size > 0) {
+    console.error("❌ Exam failures:");
+    for (const [message, count] of errors) console.error(`  ${count}× ${message}`);
+  }
+
+  if (options.json) {
+    console.log(JSON.stringify({ report, requests, exams: examSeconds.summary(), server }));
+  }
+
+  if (child) {
+    const exited = new Promise((resolve) => child!.once("exit", resolve));
+    child.kill("SIGTERM");
+    await exited;
+  }
+  await mock?.close();
+  if (scratchDir) fs.rmSync(scratchDir, { recursive: true, force: true });
+  process.exit(failed > 0 ? 1 : 0);
+}
+
+main().catch((error) => {
+  console.error("❌ Load test failed:", error);
+  process.exit(1);
+});
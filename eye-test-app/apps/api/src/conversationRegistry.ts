@@ -0,0 +1,244 @@
+/**
+ * Registry of live ElevenLabs conversations per session/eye
+ *
+ * Backends are pluggable via CONVERSATION_STORE:
+ *   memory - single process only
+ *   sqlite - default; shared by every process on the host (cluster mode)
+ *   redis  - shared across nodes (REDIS_URL, needs the optional `ioredis`)
+ * Entries expire after CONVERSATION_TTL_MS without use. A sweeper claims
+ * expired entries atomically, so exactly one process calls endConversation
+ * for each abandoned conversation.
+ */
+
+import { endConversation } from "@OptiX/voice";
+import { conversationQueries } from "./db";
+import { dbWriter } from "./dbWriter";
+
+const TTL_MS = Number(process.env.CONVERSATION_TTL_MS) || 30 * 60 * 1000;
+const SWEEP_INTERVAL_MS = Number(process.env.CONVERSATION_SWEEP_MS) || 60 * 1000;
+
+export interface ExpiredConversation {
+  key: string;
+  conversationId: string;
+}
+
+export interface ConversationStore {
+  readonly name: string;
+  set(key: string, conversationId: string, expiresAt: number): Promise<void>;
+  /** Look up and slide the TTL; null when missing or expired */
+  touch(key: string, expiresAt: number, now: number): Promise<string | null>;
+  delete(key: string): Promise<string | null>;
+  active(now: number): Promise<string[]>;
+  /** Remove and return expired entries (each entry returned to one caller only) */
+  claimExpired(now: number): Promise<ExpiredConversation[]>;
+}
+
+class MemoryConversationStore implements ConversationStore {
+  readonly name = "memory";
+  private entries = new Map<string, { conversationId: string; expiresAt: number }>();
+
+  async set(key: string, conversationId: string, expiresAt: number) {
+    this.entries.set(key, { conversationId, expiresAt });
+  }
+
+  async touch(key: string, expiresAt: number, now: number) {
+    const entry = this.entries.get(key);
+    if (!entry || entry.expiresAt <= now) return null;
+    entry.expiresAt = expiresAt;
+    return entry.conversationId;
+  }
+
+  async delete(key: string) {
+    const entry = this.entries.get(key);
+    this.entries.delete(key);
+    return entry?.conversationId ?? null;
+  }
+
+  async active(now: number) {
+    return Array.from(this.entries)
+      .filter(([, entry]) => entry.expiresAt > now)
+      .map(([key]) => key);
+  }
+
+  async claimExpired(now: number) {
+    const expired: ExpiredConversation[] = [];
+    for (const [key, entry] of this.entries) {
+      if (entry.expiresAt <= now) {
+        this.entries.delete(key);
+        expired.push({ key, conversationId: entry.conversationId });
+      }
+    }
+    return expired;
+  }
+}
+
+/**
+ * Writes go through the writer thread (with their RETURNING rows), so a
+ * busy WAL lock never stalls the event loop; only `active` reads here
+ */
+class SqliteConversationStore implements ConversationStore {
+  readonly name = "sqlite";
+
+  async set(key: string, conversationId: string, expiresAt: number) {
+    await dbWriter.commit(["conversations.upsert", [key, conversationId, expiresAt]]);
+  }
+
+  async touch(key: string, expiresAt: number, now: number) {
+    const [rows] = await dbWriter.commitReturning(["conversations.touch", [expiresAt, key, now]]);
+    return (rows[0] as { conversationId: string } | undefined)?.conversationId ?? null;
+  }
+
+  async delete(key: string) {
+    const [rows] = await dbWriter.commitReturning(["conversations.delete", [key]]);
+    return (rows[0] as { conversationId: string } | undefined)?.conversationId ?? null;
+  }
+
+  async active(now: number) {
+    return (conversationQueries.active.all(now) as Array<{ key: string }>).map((row) => row.key);
+  }
+
+  async claimExpired(now: number) {
+    const [rows] = await dbWriter.commitReturning(["conversations.claimExpired", [now]]);
+    return rows as ExpiredConversation[];
+  }
+}
+
+/**
+ * Redis layout: a hash of key → conversationId plus a sorted set of
+ * key → expiresAt. ZREM is the claim: only the node whose ZREM returns 1
+ * ends the conversation.
+ */
+class RedisConversationStore implements ConversationStore {
+  readonly name = "redis";
+  private static readonly IDS = "optix:conversations";
+  private static readonly EXPIRY = "optix:conversations:expiry";
+
+  constructor(private readonly redis: any) {}
+
+  async set(key: string, conversationId: string, expiresAt: number) {
+    await this.redis
+      .multi()
+      .hset(RedisConversationStore.IDS, key, conversationId)
+      .zadd(RedisConversationStore.EXPIRY, expiresAt, key)
+      .exec();
+  }
+
+  async touch(key: string, expiresAt: number, now: number) {
+    const score = await this.redis.zscore(RedisConversationStore.EXPIRY, key);
+    if (score === null || Number(score) <= now) return null;
+    // XX: only slide an entry that still exists (a sweeper may have claimed it)
+    await this.redis.zadd(RedisConversationStore.EXPIRY, "XX", expiresAt, key);
+    return this.redis.hget(RedisConversationStore.IDS, key);
+  }
+
+  async delete(key: string) {
+    const [[, conversationId]] = await this.redis
+      .multi()
+      .hget(RedisConversationStore.IDS, key)
+      .hdel(RedisConversationStore.IDS, key)
+      .zrem(RedisConversationStore.EXPIRY, key)
+      .exec();
+    return conversationId ?? null;
+  }
+
+  async active(now: number) {
+    return this.redis.zrangebyscore(RedisConversationStore.EXPIRY, `(${now}`, "+inf");
+  }
+
+  async claimExpired(now: number) {
+    const keys: string[] = await this.redis.zrangebyscore(RedisConversationStore.EXPIRY, "-inf", now);
+    const expired: ExpiredConversation[] = [];
+    for (const key of keys) {
+      if ((await this.redis.zrem(RedisConversationStore.EXPIRY, key)) !== 1) continue;
+      const conversationId = await this.redis.hget(RedisConversationStore.IDS, key);
+      await this.redis.hdel(RedisConversationStore.IDS, key);
+      if (conversationId) expired.push({ key, conversationId });
+    }
+    return expired;
+  }
+}
+
+function createStore(): ConversationStore {
+  const backend = process.env.CONVERSATION_STORE || "sqlite";
+
+  if (backend === "redis") {
+    try {
+      // Optional dependency: only loaded when Redis is selected
+      // eslint-disable-next-line @typescript-eslint/no-var-requires
+      const Redis = require("ioredis");
+      return new RedisConversationStore(new Redis(process.env.REDIS_URL || "redis://localhost:6379"));
+    } catch (error) {
+      console.error("❌ CONVERSATION_STORE=redis but ioredis is unavailable, using sqlite:", error);
+      return new SqliteConversationStore();
+    }
+  }
+
+  return backend === "memory" ? new MemoryConversationStore() : new SqliteConversationStore();
+}
+
+function keyOf(sessionId: string, eye: string): string {
+  return `${sessionId}-${eye}`;
+}
+
+class ConversationRegistry {
+  private store = createStore();
+  private sweeper: NodeJS.Timeout | null = null;
+
+  constructor() {
+    console.log(`🗂️ Conversation registry: ${this.store.name} (TTL ${TTL_MS / 1000}s)`);
+    // Shared stores may hold entries left by other (or earlier) processes
+    this.startSweeper();
+  }
+
+  async register(sessionId: string, eye: string, conversationId: string): Promise<void> {
+    await this.store.set(keyOf(sessionId, eye), conversationId, Date.now() + TTL_MS);
+  }
+
+  /**
+   * Conversation for a session/eye, extending its TTL
+   */
+  async lookup(sessionId: string, eye: string): Promise<string | null> {
+    const now = Date.now();
+    return this.store.touch(keyOf(sessionId, eye), now + TTL_MS, now);
+  }
+
+  /**
+   * Remove a conversation and end it upstream; false if none was registered
+   */
+  async end(sessionId: string, eye: string): Promise<boolean> {
+    const conversationId = await this.store.delete(keyOf(sessionId, eye));
+    if (!conversationId) return false;
+    await endConversation(conversationId);
+    return true;
+  }
+
+  active(): Promise<string[]> {
+    return this.store.active(Date.now());
+  }
+
+  /**
+   * End conversations abandoned past their TTL
+   */
+  async sweep(): Promise<number> {
+    const expired = await this.store.claimExpired(Date.now());
+    for (const { key, conversationId } of expired) {
+      try {
+        await endConversation(conversationId);
+        console.log(`🧹 Ended abandoned conversation for ${key}`);
+      } catch (error) {
+        console.error(`❌ Failed to end abandoned conversation for ${key}:`, error);
+      }
+    }
+    return expired.length;
+  }
+
+  private startSweeper() {
+    if (this.sweeper) return;
+    this.sweeper = setInterval(() => {
+      this.sweep().catch((error) => console.error("❌ Conversation sweep failed:", error));
+    }, SWEEP_INTERVAL_MS);
+    this.sweeper.unref();
+  }
+}
+
+export const conversations = new ConversationRegistry();
@@ -0,0 +1,109 @@
+/**
+ * Population dashboard built from the rollups table
+ *
+ * Rollups are maintained by SQLite triggers (see db.ts), so a dashboard is
+ * a read of O(days × buckets) rows. Results are cached per range for
+ * DASHBOARD_CACHE_MS; writes made through this process invalidate the
+ * cache at once, other processes' writes show up within the TTL.
+ */
+
+import { rollupQueries } from "./db";
+import { stepName } from "./trials";
+
+const CACHE_TTL_MS = Number(process.env.DASHBOARD_CACHE_MS) || 30 * 1000;
+const MAX_CACHED_RANGES = 64;
+
+interface RollupTotal {
+  metric: string;
+  bucket: number;
+  count: number;
+  sum: number;
+}
+
+export interface Dashboard {
+  from: string;
+  to: string;
+  generatedAt: string;
+  days: Array<{ day: string; created: number; completed: number }>;
+  rx: {
+    sphere: Array<{ bucket: number; count: number }>;
+    cyl: Array<{ bucket: number; count: number }>;
+    confidence: Array<{ bucket: number; count: number }>;
+    meanSphere: number | null;
+    meanCyl: number | null;
+  };
+  trialsToConvergence: Array<{ stage: string; eyes: number; meanTrials: number | null }>;
+}
+
+function mean(rows: RollupTotal[]): number | null {
+  const count = rows.reduce((total, row) => total + row.count, 0);
+  if (count === 0) return null;
+  return Math.round((rows.reduce((total, row) => total + row.sum, 0) / count) * 100) / 100;
+}
+
+function build(from: string, to: string): Dashboard {
+  const totals = rollupQueries.totals.all(from, to) as RollupTotal[];
+  const byMetric = (metric: string) => totals.filter((row) => row.metric === metric);
+  const histogram = (metric: string) => byMetric(metric).map(({ bucket, count }) => ({ bucket, count }));
+
+  const days = new Map<string, { day: string; created: number; completed: number }>();
+  for (const row of rollupQueries.sessionsByDay.all(from, to) as Array<{ day: string; metric: string; count: number }>) {
+    const entry = days.get(row.day) ?? { day: row.day, created: 0, completed: 0 };
+    if (row.metric === "sessions_created") entry.created = row.count;
+    else entry.completed = row.count;
+    days.set(row.day, entry);
+  }
+
+  return {
+    from,
+    to,
+    generatedAt: new Date().toISOString(),
+    days: Array.from(days.values()),
+    rx: {
+      sphere: histogram("rx_sphere"),
+      cyl: histogram("rx_cyl"),
+      confidence: histogram("rx_confidence"),
+      meanSphere: mean(byMetric("rx_sphere")),
+      meanCyl: mean(byMetric("rx_cyl")),
+    },
+    trialsToConvergence: [
+      ...byMetric("acuity_trials").map((row) => ({
+        stage: stepName(row.bucket),
+        eyes: row.count,
+        meanTrials: mean([row]),
+      })),
+      ...byMetric("jcc_trials").map((row) => ({ stage: "jcc", eyes: row.count, meanTrials: mean([row]) })),
+    ],
+  };
+}
+
+class DashboardCache {
+  private entries = new Map<string, { at: number; dashboard: Dashboard }>();
+
+  get(from: string, to: string): Dashboard {
+    const key = `${from}|${to}`;
+    const hit = this.entries.get(key);
+    if (hit && Date.now() - hit.at < CACHE_TTL_MS) return hit.dashboard;
+
+    const dashboard = build(from, to);
+    this.entries.delete(key);
+    this.entries.set(key, { at: Date.now(), dashboard });
+    if (this.entries.size > MAX_CACHED_RANGES) {
+      this.entries.delete(this.entries.keys().next().value!);
+    }
+    return dashboard;
+  }
+
+  /**
+   * Drop cached dashboards after a write that changes rollups
+   */
+  invalidate(): void {
+    this.entries.clear();
+  }
+
+  get ttlMs(): number {
+    return CACHE_TTL_MS;
+  }
+}
+
+export const dashboards = new DashboardCache();
@@ -4,8 +4,10 @@
 
 import Database from "better-sqlite3";
 import path from "path";
+import { timeSqlite } from "./metrics";
+import { WRITE_SQL, WriteOp, WriteRows, WriteStatement } from "./writeStatements";
 
-const DB_PATH = process.env.DATABASE_URL?.replace("file:", "") || "./OptiX.sqlite";
+export const DB_PATH = process.env.DATABASE_URL?.replace("file:", "") || "./OptiX.sqlite";
 
 export const db = new Database(DB_PATH);
 
@@ -20,6 +22,7 @@ function initDB() {
     CREATE TABLE IF NOT EXISTS sessions (
       id TEXT PRIMARY KEY,
       createdAt TEXT NOT NULL,
+      createdAtMs INTEGER,
       deviceInfo TEXT,
       distanceCm REAL,
       screenPpi REAL,
@@ -52,72 +55,494 @@ function initDB() {
       FOREIGN KEY (sessionId) REFERENCES sessions(id)
     );
 
-    CREATE INDEX IF NOT EXISTS idx_events_session ON events(sessionId);
+    CREATE TABLE IF NOT EXISTS exam_state (
+      sessionId TEXT NOT NULL,
+      eye TEXT NOT NULL,
+      kind TEXT NOT NULL,
+      state TEXT NOT NULL,
+      updatedAt INTEGER NOT NULL,
+      PRIMARY KEY (sessionId, eye, kind),
+      FOREIGN KEY (sessionId) REFERENCES sessions(id)
+    );
+
+    -- One typed row per exam trial (see trials.ts for the step/eye codes);
+    -- analytics read these columns instead of parsing events.params
+    CREATE TABLE IF NOT EXISTS trials (
+      id INTEGER PRIMARY KEY,
+      sessionId TEXT NOT NULL,
+      t INTEGER NOT NULL,
+      eye INTEGER NOT NULL,
+      step INTEGER NOT NULL,
+      sizeIndex INTEGER,
+      correct INTEGER,
+      latencyMs INTEGER,
+      axisDeg REAL,
+      cyl REAL,
+      choice INTEGER,
+      FOREIGN KEY (sessionId) REFERENCES sessions(id)
+    );
+
+    CREATE TABLE IF NOT EXISTS conversations (
+      key TEXT PRIMARY KEY,
+      conversationId TEXT NOT NULL,
+      expiresAt INTEGER NOT NULL
+    );
+
     CREATE INDEX IF NOT EXISTS idx_events_step ON events(step);
+    CREATE INDEX IF NOT EXISTS idx_conversations_expires ON conversations(expiresAt);
+    CREATE INDEX IF NOT EXISTS idx_trials_session ON trials(sessionId, t);
+    -- Covering index: aggregates over a step and time range never touch the table
+    CREATE INDEX IF NOT EXISTS idx_trials_analytics ON trials(step, t, sizeIndex, correct, latencyMs);
   `);
 
+  migrateDB();
+  initRollups();
+
   console.log("✅ Database initialized at", DB_PATH);
 }
 
+/**
+ * Additive migrations for databases created by older versions
+ */
+function migrateDB() {
+  const sessionColumns = db.prepare("PRAGMA table_info(sessions)").all() as Array<{ name: string }>;
+  if (!sessionColumns.some((column) => column.name === "createdAtMs")) {
+    db.exec("ALTER TABLE sessions ADD COLUMN createdAtMs INTEGER");
+  }
+
+  // Sortable integer timestamp; datetime(createdAt) in ORDER BY can't use an index
+  db.exec(`
+    UPDATE sessions
+    SET createdAtMs = CAST((julianday(createdAt) - 2440587.5) * 86400000 AS INTEGER)
+    WHERE createdAtMs IS NULL;
+
+    CREATE INDEX IF NOT EXISTS idx_sessions_created ON sessions(createdAtMs, id);
+
+    -- (sessionId, t) plus the implicit rowid serves replay order and keyset seeks
+    DROP INDEX IF EXISTS idx_events_session;
+    CREATE INDEX IF NOT EXISTS idx_events_session_t ON events(sessionId, t);
+  `);
+}
+
+/**
+ * Population rollups for dashboards, maintained by triggers in the same
+ * transaction as the write that changes them (whichever connection makes
+ * it), so they never drift and reads never scan raw rows.
+ *
+ * Keyed by the session's creation day (UTC). `bucket` is the bucket's
+ * value (0 for plain counts); `sum` carries the numerator for means.
+ *   sessions_created / sessions_completed
+ *   rx_sphere (0.5 D), rx_cyl (0.25 D), rx_confidence (0.1)
+ *   acuity_trials (bucket = trial step code; count = eyes, sum = trials)
+ *   jcc_trials    (count = eyes, sum = trials)
+ */
+const ROLLUP_UPSERT = `
+  ON CONFLICT (day, metric, bucket) DO UPDATE SET
+    count = count + excluded.count,
+    sum = sum + excluded.sum;
+`;
+
+function sessionDay(ref: "NEW" | "OLD"): string {
+  return `date(${ref}.createdAtMs / 1000, 'unixepoch')`;
+}
+
+/**
+ * Add (sign 1) or remove (sign -1) one Rx row's contribution
+ */
+function rxRollup(ref: "NEW" | "OLD", sign: 1 | -1): string {
+  const day = `COALESCE((SELECT date(createdAtMs / 1000, 'unixepoch') FROM sessions WHERE id = ${ref}.sessionId), 'unknown')`;
+  return `
+    INSERT INTO rollups (day, metric, bucket, count, sum)
+    SELECT ${day}, 'rx_sphere', ROUND(${ref}.S * 2) / 2.0, ${sign}, ${sign} * ${ref}.S
+    UNION ALL
+    SELECT ${day}, 'rx_cyl', ROUND(${ref}.C * 4) / 4.0, ${sign}, ${sign} * ${ref}.C
+    UNION ALL
+    SELECT ${day}, 'rx_confidence', ROUND(${ref}.confidence * 10) / 10.0, ${sign}, ${sign} * ${ref}.confidence
+    WHERE ${ref}.confidence IS NOT NULL
+    ${ROLLUP_UPSERT}`;
+}
+
+/**
+ * Add or remove a completed session's trials-to-convergence
+ */
+function trialRollup(ref: "NEW" | "OLD", sign: 1 | -1): string {
+  return `
+    INSERT INTO rollups (day, metric, bucket, count, sum)
+    SELECT ${sessionDay(ref)},
+           CASE WHEN step IN (1, 2) THEN 'acuity_trials' ELSE 'jcc_trials' END,
+           CASE WHEN step IN (1, 2) THEN step ELSE 0 END,
+           ${sign} * COUNT(DISTINCT eye),
+           ${sign} * COUNT(*)
+    FROM trials WHERE sessionId = ${ref}.id
+    GROUP BY 2, 3
+    ${ROLLUP_UPSERT}`;
+}
+
+const ROLLUP_SQL = `
+  CREATE TABLE IF NOT EXISTS rollups (
+    day TEXT NOT NULL,
+    metric TEXT NOT NULL,
+    bucket REAL NOT NULL,
+    count INTEGER NOT NULL,
+    sum REAL NOT NULL,
+    PRIMARY KEY (day, metric, bucket)
+  ) WITHOUT ROWID;
+
+  CREATE TRIGGER IF NOT EXISTS rollup_session_created AFTER INSERT ON sessions
+  BEGIN
+    INSERT INTO rollups (day, metric, bucket, count, sum)
+    VALUES (${sessionDay("NEW")}, 'sessions_created', 0, 1, 0)
+    ${ROLLUP_UPSERT}
+  END;
+
+  CREATE TRIGGER IF NOT EXISTS rollup_session_completed AFTER UPDATE OF state ON sessions
+  WHEN NEW.state = 'completed' AND OLD.state IS NOT 'completed'
+  BEGIN
+    INSERT INTO rollups (day, metric, bucket, count, sum)
+    VALUES (${sessionDay("NEW")}, 'sessions_completed', 0, 1, 0)
+    ${ROLLUP_UPSERT}
+    ${trialRollup("NEW", 1)}
+  END;
+
+  CREATE TRIGGER IF NOT EXISTS rollup_session_reopened AFTER UPDATE OF state ON sessions
+  WHEN OLD.state = 'completed' AND NEW.state IS NOT 'completed'
+  BEGIN
+    INSERT INTO rollups (day, metric, bucket, count, sum)
+    VALUES (${sessionDay("OLD")}, 'sessions_completed', 0, -1, 0)
+    ${ROLLUP_UPSERT}
+    ${trialRollup("OLD", -1)}
+  END;
+
+  CREATE TRIGGER IF NOT EXISTS rollup_rx_insert AFTER INSERT ON rx
+  BEGIN
+    ${rxRollup("NEW", 1)}
+  END;
+
+  -- rxQueries.upsert on an existing row fires this, not the insert trigger
+  CREATE TRIGGER IF NOT EXISTS rollup_rx_update AFTER UPDATE ON rx
+  BEGIN
+    ${rxRollup("OLD", -1)}
+    ${rxRollup("NEW", 1)}
+  END;
+
+  CREATE TRIGGER IF NOT EXISTS rollup_rx_delete AFTER DELETE ON rx
+  BEGIN
+    ${rxRollup("OLD", -1)}
+  END;
+`;
+
+/**
+ * Rollup table and triggers; backfilled from existing rows when first created
+ */
+function initRollups() {
+  const existed = db
+    .prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'rollups'")
+    .get();
+
+  db.transaction(() => {
+    db.exec(ROLLUP_SQL);
+    if (!existed) rebuildRollups();
+  })();
+}
+
+/**
+ * Recompute every rollup from raw rows (one-off backfill / repair)
+ */
+export function rebuildRollups() {
+  db.exec(`
+    DELETE FROM rollups;
+
+    INSERT INTO rollups (day, metric, bucket, count, sum)
+    SELECT date(createdAtMs / 1000, 'unixepoch'), 'sessions_created', 0, COUNT(*), 0
+    FROM sessions GROUP BY 1;
+
+    INSERT INTO rollups (day, metric, bucket, count, sum)
+    SELECT date(createdAtMs / 1000, 'unixepoch'), 'sessions_completed', 0, COUNT(*), 0
+    FROM sessions WHERE state = 'completed' GROUP BY 1;
+
+    INSERT INTO rollups (day, metric, bucket, count, sum)
+    SELECT day, metric, bucket, SUM(eyes), SUM(trials) FROM (
+      SELECT date(s.createdAtMs / 1000, 'unixepoch') AS day,
+             CASE WHEN t.step IN (1, 2) THEN 'acuity_trials' ELSE 'jcc_trials' END AS metric,
+             CASE WHEN t.step IN (1, 2) THEN t.step ELSE 0 END AS bucket,
+             COUNT(DISTINCT t.eye) AS eyes, COUNT(*) AS trials
+      FROM sessions s JOIN trials t ON t.sessionId = s.id
+      WHERE s.state = 'completed'
+      GROUP BY s.id, 2, 3
+    ) GROUP BY day, metric, bucket;
+
+    INSERT INTO rollups (day, metric, bucket, count, sum)
+    SELECT day, metric, bucket, COUNT(*), SUM(value) FROM (
+      SELECT COALESCE(date(s.createdAtMs / 1000, 'unixepoch'), 'unknown') AS day,
+             'rx_sphere' AS metric, ROUND(r.S * 2) / 2.0 AS bucket, r.S AS value
+      FROM rx r LEFT JOIN sessions s ON s.id = r.sessionId
+      UNION ALL
+      SELECT COALESCE(date(s.createdAtMs / 1000, 'unixepoch'), 'unknown'), 'rx_cyl', ROUND(r.C * 4) / 4.0, r.C
+      FROM rx r LEFT JOIN sessions s ON s.id = r.sessionId
+      UNION ALL
+      SELECT COALESCE(date(s.createdAtMs / 1000, 'unixepoch'), 'unknown'), 'rx_confidence', ROUND(r.confidence * 10) / 10.0, r.confidence
+      FROM rx r LEFT JOIN sessions s ON s.id = r.sessionId
+      WHERE r.confidence IS NOT NULL
+    ) GROUP BY day, metric, bucket;
+  `);
+}
+
 // Initialize database immediately
 initDB();
 
+/**
+ * Route a query group's statements through the SQLite latency histogram
+ * (series are labelled `<group>.<name>`)
+ */
+function instrumented<Q extends Record<string, Database.Statement>>(group: string, queries: Q): Q {
+  for (const [name, statement] of Object.entries(queries)) {
+    const label = `${group}.${name}`;
+    for (const method of ["run", "get", "all"] as const) {
+      const original = statement[method].bind(statement) as (...args: unknown[]) => unknown;
+      (statement as any)[method] = (...args: unknown[]) => timeSqlite(label, () => original(...args));
+    }
+  }
+  return queries;
+}
+
 /**
  * Session queries
  */
-export const sessionQueries = {
-  create: db.prepare(`
-    INSERT INTO sessions (id, createdAt, deviceInfo, distanceCm, screenPpi, lighting, state)
-    VALUES (?, ?, ?, ?, ?, ?, ?)
-  `),
+export const sessionQueries = instrumented("sessions", {
+  create: db.prepare(WRITE_SQL["sessions.create"]),
 
   getById: db.prepare("SELECT * FROM sessions WHERE id = ?"),
 
-  updateState: db.prepare("UPDATE sessions SET state = ? WHERE id = ?"),
+  updateState: db.prepare(WRITE_SQL["sessions.updateState"]),
 
-  getLatest: db.prepare("SELECT * FROM sessions ORDER BY datetime(createdAt) DESC LIMIT 1"),
+  getLatest: db.prepare("SELECT * FROM sessions ORDER BY createdAtMs DESC, id DESC LIMIT 1"),
 
-  getAll: db.prepare("SELECT * FROM sessions ORDER BY createdAt DESC LIMIT 100"),
-};
+  // Keyset pages, newest first: (limit) and (createdAtMs, id, limit)
+  getPage: db.prepare("SELECT * FROM sessions ORDER BY createdAtMs DESC, id DESC LIMIT ?"),
+
+  getPageBefore: db.prepare(`
+    SELECT * FROM sessions
+    WHERE (createdAtMs, id) < (?, ?)
+    ORDER BY createdAtMs DESC, id DESC
+    LIMIT ?
+  `),
+});
 
 /**
  * Event queries
  */
-export const eventQueries = {
-  create: db.prepare(`
-    INSERT INTO events (sessionId, t, step, lettersShown, speechText, correct, latencyMs, params)
-    VALUES (?, ?, ?, ?, ?, ?, ?, ?)
-  `),
+export const eventQueries = instrumented("events", {
+  create: db.prepare(WRITE_SQL["events.create"]),
 
   getBySession: db.prepare(
-    "SELECT * FROM events WHERE sessionId = ? ORDER BY t ASC"
+    "SELECT * FROM events WHERE sessionId = ? ORDER BY t ASC, id ASC"
   ),
 
   getRecent: db.prepare(
     "SELECT * FROM events WHERE sessionId = ? ORDER BY t DESC LIMIT ?"
   ),
-};
+
+  // Keyset pages in replay order: (sessionId, limit) and (sessionId, t, id, limit)
+  getPage: db.prepare(
+    "SELECT * FROM events WHERE sessionId = ? ORDER BY t ASC, id ASC LIMIT ?"
+  ),
+
+  getPageAfter: db.prepare(`
+    SELECT * FROM events
+    WHERE sessionId = ? AND (t, id) > (?, ?)
+    ORDER BY t ASC, id ASC
+    LIMIT ?
+  `),
+});
 
 /**
  * Rx queries
  */
-export const rxQueries = {
-  upsert: db.prepare(`
-    INSERT INTO rx (sessionId, eye, S, C, Axis, VA_logMAR, confidence)
-    VALUES (?, ?, ?, ?, ?, ?, ?)
-    ON CONFLICT(sessionId, eye) DO UPDATE SET
-      S = excluded.S,
-      C = excluded.C,
-      Axis = excluded.Axis,
-      VA_logMAR = excluded.VA_logMAR,
-      confidence = excluded.confidence
-  `),
+export const rxQueries = instrumented("rx", {
+  upsert: db.prepare(WRITE_SQL["rx.upsert"]),
 
   getBySession: db.prepare("SELECT * FROM rx WHERE sessionId = ?"),
 
   getBySessionAndEye: db.prepare("SELECT * FROM rx WHERE sessionId = ? AND eye = ?"),
+});
+
+/**
+ * Exam state queries (write-behind target for the in-memory state store)
+ */
+export const examStateQueries = instrumented("examState", {
+  upsert: db.prepare(WRITE_SQL["examState.upsert"]),
+
+  get: db.prepare("SELECT state FROM exam_state WHERE sessionId = ? AND eye = ? AND kind = ?"),
+});
+
+/**
+ * Trial queries
+ * Ranged aggregates filter on step codes and t; they read only
+ * idx_trials_analytics.
+ */
+export const trialQueries = instrumented("trials", {
+  create: db.prepare(WRITE_SQL["trials.create"]),
+
+  bySession: db.prepare("SELECT * FROM trials WHERE sessionId = ? ORDER BY t ASC, id ASC"),
+
+  // (stepA, stepB, fromMs, toMs)
+  hitRateBySize: db.prepare(`
+    SELECT sizeIndex, COUNT(*) AS trials, SUM(correct) AS correct, AVG(latencyMs) AS meanLatencyMs
+    FROM trials
+    WHERE step IN (?, ?) AND t >= ? AND t < ?
+    GROUP BY sizeIndex
+    ORDER BY sizeIndex
+  `),
+
+  // (bucketMs, bucketMs, stepA, stepB, stepC, stepD, fromMs, toMs)
+  // Listing every step keeps step as the leading range on idx_trials_analytics
+  latencyHistogram: db.prepare(`
+    SELECT step, (latencyMs / ?) * ? AS bucketMs, COUNT(*) AS trials
+    FROM trials
+    WHERE step IN (?, ?, ?, ?) AND t >= ? AND t < ? AND latencyMs IS NOT NULL
+    GROUP BY step, bucketMs
+    ORDER BY step, bucketMs
+  `),
+});
+
+/**
+ * Rollup reads (day range [from, to) as YYYY-MM-DD); O(days × buckets)
+ */
+export const rollupQueries = instrumented("rollups", {
+  totals: db.prepare(`
+    SELECT metric, bucket, SUM(count) AS count, SUM(sum) AS sum
+    FROM rollups
+    WHERE day >= ? AND day < ?
+    GROUP BY metric, bucket
+    HAVING SUM(count) != 0
+    ORDER BY metric, bucket
+  `),
+
+  sessionsByDay: db.prepare(`
+    SELECT day, metric, count
+    FROM rollups
+    WHERE day >= ? AND day < ? AND metric IN ('sessions_created', 'sessions_completed')
+    ORDER BY day
+  `),
+});
+
+/**
+ * Conversation registry queries (SQLite backend of conversationRegistry)
+ * Writes go through the writer thread and read their RETURNING rows from
+ * the commit; the TTL slides in the same statement that reads it, and
+ * expiry claims rows with DELETE ... RETURNING so only one process ends
+ * each conversation.
+ */
+export const conversationQueries = instrumented("conversations", {
+  upsert: db.prepare(WRITE_SQL["conversations.upsert"]),
+
+  touch: db.prepare(WRITE_SQL["conversations.touch"]),
+
+  delete: db.prepare(WRITE_SQL["conversations.delete"]),
+
+  active: db.prepare("SELECT key FROM conversations WHERE expiresAt > ? ORDER BY key"),
+
+  claimExpired: db.prepare(WRITE_SQL["conversations.claimExpired"]),
+});
+
+/**
+ * Main-thread statement for each writer statement
+ */
+const writeStatements: Record<WriteStatement, Database.Statement> = {
+  "sessions.create": sessionQueries.create,
+  "sessions.updateState": sessionQueries.updateState,
+  "events.create": eventQueries.create,
+  "trials.create": trialQueries.create,
+  "rx.upsert": rxQueries.upsert,
+  "examState.upsert": examStateQueries.upsert,
+  "conversations.upsert": conversationQueries.upsert,
+  "conversations.touch": conversationQueries.touch,
+  "conversations.delete": conversationQueries.delete,
+  "conversations.claimExpired": conversationQueries.claimExpired,
 };
 
+/**
+ * Run writer ops on the main connection in one transaction (writer off,
+ * or draining at exit)
+ */
+const runWritesTx = db.transaction((ops: WriteOp[]): WriteRows =>
+  ops.map(([statement, params]) => {
+    const prepared = writeStatements[statement];
+    if (prepared.reader) return prepared.all(...params);
+    prepared.run(...params);
+    return [];
+  })
+);
+
+export function runWritesSync(ops: WriteOp[]): WriteRows {
+  return timeSqlite("writes.sync", () => runWritesTx(ops));
+}
+
+/**
+ * Export queries (consumed with .iterate() on an export's own connection)
+ * Date ranges seek idx_sessions_created; each session's rows come from its
+ * own index, so any sort is bounded by one session's rows.
+ */
+function prepareExportQueries(reader: Database.Database) {
+  return {
+    rxBySession: reader.prepare("SELECT * FROM rx WHERE sessionId = ? ORDER BY eye"),
+
+    eventsBySession: reader.prepare(
+      "SELECT * FROM events WHERE sessionId = ? ORDER BY t ASC, id ASC"
+    ),
+
+    sessionsInRange: reader.prepare(`
+      SELECT * FROM sessions
+      WHERE createdAtMs >= ? AND createdAtMs < ?
+      ORDER BY createdAtMs, id
+    `),
+
+    rxInRange: reader.prepare(`
+      SELECT r.* FROM sessions s
+      JOIN rx r ON r.sessionId = s.id
+      WHERE s.createdAtMs >= ? AND s.createdAtMs < ?
+      ORDER BY s.createdAtMs, s.id, r.eye
+    `),
+
+    eventsInRange: reader.prepare(`
+      SELECT e.* FROM sessions s
+      JOIN events e ON e.sessionId = s.id
+      WHERE s.createdAtMs >= ? AND s.createdAtMs < ?
+      ORDER BY s.createdAtMs, s.id, e.t, e.id
+    `),
+
+    trialsInRange: reader.prepare(`
+      SELECT tr.* FROM sessions s
+      JOIN trials tr ON tr.sessionId = s.id
+      WHERE s.createdAtMs >= ? AND s.createdAtMs < ?
+      ORDER BY s.createdAtMs, s.id, tr.t, tr.id
+    `),
+  };
+}
+
+export type ExportQueries = ReturnType<typeof prepareExportQueries>;
+
+export interface ExportReader {
+  queries: ExportQueries;
+  close: () => void;
+}
+
+/**
+ * Dedicated read-only connection for one export stream
+ * An open iterator keeps its connection busy until it finishes, so exports
+ * can't share one: each gets its own, seeing a stable WAL snapshot without
+ * blocking writes, and closes it when the stream ends.
+ */
+export function openExportReader(): ExportReader {
+  const reader = new Database(DB_PATH, { readonly: true, fileMustExist: true });
+  return {
+    queries: prepareExportQueries(reader),
+    close: () => {
+      if (reader.open) reader.close();
+    },
+  };
+}
+
 /**
  * Helper to serialize params
  */
@@ -0,0 +1,208 @@
+/**
+ * SQLite writes off the event loop
+ *
+ * better-sqlite3 blocks the thread it runs on, so writes are handed to a
+ * worker_thread with its own connection (dbWriterWorker.ts), which commits
+ * them in timed group transactions. Reads stay on the main connection and
+ * see a write once it has committed (WAL).
+ *
+ *   enqueue()  fire-and-forget (telemetry events, exam state write-behind)
+ *   commit()   resolves once the ops are durable (sessions, Rx)
+ *   commitReturning()  commit(), resolving with each op's RETURNING rows
+ *                      (conversation registry)
+ *
+ * DB_WRITER=off runs every write synchronously on the main connection.
+ */
+
+import path from "path";
+import { Worker } from "worker_threads";
+import { DB_PATH, runWritesSync } from "./db";
+import { GaugeFamily, sqliteBusy, sqliteSeconds } from "./metrics";
+import { FromWriter, ToWriter, WriteOp, WriteRows, WriteUnit } from "./writeStatements";
+
+const ENABLED = process.env.DB_WRITER !== "off";
+
+interface Pending {
+  unit: WriteUnit;
+  resolve?: (rows: WriteRows) => void;
+  reject?: (error: Error) => void;
+}
+
+class DbWriter {
+  private worker: Worker | null = null;
+  private nextId = 1;
+  private outbox: WriteUnit[] = [];        // Not yet posted to the worker
+  private unacked = new Map<number, Pending>();
+  private postScheduled = false;
+  private closed = !ENABLED;
+  private closing: Promise<void> | null = null;
+
+  /**
+   * Queue a write; failures are logged, never thrown
+   */
+  enqueue(...ops: WriteOp[]): void {
+    this.submit(ops);
+  }
+
+  /**
+   * Queue ops as one atomic unit; resolves once they're committed
+   */
+  commit(...ops: WriteOp[]): Promise<void> {
+    return new Promise((resolve, reject) => this.submit(ops, () => resolve(), reject));
+  }
+
+  /**
+   * commit(), resolving with the RETURNING rows of each op
+   */
+  commitReturning(...ops: WriteOp[]): Promise<WriteRows> {
+    return new Promise((resolve, reject) => this.submit(ops, resolve, reject, true));
+  }
+
+  /**
+   * Units submitted but not yet committed
+   */
+  get depth(): number {
+    return this.unacked.size;
+  }
+
+  private submit(
+    ops: WriteOp[],
+    resolve?: (rows: WriteRows) => void,
+    reject?: (error: Error) => void,
+    returning = false
+  ) {
+    if (ops.length === 0) {
+      resolve?.([]);
+      return;
+    }
+
+    if (this.closed) {
+      try {
+        resolve?.(runWritesSync(ops));
+      } catch (error: any) {
+        this.fail(ops, error, reject);
+      }
+      return;
+    }
+
+    const unit: WriteUnit = { id: this.nextId++, ops, returning };
+    this.unacked.set(unit.id, { unit, resolve, reject });
+    this.outbox.push(unit);
+
+    // One postMessage per tick, however many writes the tick produced
+    if (!this.postScheduled) {
+      this.postScheduled = true;
+      setImmediate(() => this.post());
+    }
+  }
+
+  private post() {
+    this.postScheduled = false;
+    if (this.outbox.length === 0) return;
+    const units = this.outbox;
+    this.outbox = [];
+    this.send({ type: "units", units });
+  }
+
+  private send(message: ToWriter) {
+    this.ensureWorker().postMessage(message);
+  }
+
+  private ensureWorker(): Worker {
+    if (this.worker) return this.worker;
+
+    // Same extension as this file: .ts under tsx, .js when built
+    const file = path.join(__dirname, `dbWriterWorker${path.extname(__filename)}`);
+    // Inherit execArgv so the tsx loader is registered in the worker too
+    const worker = new Worker(file, { workerData: { dbPath: DB_PATH }, execArgv: process.execArgv });
+    worker.unref();
+    worker.on("message", (message: FromWriter) => this.onMessage(message));
+    worker.on("error", (error) => console.error("❌ DB writer thread error:", error));
+    worker.on("exit", (code) => {
+      if (this.worker !== worker) return;
+      this.worker = null;
+      if (!this.closing) {
+        console.error(`❌ DB writer thread exited (${code}); replaying ${this.unacked.size} writes on the main thread`);
+        this.drainSync();
+      }
+    });
+
+    this.worker = worker;
+    console.log("🧵 DB writer thread started");
+    return worker;
+  }
+
+  private onMessage(message: FromWriter) {
+    if (message.type === "committed") {
+      sqliteSeconds.observe({ statement: "writer.groupCommit" }, message.ms / 1000);
+      for (const id of message.ids) {
+        const pending = this.unacked.get(id);
+        this.unacked.delete(id);
+        pending?.resolve?.(message.rows[id] ?? []);
+      }
+    } else if (message.type === "failed") {
+      if (message.code === "SQLITE_BUSY") sqliteBusy.inc({ statement: "writer" });
+      const pending = this.unacked.get(message.id);
+      this.unacked.delete(message.id);
+      if (pending) this.fail(pending.unit.ops, Object.assign(new Error(message.error), { code: message.code }), pending.reject);
+    }
+  }
+
+  private fail(ops: WriteOp[], error: Error, reject?: (error: Error) => void) {
+    if (reject) {
+      reject(error);
+    } else {
+      console.error(`❌ Dropped write (${ops.map(([statement]) => statement).join(", ")}):`, error.message);
+    }
+  }
+
+  /**
+   * Commit everything not yet acknowledged on the main connection
+   * A unit the worker committed whose ack is still in flight runs twice;
+   * upserts absorb that, an event row can be duplicated.
+   */
+  drainSync() {
+    this.outbox = [];
+    const pending = Array.from(this.unacked.values());
+    this.unacked.clear();
+    for (const { unit, resolve, reject } of pending) {
+      try {
+        resolve?.(runWritesSync(unit.ops));
+      } catch (error: any) {
+        this.fail(unit.ops, error, reject);
+      }
+    }
+  }
+
+  /**
+   * Commit queued writes and stop the worker; later writes run synchronously
+   */
+  close(): Promise<void> {
+    if (this.closing) return this.closing;
+    this.closing = new Promise<void>((resolve) => {
+      if (!this.worker && this.unacked.size === 0) {
+        this.closed = true;
+        return resolve();
+      }
+      this.post();
+      const worker = this.ensureWorker();
+      worker.on("message", (message: FromWriter) => {
+        if (message.type !== "closed") return;
+        this.closed = true;
+        this.worker = null;
+        worker.terminate().finally(() => resolve());
+      });
+      this.send({ type: "close" });
+    });
+    return this.closing;
+  }
+}
+
+export const dbWriter = new DbWriter();
+
+new GaugeFamily("optix_db_writer_queue_depth", "Write units submitted to the writer thread but not yet committed", () => [
+  { labels: {}, value: dbWriter.depth },
+]);
+
+// Last resort (process.exit without close()): nothing queued is lost
+process.on("exit", () => dbWriter.drainSync());
@@ -0,0 +1,93 @@
+/**
+ * SQLite writer thread (see dbWriter.ts)
+ *
+ * Owns its own connection. Units queue up and are committed together once
+ * GROUP_COMMIT_MS has passed since the first one arrived (or MAX_GROUP units
+ * are waiting), so a burst of writes costs one WAL commit instead of one
+ * per statement. If a group fails, its units are retried one by one so a
+ * single bad unit doesn't take the rest down with it.
+ */
+
+import Database from "better-sqlite3";
+import { parentPort, workerData } from "worker_threads";
+import { FromWriter, ToWriter, WRITE_SQL, WriteRows, WriteStatement, WriteUnit } from "./writeStatements";
+
+const GROUP_COMMIT_MS = Number(process.env.DB_WRITER_GROUP_MS) || 5;
+const MAX_GROUP = Number(process.env.DB_WRITER_MAX_GROUP) || 1000;
+
+const db = new Database(workerData.dbPath as string);
+db.pragma("journal_mode = WAL");
+db.pragma("busy_timeout = 5000");
+
+const statements = Object.fromEntries(
+  Object.entries(WRITE_SQL).map(([name, sql]) => [name, db.prepare(sql)])
+) as Record<WriteStatement, Database.Statement>;
+
+const commitGroup = db.transaction((units: WriteUnit[]) => {
+  const rows: Record<number, WriteRows> = {};
+  for (const unit of units) {
+    if (!unit.returning) {
+      for (const [statement, params] of unit.ops) {
+        statements[statement].run(...params);
+      }
+      continue;
+    }
+    rows[unit.id] = unit.ops.map(([statement, params]) => {
+      const prepared = statements[statement];
+      if (prepared.reader) return prepared.all(...params);
+      prepared.run(...params);
+      return [];
+    });
+  }
+  return rows;
+});
+
+let queue: WriteUnit[] = [];
+let timer: NodeJS.Timeout | null = null;
+
+function post(message: FromWriter) {
+  parentPort!.postMessage(message);
+}
+
+function commit() {
+  if (timer) {
+    clearTimeout(timer);
+    timer = null;
+  }
+
+  while (queue.length > 0) {
+    const group = queue.splice(0, MAX_GROUP);
+    const start = performance.now();
+    try {
+      const rows = commitGroup(group);
+      post({ type: "committed", ids: group.map((unit) => unit.id), ms: performance.now() - start, size: group.length, rows });
+    } catch {
+      // Isolate the failing unit(s)
+      for (const unit of group) {
+        const unitStart = performance.now();
+        try {
+          const rows = commitGroup([unit]);
+          post({ type: "committed", ids: [unit.id], ms: performance.now() - unitStart, size: 1, rows });
+        } catch (error: any) {
+          post({ type: "failed", id: unit.id, error: error?.message ?? String(error), code: error?.code });
+        }
+      }
+    }
+  }
+}
+
+parentPort!.on("message", (message: ToWriter) => {
+  if (message.type === "close") {
+    commit();
+    db.close();
+    post({ type: "closed" });
+    return;
+  }
+
+  for (const unit of message.units) queue.push(unit);
+  if (queue.length >= MAX_GROUP) {
+    commit();
+  } else if (!timer) {
+    timer = setTimeout(commit, GROUP_COMMIT_MS);
+  }
+});
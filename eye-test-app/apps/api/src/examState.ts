@@ -0,0 +1,132 @@
+/**
+ * Server-held exam state store
+ *
+ * Staircase and JCC state is kept per session/eye so clients only send the
+ * trial outcome. Updates land in memory and are handed to the writer thread
+ * as one unit on a short timer (write-behind); a cache miss rehydrates
+ * from SQLite.
+ */
+
+import { examStateQueries } from "./db";
+import { dbWriter } from "./dbWriter";
+import { WriteOp } from "./writeStatements";
+
+export type ExamKind = "staircase" | "jcc";
+
+interface Entry {
+  state: any;
+  touchedAt: number;
+}
+
+const FLUSH_INTERVAL_MS = Number(process.env.EXAM_STATE_FLUSH_MS) || 250;
+const IDLE_EVICT_MS = 30 * 60 * 1000;
+
+// Engine states may hold typed arrays (QUEST+ posterior); JSON needs a tag
+function replacer(_key: string, value: unknown) {
+  return value instanceof Float64Array ? { $f64: Array.from(value) } : value;
+}
+
+function reviver(_key: string, value: any) {
+  return value && Array.isArray(value.$f64) ? Float64Array.from(value.$f64) : value;
+}
+
+function keyOf(kind: ExamKind, sessionId: string, eye: string): string {
+  return `${kind}:${sessionId}-${eye}`;
+}
+
+class ExamStateStore {
+  private entries = new Map<string, Entry>();
+  private dirty = new Map<string, { kind: ExamKind; sessionId: string; eye: string }>();
+  private timer: NodeJS.Timeout | null = null;
+
+  /**
+   * Get state for a session/eye, rehydrating from SQLite on a miss
+   */
+  get<S>(kind: ExamKind, sessionId: string, eye: string): S | null {
+    const key = keyOf(kind, sessionId, eye);
+    const entry = this.entries.get(key);
+    if (entry) {
+      entry.touchedAt = Date.now();
+      return entry.state as S;
+    }
+
+    const row = examStateQueries.get.get(sessionId, eye, kind) as { state: string } | undefined;
+    if (!row) return null;
+
+    try {
+      const state = JSON.parse(row.state, reviver);
+      this.entries.set(key, { state, touchedAt: Date.now() });
+      return state as S;
+    } catch {
+      return null;
+    }
+  }
+
+  /**
+   * Replace state for a session/eye and schedule a write-behind flush
+   */
+  set<S>(kind: ExamKind, sessionId: string, eye: string, state: S): void {
+    const key = keyOf(kind, sessionId, eye);
+    this.entries.set(key, { state, touchedAt: Date.now() });
+    this.dirty.set(key, { kind, sessionId, eye });
+    this.scheduleFlush();
+  }
+
+  /**
+   * Queue all dirty states as a single atomic write (fire-and-forget)
+   */
+  flush(): void {
+    if (this.timer) {
+      clearTimeout(this.timer);
+      this.timer = null;
+    }
+    if (this.dirty.size === 0) return;
+
+    const rows = Array.from(this.dirty, ([key, ref]) => ({
+      ...ref,
+      state: this.entries.get(key)?.state,
+    })).filter((row) => row.state !== undefined);
+    this.dirty.clear();
+
+    const now = Date.now();
+    try {
+      dbWriter.enqueue(
+        ...rows.map((row): WriteOp => [
+          "examState.upsert",
+          [row.sessionId, row.eye, row.kind, JSON.stringify(row.state, replacer), now],
+        ])
+      );
+    } catch (error) {
+      console.error("❌ Failed to flush exam state:", error);
+    }
+
+    this.evictIdle();
+  }
+
+  private scheduleFlush() {
+    if (this.timer) return;
+    this.timer = setTimeout(() => this.flush(), FLUSH_INTERVAL_MS);
+    this.timer.unref();
+  }
+
+  /**
+   * Drop clean entries nobody has touched recently; SQLite still has them
+   */
+  private evictIdle() {
+    const cutoff = Date.now() - IDLE_EVICT_MS;
+    for (const [key, entry] of this.entries) {
+      if (entry.touchedAt < cutoff && !this.dirty.has(key)) {
+        this.entries.delete(key);
+      }
+    }
+  }
+}
+
+export const examState = new ExamStateStore();
+
+// Final flush, then commit it on the main connection (the writer thread
+// can't run once the process is exiting)
+process.on("exit", () => {
+  examState.flush();
+  dbWriter.drainSync();
+});
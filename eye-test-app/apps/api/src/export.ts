@@ -0,0 +1,106 @@
+/**
+ * Streaming CSV / NDJSON export
+ *
+ * Rows are pulled lazily from better-sqlite3 iterators through Readable.from,
+ * so the HTTP socket's backpressure paces the query and memory stays flat
+ * regardless of export size. Optional gzip sits in the same pipeline.
+ * Each export iterates on its own read-only connection, closed when the
+ * stream finishes, fails or the client goes away.
+ */
+
+import { Request, Response } from "express";
+import { Readable, pipeline } from "stream";
+import zlib from "zlib";
+import { ExportQueries, openExportReader } from "./db";
+
+export type ExportFormat = "csv" | "ndjson";
+
+/**
+ * One table in an export: CSV header labels keyed by column name
+ */
+export interface ExportTable {
+  name: string;
+  columns: Array<[key: string, label: string]>;
+  rows: (queries: ExportQueries) => Iterable<unknown>;
+}
+
+/**
+ * Read ?format= (csv by default)
+ */
+export function parseFormat(format: unknown): ExportFormat | null {
+  if (format === undefined || format === "csv") return "csv";
+  if (format === "ndjson") return "ndjson";
+  return null;
+}
+
+function csvField(value: unknown): string {
+  if (value === null || value === undefined) return "";
+  const text = String(value);
+  return /[",\r\n]/.test(text) ? `"${text.replace(/"/g, '""')}"` : text;
+}
+
+/**
+ * CSV holds a single table; NDJSON interleaves tables tagged with `type`
+ */
+function* exportLines(tables: ExportTable[], format: ExportFormat, queries: ExportQueries): Generator<string> {
+  if (format === "csv") {
+    const [table] = tables;
+    yield table.columns.map(([, label]) => csvField(label)).join(",") + "\n";
+    for (const row of table.rows(queries) as Iterable<Record<string, unknown>>) {
+      yield table.columns.map(([key]) => csvField(row[key])).join(",") + "\n";
+    }
+    return;
+  }
+
+  for (const table of tables) {
+    for (const row of table.rows(queries) as Iterable<Record<string, unknown>>) {
+      yield JSON.stringify({ type: table.name, ...row }) + "\n";
+    }
+  }
+}
+
+function wantsGzip(req: Request): boolean {
+  if (req.query.gzip !== undefined) return req.query.gzip !== "0" && req.query.gzip !== "false";
+  return /\bgzip\b/.test(String(req.headers["accept-encoding"] || ""));
+}
+
+/**
+ * Stream tables to the response as a file download
+ */
+export function streamExport(
+  req: Request,
+  res: Response,
+  filename: string,
+  tables: ExportTable[],
+  format: ExportFormat
+): void {
+  const gzip = wantsGzip(req);
+  const extension = format === "csv" ? "csv" : "ndjson";
+
+  res.set({
+    "Content-Type": format === "csv" ? "text/csv; charset=utf-8" : "application/x-ndjson",
+    "Content-Disposition": `attachment; filename="${filename}.${extension}"`,
+    "Cache-Control": "no-store",
+  });
+  if (gzip) {
+    res.set("Content-Encoding", "gzip");
+    res.vary("Accept-Encoding");
+  }
+
+  // Readable.from pulls the next line only when the consumer wants more
+  const reader = openExportReader();
+  const source = Readable.from(exportLines(tables, format, reader.queries), { objectMode: false });
+  const onDone = (error: NodeJS.ErrnoException | null) => {
+    // pipeline has destroyed the source by now, which ends its iterator
+    reader.close();
+    if (error && error.code !== "ERR_STREAM_PREMATURE_CLOSE") {
+      console.error("❌ Export stream failed:", error);
+    }
+  };
+
+  if (gzip) {
+    pipeline(source, zlib.createGzip(), res, onDone);
+  } else {
+    pipeline(source, res, onDone);
+  }
+}
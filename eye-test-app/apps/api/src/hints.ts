@@ -0,0 +1,91 @@
+/**
+ * Async Grok hint pipeline
+ *
+ * Hints are computed off the request path: a trial kicks off a Grok call with
+ * a hard deadline, and the result (or grokFallback when the deadline passes)
+ * is delivered on the next trial's response and pushed over SSE. One call
+ * runs per session/eye/stage; trials arriving meanwhile collapse into a
+ * single follow-up for the newest one, so fast responders still get hints.
+ */
+
+import { grokHintWithSource, grokFallback, GrokHint, GrokHintResult, LiveSignals } from "@OptiX/agent";
+import { SseHub } from "./sse";
+import { timeStage } from "./metrics";
+
+const HINT_DEADLINE_MS = Number(process.env.GROK_HINT_DEADLINE_MS) || 800;
+const MAX_RETAINED_HINTS = 10000;
+
+export interface HintEnvelope {
+  eye: string;
+  stage: LiveSignals["stage"];
+  trial: number;          // Trial count the hint was computed for
+  source: GrokHintResult["source"];
+  hint: GrokHint;
+}
+
+interface HintRequest {
+  sessionId: string;
+  eye: string;
+  signals: LiveSignals;
+}
+
+class HintPipeline {
+  readonly hub = new SseHub();
+  private latest = new Map<string, HintEnvelope>();
+  private inflight = new Set<string>();
+  private pending = new Map<string, HintRequest>();
+
+  /**
+   * Start computing a hint in the background; never throws, never blocks
+   */
+  request(sessionId: string, eye: string, signals: LiveSignals): void {
+    const key = `${signals.stage}:${sessionId}-${eye}`;
+
+    if (this.inflight.has(key)) {
+      // Only the newest waiting trial is worth a call once this one lands
+      this.pending.set(key, { sessionId, eye, signals });
+      return;
+    }
+    this.run(key, { sessionId, eye, signals });
+  }
+
+  private run(key: string, { sessionId, eye, signals }: HintRequest): void {
+    this.inflight.add(key);
+    const controller = new AbortController();
+    const timer = setTimeout(() => controller.abort(), HINT_DEADLINE_MS);
+
+    // An abort on the deadline surfaces as a fallback result from grokHintWithSource
+    timeStage("grokHint", () => grokHintWithSource(signals, { signal: controller.signal }))
+      .catch((): GrokHintResult => ({ hint: grokFallback(signals), source: "fallback" }))
+      .then(({ hint, source }) => {
+        clearTimeout(timer);
+        this.deliver(key, sessionId, { eye, stage: signals.stage, trial: signals.trialCount, source, hint });
+
+        this.inflight.delete(key);
+        const next = this.pending.get(key);
+        if (next) {
+          this.pending.delete(key);
+          this.run(key, next);
+        }
+      });
+  }
+
+  private deliver(key: string, sessionId: string, envelope: HintEnvelope): void {
+    this.latest.delete(key);
+    this.latest.set(key, envelope);
+    if (this.latest.size > MAX_RETAINED_HINTS) {
+      // Map iterates in insertion order, so the first key is the stalest
+      this.latest.delete(this.latest.keys().next().value!);
+    }
+    this.hub.publish(sessionId, "hint", envelope);
+  }
+
+  /**
+   * Most recent completed hint for a session/eye/stage, if any
+   */
+  latestFor(sessionId: string, eye: string, stage: LiveSignals["stage"]): HintEnvelope | null {
+    return this.latest.get(`${stage}:${sessionId}-${eye}`) ?? null;
+  }
+}
+
+export const hints = new HintPipeline();
@@ -35,6 +35,12 @@ if (!envLoaded) {
 // NOW import everything else AFTER env vars are loaded
 import express from "express";
 import cors from "cors";
+import { warmTtsCache, EXAM_PROMPTS, EXAM_VOICE_ID } from "@OptiX/voice";
+import { setPackageLogger, upstreamStats } from "@OptiX/upstream";
+import { GaugeFamily, httpSeconds, metricsSummary, renderMetrics } from "./metrics";
+import { logger } from "./logger";
+import { dbWriter } from "./dbWriter";
+import { examState } from "./examState";
 
 // Import routes (db will auto-initialize when imported)
 import sessionRouter from "./routes/session";
@@ -46,6 +52,11 @@ import staircaseRouter from "./routes/staircase";
 import jccRouter from "./routes/jcc";
 import summaryRouter from "./routes/summary";
 import elevenlabsRouter from "./routes/elevenlabs";
+import hintsRouter from "./routes/hints";
+import trialsRouter from "./routes/trials";
+
+// Package logging (hints, TTS, upstream breakers) goes through the same buffered logger
+setPackageLogger(logger);
 
 const app = express();
 const PORT = process.env.PORT || 8787;
@@ -56,9 +67,16 @@ app.use(cors({ origin: FRONTEND_ORIGIN }));
 app.use(express.json({ limit: "10mb" }));
 app.use(express.urlencoded({ extended: true, limit: "10mb" }));
 
-// Request logging
+// Request timing (every request) and logging (sampled, off the event loop)
 app.use((req, res, next) => {
-  console.log(`📥 ${req.method} ${req.path}`);
+  const start = performance.now();
+  res.once("finish", () => {
+    const ms = performance.now() - start;
+    // Route pattern, not the raw path, so ids don't explode the label set
+    const route = req.route ? `${req.baseUrl}${req.route.path}` : "unmatched";
+    httpSeconds.observe({ method: req.method, route, status: String(res.statusCode) }, ms / 1000);
+    logger.sampled("info", `📥 ${req.method} ${req.path} ${res.statusCode} ${ms.toFixed(1)}ms`);
+  });
   next();
 });
 
@@ -67,6 +85,25 @@ app.get("/health", (req, res) => {
   res.json({ status: "ok", timestamp: new Date().toISOString() });
 });
 
+// Upstream pool state, read at scrape time
+new GaugeFamily("optix_upstream_queued_requests", "Requests waiting for an upstream concurrency slot", () =>
+  Object.entries(upstreamStats()).map(([host, stats]) => ({ labels: { host }, value: stats.queued }))
+);
+new GaugeFamily("optix_upstream_circuit_open", "1 while the upstream circuit breaker is open", () =>
+  Object.entries(upstreamStats()).map(([host, stats]) => ({ labels: { host }, value: stats.circuit === "open" ? 1 : 0 }))
+);
+
+// Prometheus scrape endpoint
+app.get("/metrics", (req, res) => {
+  res.set("Content-Type", "text/plain; version=0.0.4");
+  res.send(renderMetrics());
+});
+
+// Per-stage p50/p99 for humans
+app.get("/metrics/summary", (req, res) => {
+  res.json(metricsSummary());
+});
+
 // API routes
 app.use("/api/session", sessionRouter);
 app.use("/api/event", eventRouter);
@@ -77,6 +114,21 @@ app.use("/api/staircase", staircaseRouter);
 app.use("/api/jcc", jccRouter);
 app.use("/api/summary", summaryRouter);
 app.use("/api/elevenlabs", elevenlabsRouter);
+app.use("/api/hints", hintsRouter);
+app.use("/api/trials", trialsRouter);
+
+// Production launch (Electron kiosk): serve the prebuilt web bundle from the
+// API's own origin so no Vite dev server is needed
+const WEB_DIST_DIR = process.env.WEB_DIST_DIR;
+if (WEB_DIST_DIR) {
+  // Hashed asset names, safe to cache forever
+  app.use("/assets", express.static(path.join(WEB_DIST_DIR, "assets"), { immutable: true, maxAge: "1y" }));
+  app.use(express.static(WEB_DIST_DIR));
+  // Client-side routes fall back to the SPA shell
+  app.get(/^\/(?!api\/).*/, (req, res) => {
+    res.sendFile(path.join(WEB_DIST_DIR, "index.html"));
+  });
+}
 
 // 404 handler
 app.use((req, res) => {
@@ -98,8 +150,29 @@ app.listen(PORT, () => {
   console.log(`   - ElevenLabs TTS: ${process.env.ELEVENLABS_API_KEY ? "✅ Configured" : "⚠️  Not configured"}`);
   console.log(`   - Gemini STT/NLU: ${process.env.GEMINI_API_KEY ? "✅ Configured" : "⚠️  Not configured"}`);
   console.log(`   - xAI Grok: ${process.env.XAI_GROK_API_KEY ? "✅ Configured" : "⚠️  Not configured"}`);
-  console.log("\n✨ All systems ready! Open http://localhost:5173 to start testing\n");
+  console.log(`\n✨ All systems ready! Open ${WEB_DIST_DIR ? `http://localhost:${PORT}` : "http://localhost:5173"} to start testing\n`);
+
+  // Readiness for a forking parent (Electron) instead of port polling
+  process.send?.({ type: "ready", port: Number(PORT) });
+
+  // Pre-render fixed exam prompts in the background, in the voice the exam uses
+  const warmVoices = (process.env.TTS_WARMUP_VOICE_IDS || "").split(",").filter(Boolean);
+  warmTtsCache(EXAM_PROMPTS, warmVoices.length > 0 ? warmVoices : [EXAM_VOICE_ID])
+    .then((stats) => console.log("🔥 TTS cache warm-up:", stats))
+    .catch((error) => console.error("TTS cache warm-up failed:", error));
 });
 
+// Exit cleanly on signals: flush write-behind state and let the writer
+// thread commit everything queued before exiting
+for (const signal of ["SIGINT", "SIGTERM"] as const) {
+  process.once(signal, () => {
+    examState.flush();
+    dbWriter
+      .close()
+      .catch((error) => console.error("❌ DB writer shutdown failed:", error))
+      .finally(() => process.exit(0));
+  });
+}
+
 export default app;
 
@@ -0,0 +1,130 @@
+/**
+ * Leveled, buffered logger for the request path
+ *
+ * console.log writes to stdout synchronously (files, TTYs and, on Linux,
+ * pipes), so every request line stalled the event loop. Lines are queued
+ * and written in batches with fs.write on the libuv thread pool instead;
+ * high-volume lines can be sampled. Structured fields may be passed as a
+ * thunk so nothing is serialized for lines below LOG_LEVEL.
+ */
+
+import fs from "fs";
+
+export type LogLevel = "debug" | "info" | "warn" | "error";
+
+type Fields = Record<string, unknown> | (() => Record<string, unknown>);
+
+const LEVELS: Record<LogLevel, number> = { debug: 10, info: 20, warn: 30, error: 40 };
+
+const MIN_LEVEL = LEVELS[(process.env.LOG_LEVEL as LogLevel) || "info"] ?? LEVELS.info;
+const SAMPLE_RATE = Math.min(1, Math.max(0, Number(process.env.LOG_SAMPLE_RATE ?? 0.1)));
+const MAX_QUEUED_LINES = 10000;
+
+function serializeError(error: Error) {
+  return { name: error.name, message: error.message, stack: error.stack };
+}
+
+function fieldsToString(fields?: Fields): string {
+  if (!fields) return "";
+  const value = typeof fields === "function" ? fields() : fields;
+  try {
+    return " " + JSON.stringify(value, (_key, v) => (v instanceof Error ? serializeError(v) : v));
+  } catch {
+    return " [unserializable fields]";
+  }
+}
+
+class Logger {
+  private queue: string[] = [];
+  private writing = false;
+  private dropped = 0;
+
+  enabled(level: LogLevel): boolean {
+    return LEVELS[level] >= MIN_LEVEL;
+  }
+
+  debug(message: string, fields?: Fields) {
+    this.log("debug", message, fields);
+  }
+
+  info(message: string, fields?: Fields) {
+    this.log("info", message, fields);
+  }
+
+  warn(message: string, fields?: Fields) {
+    this.log("warn", message, fields);
+  }
+
+  error(message: string, fields?: Fields) {
+    this.log("error", message, fields);
+  }
+
+  /**
+   * Log only a LOG_SAMPLE_RATE fraction of calls (per-request lines)
+   */
+  sampled(level: LogLevel, message: string, fields?: Fields) {
+    if (Math.random() < SAMPLE_RATE) this.log(level, message, fields);
+  }
+
+  log(level: LogLevel, message: string, fields?: Fields) {
+    if (!this.enabled(level)) return;
+
+    if (this.queue.length >= MAX_QUEUED_LINES) {
+      // stdout can't keep up; shed lines rather than grow without bound
+      this.dropped++;
+      return;
+    }
+
+    const line = `${new Date().toISOString()} ${level.toUpperCase().padEnd(5)} ${message}${fieldsToString(fields)}\n`;
+    this.queue.push(line);
+    if (!this.writing) {
+      this.writing = true;
+      setImmediate(() => this.drain());
+    }
+  }
+
+  /**
+   * Write everything queued synchronously (process exit)
+   */
+  flushSync() {
+    const chunk = this.takeChunk();
+    if (chunk) fs.writeSync(process.stdout.fd, chunk);
+  }
+
+  private takeChunk(): string {
+    if (this.dropped > 0) {
+      this.queue.push(`${new Date().toISOString()} WARN  ⚠️ Logger dropped ${this.dropped} lines\n`);
+      this.dropped = 0;
+    }
+    const chunk = this.queue.join("");
+    this.queue = [];
+    return chunk;
+  }
+
+  private drain(pending?: Buffer) {
+    const buffer = pending ?? Buffer.from(this.takeChunk());
+    if (buffer.length === 0) {
+      this.writing = false;
+      return;
+    }
+    // One write in flight at a time keeps lines in order
+    fs.write(process.stdout.fd, buffer, 0, buffer.length, null, (error, written) => {
+      if (error) {
+        if ((error as NodeJS.ErrnoException).code === "EAGAIN") {
+          // Non-blocking pipe is full; retry shortly
+          setTimeout(() => this.drain(buffer), 10);
+          return;
+        }
+        // stdout is gone (EPIPE); nothing left to write to
+        this.queue = [];
+        this.writing = false;
+        return;
+      }
+      this.drain(written < buffer.length ? buffer.subarray(written) : undefined);
+    });
+  }
+}
+
+export const logger = new Logger();
+
+process.once("exit", () => logger.flushSync());
@@ -0,0 +1,276 @@
+/**
+ * In-process latency metrics for the exam hot path
+ *
+ * Fixed log-linear histogram buckets (HDR-style: constant relative error)
+ * make an observation one binary search plus an increment, with no
+ * allocation. Exposed in Prometheus text format at /metrics and as
+ * p50/p99 per series at /metrics/summary.
+ */
+
+import { monitorEventLoopDelay } from "perf_hooks";
+
+type Labels = Record<string, string>;
+
+// 1-1.5-2-3-5-7 per decade, 10µs .. 100s (~±25% worst-case quantile error)
+const BUCKETS: number[] = (() => {
+  const buckets: number[] = [];
+  for (let exponent = -5; exponent <= 1; exponent++) {
+    for (const mantissa of [1, 1.5, 2, 3, 5, 7]) {
+      buckets.push(Number((mantissa * 10 ** exponent).toPrecision(2)));
+    }
+  }
+  buckets.push(100);
+  return buckets;
+})();
+
+function labelKey(labelNames: readonly string[], labels: Labels): string {
+  return labelNames.map((name) => labels[name] ?? "").join("\u0000");
+}
+
+function formatLabels(labels: Labels, extra?: Labels): string {
+  const pairs = Object.entries({ ...labels, ...extra }).map(
+    ([name, value]) => `${name}="${String(value).replace(/\\/g, "\\\\").replace(/"/g, '\\"').replace(/\n/g, "\\n")}"`
+  );
+  return pairs.length > 0 ? `{${pairs.join(",")}}` : "";
+}
+
+class Histogram {
+  readonly counts = new Uint32Array(BUCKETS.length + 1); // Last slot is +Inf
+  sum = 0;
+  count = 0;
+
+  constructor(readonly labels: Labels) {}
+
+  observe(seconds: number) {
+    let lo = 0;
+    let hi = BUCKETS.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >> 1;
+      if (BUCKETS[mid] < seconds) lo = mid + 1;
+      else hi = mid;
+    }
+    this.counts[lo]++;
+    this.sum += seconds;
+    this.count++;
+  }
+
+  /**
+   * Quantile estimate, interpolated linearly inside the containing bucket
+   */
+  quantile(q: number): number {
+    if (this.count === 0) return 0;
+    const rank = q * this.count;
+    let seen = 0;
+    for (let i = 0; i < this.counts.length; i++) {
+      if (seen + this.counts[i] >= rank) {
+        const lower = i === 0 ? 0 : BUCKETS[i - 1];
+        const upper = i < BUCKETS.length ? BUCKETS[i] : lower;
+        return lower + (upper - lower) * ((rank - seen) / this.counts[i]);
+      }
+      seen += this.counts[i];
+    }
+    return BUCKETS[BUCKETS.length - 1];
+  }
+}
+
+export class HistogramFamily {
+  private series = new Map<string, Histogram>();
+
+  constructor(readonly name: string, readonly help: string, readonly labelNames: readonly string[]) {
+    registry.push(this);
+  }
+
+  observe(labels: Labels, seconds: number) {
+    const key = labelKey(this.labelNames, labels);
+    let histogram = this.series.get(key);
+    if (!histogram) {
+      histogram = new Histogram(labels);
+      this.series.set(key, histogram);
+    }
+    histogram.observe(seconds);
+  }
+
+  render(): string {
+    const lines = [`# HELP ${this.name} ${this.help}`, `# TYPE ${this.name} histogram`];
+    for (const histogram of this.series.values()) {
+      let cumulative = 0;
+      for (let i = 0; i < BUCKETS.length; i++) {
+        cumulative += histogram.counts[i];
+        lines.push(`${this.name}_bucket${formatLabels(histogram.labels, { le: String(BUCKETS[i]) })} ${cumulative}`);
+      }
+      lines.push(`${this.name}_bucket${formatLabels(histogram.labels, { le: "+Inf" })} ${histogram.count}`);
+      lines.push(`${this.name}_sum${formatLabels(histogram.labels)} ${histogram.sum}`);
+      lines.push(`${this.name}_count${formatLabels(histogram.labels)} ${histogram.count}`);
+    }
+    return lines.join("\n");
+  }
+
+  summary() {
+    return Array.from(this.series.values(), (histogram) => ({
+      ...histogram.labels,
+      count: histogram.count,
+      p50Ms: round(histogram.quantile(0.5) * 1000),
+      p99Ms: round(histogram.quantile(0.99) * 1000),
+      meanMs: round((histogram.sum / histogram.count) * 1000),
+    }));
+  }
+}
+
+export class CounterFamily {
+  private series = new Map<string, { labels: Labels; value: number }>();
+
+  constructor(readonly name: string, readonly help: string, readonly labelNames: readonly string[]) {
+    registry.push(this);
+  }
+
+  inc(labels: Labels, by = 1) {
+    const key = labelKey(this.labelNames, labels);
+    const counter = this.series.get(key);
+    if (counter) counter.value += by;
+    else this.series.set(key, { labels, value: by });
+  }
+
+  render(): string {
+    const lines = [`# HELP ${this.name} ${this.help}`, `# TYPE ${this.name} counter`];
+    for (const { labels, value } of this.series.values()) {
+      lines.push(`${this.name}${formatLabels(labels)} ${value}`);
+    }
+    return lines.join("\n");
+  }
+}
+
+/**
+ * Gauges read at scrape time (queue depths, breaker state)
+ */
+export class GaugeFamily {
+  constructor(
+    readonly name: string,
+    readonly help: string,
+    private readonly collect: () => Array<{ labels: Labels; value: number }>
+  ) {
+    registry.push(this);
+  }
+
+  render(): string {
+    const lines = [`# HELP ${this.name} ${this.help}`, `# TYPE ${this.name} gauge`];
+    for (const { labels, value } of this.collect()) {
+      lines.push(`${this.name}${formatLabels(labels)} ${value}`);
+    }
+    return lines.join("\n");
+  }
+}
+
+const registry: Array<{ render(): string }> = [];
+
+function round(value: number): number {
+  return Math.round(value * 1000) / 1000;
+}
+
+/**
+ * Metric definitions
+ */
+export const stageSeconds = new HistogramFamily(
+  "optix_stage_duration_seconds",
+  "Duration of exam pipeline stages (threshold/JCC updates, Grok, TTS, STT)",
+  ["stage", "outcome"]
+);
+
+export const httpSeconds = new HistogramFamily(
+  "optix_http_request_duration_seconds",
+  "HTTP request duration by route",
+  ["method", "route", "status"]
+);
+
+export const sqliteSeconds = new HistogramFamily(
+  "optix_sqlite_statement_duration_seconds",
+  "SQLite statement and transaction duration",
+  ["statement"]
+);
+
+export const sqliteBusy = new CounterFamily(
+  "optix_sqlite_busy_total",
+  "SQLite statements that failed with SQLITE_BUSY",
+  ["statement"]
+);
+
+// Event-loop delay since the previous scrape (what synchronous work costs everyone)
+const loopDelay = monitorEventLoopDelay({ resolution: 10 });
+loopDelay.enable();
+
+new GaugeFamily("optix_event_loop_delay_seconds", "Event-loop delay since the last scrape", () => {
+  const values = [
+    { labels: { quantile: "0.5" }, value: loopDelay.percentile(50) / 1e9 },
+    { labels: { quantile: "0.99" }, value: loopDelay.percentile(99) / 1e9 },
+    { labels: { quantile: "1" }, value: loopDelay.max / 1e9 },
+  ];
+  loopDelay.reset();
+  return values;
+});
+
+/**
+ * Time a stage; promise results are timed until they settle
+ * `outcome` maps a result to a label (defaults to "ok"; throws are "error").
+ */
+export function timeStage<T>(stage: string, fn: () => T, outcome?: (result: Awaited<T>) => string): T {
+  const start = performance.now();
+  const done = (label: string) => stageSeconds.observe({ stage, outcome: label }, (performance.now() - start) / 1000);
+
+  let result: T;
+  try {
+    result = fn();
+  } catch (error) {
+    done("error");
+    throw error;
+  }
+
+  if (result instanceof Promise) {
+    return result.then(
+      (value) => {
+        done(outcome ? outcome(value) : "ok");
+        return value;
+      },
+      (error) => {
+        done("error");
+        throw error;
+      }
+    ) as T;
+  }
+
+  done(outcome ? outcome(result as Awaited<T>) : "ok");
+  return result;
+}
+
+/**
+ * Time a synchronous SQLite call and count SQLITE_BUSY failures
+ */
+export function timeSqlite<T>(statement: string, fn: () => T): T {
+  const start = performance.now();
+  try {
+    return fn();
+  } catch (error: any) {
+    if (error?.code === "SQLITE_BUSY" || error?.code === "SQLITE_BUSY_SNAPSHOT") {
+      sqliteBusy.inc({ statement });
+    }
+    throw error;
+  } finally {
+    sqliteSeconds.observe({ statement }, (performance.now() - start) / 1000);
+  }
+}
+
+/**
+ * Prometheus text exposition of every registered metric
+ */
+export function renderMetrics(): string {
+  return registry.map((metric) => metric.render()).join("\n\n") + "\n";
+}
+
+/**
+ * Per-series p50/p99 for humans (GET /metrics/summary)
+ */
+export function metricsSummary() {
+  return {
+    stages: stageSeconds.summary(),
+    http: httpSeconds.summary(),
+    sqlite: sqliteSeconds.summary(),
+  };
+}
@@ -0,0 +1,53 @@
+/**
+ * Keyset (cursor) pagination helpers
+ * A cursor is the sort key of the last row on a page, base64url-encoded, so
+ * the next page is an index range seek instead of an OFFSET scan.
+ */
+
+const DEFAULT_LIMIT = 50;
+const MAX_LIMIT = 500;
+
+export interface Page<T> {
+  items: T[];
+  nextCursor: string | null;
+}
+
+export function encodeCursor(key: Array<string | number>): string {
+  return Buffer.from(JSON.stringify(key)).toString("base64url");
+}
+
+/**
+ * Decode a cursor; returns null when absent, throws on a malformed value
+ */
+export function decodeCursor(cursor: unknown, arity: number): Array<string | number> | null {
+  if (cursor === undefined || cursor === "") return null;
+
+  try {
+    const key = JSON.parse(Buffer.from(String(cursor), "base64url").toString("utf8"));
+    if (Array.isArray(key) && key.length === arity) return key;
+  } catch {
+    // fall through
+  }
+  throw new Error("Invalid cursor");
+}
+
+/**
+ * Clamp a ?limit= query value
+ */
+export function parseLimit(limit: unknown, fallback: number = DEFAULT_LIMIT): number {
+  const value = Math.floor(Number(limit));
+  if (!Number.isFinite(value) || value <= 0) return fallback;
+  return Math.min(value, MAX_LIMIT);
+}
+
+/**
+ * Build a page from limit + 1 fetched rows
+ */
+export function toPage<T>(rows: T[], limit: number, keyOf: (row: T) => Array<string | number>): Page<T> {
+  const hasMore = rows.length > limit;
+  const items = hasMore ? rows.slice(0, limit) : rows;
+  return {
+    items,
+    nextCursor: hasMore ? encodeCursor(keyOf(items[items.length - 1])) : null,
+  };
+}
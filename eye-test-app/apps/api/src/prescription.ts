@@ -0,0 +1,83 @@
+/**
+ * Prescription handoff to the overlay
+ *
+ * The latest Rx is held in memory and pushed over SSE to subscribers (the
+ * Electron main process). The results file is kept only as a persistence
+ * fallback for an overlay started later: it is written off the request path
+ * with a tmp-file + rename so readers never see a partial document.
+ */
+
+import { Response } from "express";
+import fs from "fs";
+import path from "path";
+import { SseHub } from "./sse";
+
+const CHANNEL = "prescription";
+
+export interface PrescriptionPayload {
+  sessionId: string;
+  timestamp: number;
+  rx: Record<string, unknown>;
+}
+
+class PrescriptionChannel {
+  readonly hub = new SseHub();
+  private latest: PrescriptionPayload | null = null;
+  private writing = false;
+  private pendingWrite: PrescriptionPayload | null = null;
+
+  constructor(private readonly file: string) {}
+
+  /**
+   * Push a new Rx to subscribers and persist it in the background
+   */
+  publish(payload: PrescriptionPayload): void {
+    this.latest = payload;
+    const delivered = this.hub.publish(CHANNEL, "prescription", payload);
+    console.log(`📡 Prescription pushed to ${delivered} subscriber(s)`);
+    this.persist(payload);
+  }
+
+  /**
+   * Subscribe to updates; the current Rx (if any) is sent immediately
+   */
+  subscribe(res: Response): void {
+    this.hub.subscribe(CHANNEL, res);
+    if (this.latest) {
+      this.hub.send(res, "prescription", this.latest);
+    }
+  }
+
+  current(): PrescriptionPayload | null {
+    return this.latest;
+  }
+
+  /**
+   * One write in flight at a time; bursts collapse to the newest payload
+   */
+  private persist(payload: PrescriptionPayload): void {
+    if (this.writing) {
+      this.pendingWrite = payload;
+      return;
+    }
+    this.writing = true;
+
+    const tmpFile = `${this.file}.${process.pid}.tmp`;
+    fs.promises
+      .mkdir(path.dirname(this.file), { recursive: true })
+      .then(() => fs.promises.writeFile(tmpFile, JSON.stringify(payload)))
+      .then(() => fs.promises.rename(tmpFile, this.file))
+      .then(() => console.log(`📝 Prescription written to ${this.file}`))
+      .catch((error) => console.error("❌ Failed to write prescription file:", error))
+      .finally(() => {
+        this.writing = false;
+        const next = this.pendingWrite;
+        this.pendingWrite = null;
+        if (next) this.persist(next);
+      });
+  }
+}
+
+export const prescriptions = new PrescriptionChannel(
+  path.resolve(__dirname, "../../../results/latest-prescription.json")
+);
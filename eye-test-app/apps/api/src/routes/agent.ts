@@ -1,27 +1,21 @@
 import { Router } from 'express';
-import axios from 'axios';
+import { upstreamJson } from '@OptiX/upstream';
+import { decideLocally } from '@OptiX/agent';
+import { logger } from '../logger';
+import { timeStage } from '../metrics';
 
 const router = Router();
 
-const XAI_API_URL = 'https://api.x.ai/v1/chat/completions';
+const XAI_API_URL = process.env.XAI_API_URL || 'https://api.x.ai/v1/chat/completions';
 const XAI_API_KEY = process.env.XAI_GROK_API_KEY;
+const AGENT_LLM_FALLBACK = process.env.AGENT_LLM_FALLBACK === '1';
 
 /**
- * Agent decision endpoint - uses Grok to decide which tools to call
+ * Ask Grok which tools to call (opt-in fallback for ambiguous messages)
  */
-router.post('/decide', async (req, res) => {
-  try {
-    const { message, currentState, availableTools } = req.body;
-
-    console.log('\n' + '='.repeat(60));
-    console.log('🤖 AGENT DECISION REQUEST');
-    console.log('='.repeat(60));
-    console.log('📝 Message:', message);
-    console.log('📊 Current State:', JSON.stringify(currentState, null, 2));
-    console.log('🔧 Available Tools:', availableTools.length);
-
-    // Build system prompt for Grok
-    const systemPrompt = `You are an AI eye examination agent with direct control over the examination app.
+async function grokDecide(message: string, currentState: any, availableTools: any[]) {
+  // Build system prompt for Grok
+  const systemPrompt = `You are an AI eye examination agent with direct control over the examination app.
 
 Your role is to analyze the current state and the AI examiner's message, then decide which tools to call to progress the examination.
 
@@ -43,140 +37,144 @@ Rules:
 
 Analyze the message and return the tools you want to call.`;
 
-    // Call Grok with function calling
-    const response = await axios.post(
-      XAI_API_URL,
-      {
-        model: 'grok-2-latest',
-        messages: [
-          { role: 'system', content: systemPrompt },
-          {
-            role: 'user',
-            content: `AI Examiner said: "${message}"\n\nWhat tools should I call to progress the exam?`,
-          },
-        ],
-        tools: availableTools.map((tool: any) => ({
-          type: 'function',
-          function: {
-            name: tool.name,
-            description: tool.description,
-            parameters: tool.parameters,
-          },
-        })),
-        tool_choice: 'auto',
-        temperature: 0.3, // Lower temperature for more deterministic decisions
-      },
-      {
-        headers: {
-          'Content-Type': 'application/json',
-          Authorization: `Bearer ${XAI_API_KEY}`,
+  // Call Grok with function calling
+  const response = await timeStage('agentDecide', () => upstreamJson(XAI_API_URL, {
+    headers: {
+      Authorization: `Bearer ${XAI_API_KEY}`,
+    },
+    json: {
+      model: 'grok-2-latest',
+      messages: [
+        { role: 'system', content: systemPrompt },
+        {
+          role: 'user',
+          content: `AI Examiner said: "${message}"\n\nWhat tools should I call to progress the exam?`,
         },
-      }
-    );
+      ],
+      tools: availableTools.map((tool: any) => ({
+        type: 'function',
+        function: {
+          name: tool.name,
+          description: tool.description,
+          parameters: tool.parameters,
+        },
+      })),
+      tool_choice: 'auto',
+      temperature: 0.3, // Lower temperature for more deterministic decisions
+    },
+  }));
+
+  const aiResponse = response.choices[0].message;
+  const toolCalls: any[] = [];
+
+  // Extract tool calls from Grok's response
+  if (aiResponse.tool_calls) {
+    for (const call of aiResponse.tool_calls) {
+      toolCalls.push({
+        name: call.function.name,
+        parameters: JSON.parse(call.function.arguments),
+      });
+    }
+  }
+
+  logger.info(`✅ Grok decided: ${toolCalls.map(t => t.name).join(', ') || 'NONE'}`, () => ({
+    reasoning: aiResponse.content || 'No reasoning',
+  }));
+
+  return { toolCalls, reasoning: aiResponse.content || 'No reasoning provided' };
+}
+
+/**
+ * POST /api/agent/decide
+ * Decide which tools progress the exam for an AI-examiner message.
+ * Decided locally (see decideLocally in @OptiX/agent); only messages the
+ * transition table flags as ambiguous go to Grok, and only when
+ * AGENT_LLM_FALLBACK=1 or the request sets allowFallback.
+ */
+router.post('/decide', async (req, res) => {
+  try {
+    const { message, currentState, availableTools = [], allowFallback } = req.body;
 
-    const aiResponse = response.data.choices[0].message;
-    const toolCalls: any[] = [];
+    if (typeof message !== 'string' || !currentState?.stage) {
+      return res.status(400).json({ success: false, error: 'Missing message or currentState.stage', toolCalls: [] });
+    }
 
-    // Extract tool calls from Grok's response
-    if (aiResponse.tool_calls) {
-      for (const call of aiResponse.tool_calls) {
-        toolCalls.push({
-          name: call.function.name,
-          parameters: JSON.parse(call.function.arguments),
+    // Fields are a thunk: the state is only serialized when debug is on
+    logger.debug('🤖 Agent decision request', () => ({
+      message,
+      currentState,
+      availableTools: availableTools.length,
+    }));
+
+    const decision = timeStage('agentDecideLocal', () => decideLocally(message, currentState));
+    const useFallback =
+      decision.ambiguous && (allowFallback ?? AGENT_LLM_FALLBACK) && !!XAI_API_KEY && availableTools.length > 0;
+
+    if (useFallback) {
+      try {
+        const { toolCalls, reasoning } = await grokDecide(message, currentState, availableTools);
+        return res.json({ success: true, toolCalls, reasoning, engine: 'grok' });
+      } catch (error: any) {
+        // The local (empty) decision stands: an ambiguous message never advances on its own
+        logger.warn('⚠️  Grok fallback failed, keeping local decision', {
+          message: error.message,
+          status: error.status,
         });
       }
     }
 
-    console.log('✅ GROK RESPONSE:');
-    console.log('🔧 Tools to call:', toolCalls.map(t => t.name).join(', ') || 'NONE');
-    console.log('💭 Reasoning:', aiResponse.content || 'No reasoning');
-    console.log('='.repeat(60) + '\n');
+    // Only offer tools the client said it has
+    const offered = new Set(availableTools.map((tool: any) => tool.name));
+    const toolCalls = offered.size > 0 ? decision.toolCalls.filter((call) => offered.has(call.name)) : decision.toolCalls;
+
+    logger.info(`⚡ Local decision: ${toolCalls.map((t) => t.name).join(', ') || 'NONE'}`, () => ({
+      rule: decision.rule,
+      nextStage: decision.nextStage,
+      ambiguous: decision.ambiguous,
+    }));
 
     res.json({
       success: true,
       toolCalls,
-      reasoning: aiResponse.content || 'No reasoning provided',
+      reasoning: decision.rule ? `Matched ${decision.rule}` : decision.ambiguous ? 'Ambiguous, no action' : 'No action',
+      engine: 'local',
+      nextStage: decision.nextStage,
+      ambiguous: decision.ambiguous,
     });
   } catch (error: any) {
-    console.error('\n' + '❌ AGENT ERROR:');
-    console.error('Error details:', error.response?.data || error.message);
-    if (error.response) {
-      console.error('Status:', error.response.status);
-      console.error('Data:', JSON.stringify(error.response.data, null, 2));
-    }
-    console.error('='.repeat(60) + '\n');
-    
+    logger.error('❌ Agent decision error', {
+      message: error.message,
+      status: error.status,
+      data: error.data,
+    });
+
     res.status(500).json({
       success: false,
       error: error.message,
-      details: error.response?.data,
+      details: error.data,
       toolCalls: [], // Return empty on error to fail gracefully
     });
   }
 });
 
 /**
- * Simpler pattern-based decision (fallback if Grok fails)
+ * Pattern-based decision; kept for existing callers, same engine as /decide
+ * without the LLM fallback
  */
-router.post('/decide-simple', async (req, res) => {
+router.post('/decide-simple', (req, res) => {
   try {
     const { message, currentState } = req.body;
-    const toolCalls: any[] = [];
-
-    const msg = message.toLowerCase();
+    const decision = decideLocally(String(message ?? ''), currentState ?? { stage: 'idle' });
 
-    // Pattern matching for common scenarios
-    if (msg.includes('calibration') && msg.includes('complete')) {
-      toolCalls.push({ name: 'complete_calibration', parameters: {} });
-    }
-
-    if (msg.includes('right eye') && msg.includes('complete')) {
-      toolCalls.push({ name: 'complete_sphere_test', parameters: {} });
-    }
-
-    if (msg.includes('left eye') && msg.includes('complete')) {
-      toolCalls.push({ name: 'complete_sphere_test', parameters: {} });
-    }
-
-    if (msg.includes('astigmatism') && msg.includes('complete')) {
-      toolCalls.push({ name: 'complete_astigmatism_test', parameters: {} });
-    }
-
-    // Extract viewing distance
-    const distanceMatch = msg.match(/(\d+)\s*(cm|centimeters)/i);
-    if (distanceMatch && currentState.stage === 'calibration') {
-      const distance = parseInt(distanceMatch[1]);
-      toolCalls.push({
-        name: 'set_calibration',
-        parameters: {
-          cardWidthPx: 320, // Default reasonable value
-          viewingDistanceCm: distance,
-        },
-      });
-    }
-
-    // Extract line number
-    const lineMatch = msg.match(/line\s*(\d+)/i);
-    if (lineMatch && currentState.stage.includes('sphere')) {
-      const line = parseInt(lineMatch[1]);
-      toolCalls.push({
-        name: 'record_sphere_result',
-        parameters: {
-          eye: currentState.currentEye || 'OD',
-          bestLine: line,
-        },
-      });
-    }
-
-    console.log('🔧 Simple pattern matching decided:', toolCalls.map(t => t.name).join(', '));
+    logger.info(`🔧 Simple pattern matching decided: ${decision.toolCalls.map(t => t.name).join(', ')}`);
 
     res.json({
       success: true,
-      toolCalls,
+      toolCalls: decision.toolCalls,
       reasoning: 'Pattern-based decision',
     });
   } catch (error: any) {
-    console.error('Simple agent decision error:', error.message);
+    logger.error('Simple agent decision error', { message: error.message });
     res.status(500).json({
       success: false,
       error: error.message,
@@ -200,15 +198,16 @@ router.post('/analyze-response', async (req, res) => {
       previousPerformance = [],
     } = req.body;
 
-    console.log('\n' + '='.repeat(60));
-    console.log('🧠 PATIENT RESPONSE ANALYSIS');
-    console.log('='.repeat(60));
-    console.log('👤 Patient said:', patientSpeech);
-    console.log('🎯 Expected:', expectedLetters);
-    console.log('📊 Line:', currentLine, '| Eye:', eye, '| Stage:', stage);
+    logger.debug('🧠 Patient response analysis', () => ({
+      patientSpeech,
+      expectedLetters,
+      currentLine,
+      eye,
+      stage,
+    }));
 
     if (!XAI_API_KEY) {
-      console.log('⚠️  No xAI API key, using fallback logic');
+      logger.warn('⚠️  No xAI API key, using fallback logic');
       return res.json({
         correct: false,
         confidence: 0.5,
@@ -268,9 +267,11 @@ Respond in JSON format:
   "reasoning": "brief explanation"
 }`;
 
-    const response = await axios.post(
-      XAI_API_URL,
-      {
+    const response = await timeStage('agentAnalyze', () => upstreamJson(XAI_API_URL, {
+      headers: {
+        Authorization: `Bearer ${XAI_API_KEY}`,
+      },
+      json: {
         model: 'grok-2-latest',
         messages: [
           { role: 'system', content: systemPrompt },
@@ -279,28 +280,19 @@ Respond in JSON format:
         temperature: 0.2,
         response_format: { type: 'json_object' },
       },
-      {
-        headers: {
-          'Content-Type': 'application/json',
-          Authorization: `Bearer ${XAI_API_KEY}`,
-        },
-      }
-    );
+    }));
 
-    const analysis = JSON.parse(response.data.choices[0].message.content);
+    const analysis = JSON.parse(response.choices[0].message.content);
 
-    console.log('✅ ANALYSIS RESULT:');
-    console.log('  Correct:', analysis.correct, `(${(analysis.confidence * 100).toFixed(0)}% confidence)`);
-    console.log('  Diopter:', analysis.suggestedDiopter);
-    console.log('  Recommendation:', analysis.recommendation);
-    console.log('  Reasoning:', analysis.reasoning);
-    console.log('='.repeat(60) + '\n');
+    logger.info(
+      `✅ Analysis: correct=${analysis.correct} (${(analysis.confidence * 100).toFixed(0)}% confidence), ` +
+        `diopter=${analysis.suggestedDiopter}, ${analysis.recommendation}`,
+      () => ({ reasoning: analysis.reasoning })
+    );
 
     res.json(analysis);
   } catch (error: any) {
-    console.error('\n' + '❌ ANALYSIS ERROR:');
-    console.error('Error:', error.response?.data || error.message);
-    console.error('='.repeat(60) + '\n');
+    logger.error('❌ Analysis error', { message: error.message, data: error.data });
 
     // Fallback analysis
     res.json({
@@ -8,15 +8,12 @@ import {
   startConversation,
   sendAudioToConversation,
   sendTextToConversation,
-  endConversation,
 } from "@OptiX/voice";
+import { conversations } from "../conversationRegistry";
 
 const router = Router();
 const upload = multer({ storage: multer.memoryStorage() });
 
-// Store active conversations (in production, use Redis or DB)
-const activeConversations = new Map<string, string>();
-
 /**
  * POST /api/conversation/start
  * Start a new conversational AI session for sphere test
@@ -37,9 +34,8 @@ router.post("/start", async (req, res) => {
         `Hello! Let's test your ${eye === "OD" ? "right" : "left"} eye. Please read the letters you see on the screen out loud.`,
     });
 
-    // Store conversation ID mapped to session
-    const key = `${sessionId}-${eye}`;
-    activeConversations.set(key, conversationId);
+    // Store conversation ID mapped to session (shared across API processes)
+    await conversations.register(sessionId, eye, conversationId);
 
     res.json({
       success: true,
@@ -64,8 +60,7 @@ router.post("/audio", upload.single("audio"), async (req, res) => {
       return res.status(400).json({ error: "No audio file" });
     }
 
-    const key = `${sessionId}-${eye}`;
-    const conversationId = activeConversations.get(key);
+    const conversationId = await conversations.lookup(sessionId, eye);
 
     if (!conversationId) {
       return res.status(404).json({ error: "Conversation not found. Start one first." });
@@ -106,8 +101,7 @@ router.post("/message", async (req, res) => {
       return res.status(400).json({ error: "Missing message" });
     }
 
-    const key = `${sessionId}-${eye}`;
-    const conversationId = activeConversations.get(key);
+    const conversationId = await conversations.lookup(sessionId, eye);
 
     if (!conversationId) {
       return res.status(404).json({ error: "Conversation not found" });
@@ -137,13 +131,8 @@ router.post("/end", async (req, res) => {
   try {
     const { sessionId, eye } = req.body;
 
-    const key = `${sessionId}-${eye}`;
-    const conversationId = activeConversations.get(key);
-
-    if (conversationId) {
-      await endConversation(conversationId);
-      activeConversations.delete(key);
-      console.log(`🎤 Ended conversation for ${key}`);
+    if (await conversations.end(sessionId, eye)) {
+      console.log(`🎤 Ended conversation for ${sessionId}-${eye}`);
     }
 
     res.json({
@@ -160,11 +149,17 @@ router.post("/end", async (req, res) => {
  * GET /api/conversation/active
  * Get active conversation count (for debugging)
  */
-router.get("/active", (req, res) => {
-  res.json({
-    count: activeConversations.size,
-    conversations: Array.from(activeConversations.keys()),
-  });
+router.get("/active", async (req, res) => {
+  try {
+    const keys = await conversations.active();
+    res.json({
+      count: keys.length,
+      conversations: keys,
+    });
+  } catch (error: any) {
+    console.error("Active conversations error:", error);
+    res.status(500).json({ error: error.message });
+  }
 });
 
 export default router;
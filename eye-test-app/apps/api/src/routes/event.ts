@@ -2,42 +2,63 @@
  * Event logging routes
  */
 
-import { Router } from "express";
+import express, { Router } from "express";
 import { eventQueries, serializeParams } from "../db";
+import { dbWriter } from "../dbWriter";
+import { WriteOp } from "../writeStatements";
+import { decodeCursor, parseLimit, toPage } from "../pagination";
 
 const router = Router();
 
+const MAX_BATCH_SIZE = 500;
+
+/**
+ * Validate an event body and map it to eventQueries.create parameters
+ */
+function toEventRow(event: any): unknown[] | null {
+  if (!event) return null;
+
+  const {
+    sessionId,
+    t,
+    step,
+    lettersShown,
+    speechText,
+    correct,
+    latencyMs,
+    params,
+  } = event;
+
+  if (!sessionId || t === undefined || !step) {
+    return null;
+  }
+
+  return [
+    sessionId,
+    t,
+    step,
+    lettersShown || null,
+    speechText || null,
+    correct !== undefined ? (correct ? 1 : 0) : null,
+    latencyMs || null,
+    params ? serializeParams(params) : null,
+  ];
+}
+
 /**
  * POST /api/event
  * Log a test event
  */
 router.post("/", (req, res) => {
   try {
-    const {
-      sessionId,
-      t,
-      step,
-      lettersShown,
-      speechText,
-      correct,
-      latencyMs,
-      params,
-    } = req.body;
-
-    if (!sessionId || t === undefined || !step) {
+    const row = toEventRow(req.body);
+
+    if (!row) {
       return res.status(400).json({ error: "Missing required fields" });
     }
 
-    eventQueries.create.run(
-      sessionId,
-      t,
-      step,
-      lettersShown || null,
-      speechText || null,
-      correct !== undefined ? (correct ? 1 : 0) : null,
-      latencyMs || null,
-      params ? serializeParams(params) : null
-    );
+    // Telemetry: fire-and-forget, committed with the next writer group
+    dbWriter.enqueue(["events.create", row]);
 
     res.json({ success: true });
   } catch (error: any) {
@@ -47,14 +68,71 @@ router.post("/", (req, res) => {
 });
 
 /**
- * GET /api/event/:sessionId
- * Get all events for a session
+ * POST /api/event/batch
+ * Log many events in one transaction. Accepts {events: [...]} or a bare
+ * array, as JSON or as text/plain (navigator.sendBeacon payloads).
+ */
+router.post("/batch", express.text({ type: "text/plain", limit: "1mb" }), (req, res) => {
+  try {
+    let body = req.body;
+    if (typeof body === "string") {
+      try {
+        body = JSON.parse(body);
+      } catch {
+        return res.status(400).json({ error: "Invalid JSON" });
+      }
+    }
+
+    const events = Array.isArray(body) ? body : body?.events;
+    if (!Array.isArray(events)) {
+      return res.status(400).json({ error: "Missing events array" });
+    }
+    if (events.length > MAX_BATCH_SIZE) {
+      return res.status(413).json({ error: `Batch exceeds ${MAX_BATCH_SIZE} events` });
+    }
+
+    const rows: WriteOp[] = [];
+    for (const event of events) {
+      const row = toEventRow(event);
+      if (row) rows.push(["events.create", row]);
+    }
+
+    // One atomic unit, fire-and-forget
+    dbWriter.enqueue(...rows);
+
+    res.json({
+      success: true,
+      inserted: rows.length,
+      rejected: events.length - rows.length,
+    });
+  } catch (error: any) {
+    console.error("Error logging event batch:", error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * GET /api/event/:sessionId?limit=500&cursor=...
+ * Get a session's events in replay order, one page at a time
  */
 router.get("/:sessionId", (req, res) => {
   try {
     const { sessionId } = req.params;
-    const events = eventQueries.getBySession.all(sessionId);
-    res.json(events);
+    const limit = parseLimit(req.query.limit, 500);
+    let after;
+    try {
+      after = decodeCursor(req.query.cursor, 2);
+    } catch {
+      return res.status(400).json({ error: "Invalid cursor" });
+    }
+
+    const rows = (
+      after
+        ? eventQueries.getPageAfter.all(sessionId, after[0], after[1], limit + 1)
+        : eventQueries.getPage.all(sessionId, limit + 1)
+    ) as Array<{ id: number; t: number }>;
+
+    res.json(toPage(rows, limit, (row) => [row.t, row.id]));
   } catch (error: any) {
     console.error("Error fetching events:", error);
     res.status(500).json({ error: error.message });
@@ -0,0 +1,18 @@
+/**
+ * Grok hint push channel
+ */
+
+import { Router } from "express";
+import { hints } from "../hints";
+
+const router = Router();
+
+/**
+ * GET /api/hints/:sessionId/stream
+ * Server-Sent Events stream of hints as they finish computing
+ */
+router.get("/:sessionId/stream", (req, res) => {
+  hints.hub.subscribe(req.params.sessionId, res);
+});
+
+export default router;
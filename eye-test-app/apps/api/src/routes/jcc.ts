@@ -9,30 +9,53 @@ import {
   isJccComplete,
   getJccResult,
   calculateJccConfidence,
+  JccState,
 } from "@OptiX/core";
-import { grokHint } from "@OptiX/agent";
+import { examState } from "../examState";
+import { hints } from "../hints";
+import { timeStage } from "../metrics";
+import { recordJccTrial } from "../trials";
 
 const router = Router();
 
+/**
+ * Compact view of the JCC search sent to clients (history stays server-side)
+ */
+function summarizeJcc(state: JccState) {
+  return {
+    eye: state.eye,
+    axisDeg: state.axisDeg,
+    cyl: state.cyl,
+    stepDeg: state.stepDeg,
+    stage: state.stage,
+    trialCount: state.history.length,
+  };
+}
+
 /**
  * POST /api/jcc/init
  * Initialize JCC for one eye
  */
 router.post("/init", (req, res) => {
   try {
-    const { eye, startAxis } = req.body;
+    const { sessionId, eye, startAxis } = req.body;
+
+    if (!sessionId) {
+      return res.status(400).json({ error: "Missing sessionId" });
+    }
 
     if (!eye || !["OD", "OS"].includes(eye)) {
       return res.status(400).json({ error: "Invalid eye" });
     }
 
     const state = initJcc(eye, startAxis);
+    examState.set("jcc", sessionId, eye, state);
 
     console.log(`👁️  Initialized JCC for ${eye}`);
 
     res.json({
       success: true,
-      state,
+      state: summarizeJcc(state),
     });
   } catch (error: any) {
     console.error("JCC init error:", error);
@@ -44,15 +67,28 @@ router.post("/init", (req, res) => {
  * POST /api/jcc/next
  * Advance JCC based on user choice (1 or 2)
  */
-router.post("/next", async (req, res) => {
+router.post("/next", (req, res) => {
   try {
-    const { state, choice, latencyMs } = req.body;
+    const { sessionId, eye, choice, latencyMs } = req.body;
+    // Client-measured stimulus onset → speech onset; absent when it couldn't be timed
+    const measuredMs = Number.isFinite(latencyMs) && latencyMs >= 0 ? Math.round(latencyMs) : undefined;
+
+    if (!sessionId || !eye || !choice || ![1, 2].includes(choice)) {
+      return res.status(400).json({ error: "Missing sessionId/eye or invalid choice" });
+    }
 
-    if (!state || !choice || ![1, 2].includes(choice)) {
-      return res.status(400).json({ error: "Missing state or invalid choice" });
+    const state = examState.get<JccState>("jcc", sessionId, eye);
+    if (!state) {
+      return res.status(404).json({ error: "JCC not initialized for this eye" });
     }
 
-    const nextState = nextJcc(state, choice);
+    // Probe under test, read before nextJcc() moves it
+    const { stage, axisDeg, cyl } = state;
+    const nextState = timeStage("nextJcc", () => nextJcc(state, choice));
+    if (stage !== "done") {
+      recordJccTrial(sessionId, eye, stage, axisDeg, cyl, choice, measuredMs);
+    }
+    examState.set("jcc", sessionId, eye, nextState);
     const complete = isJccComplete(nextState);
     const confidence = calculateJccConfidence(nextState);
 
@@ -64,12 +100,13 @@ router.post("/next", async (req, res) => {
       );
     }
 
-    // Get Grok hint for optimization
+    // Hints are computed in the background (see staircase route)
     const recentChoices = nextState.history.slice(-3);
     const sameChoices = recentChoices.filter((h) => h.choice === choice).length;
-    const grokSuggestion = await grokHint({
+    const grokSuggestion = hints.latestFor(sessionId, eye, "jcc");
+    hints.request(sessionId, eye, {
       misses: sameChoices < 2 ? 1 : 0, // Treat inconsistent choices as "misses"
-      latencyMs: latencyMs || 2000,
+      latencyMs: measuredMs ?? 2000,
       confidence,
       stage: "jcc",
       reversals: 0, // N/A for JCC
@@ -78,11 +115,12 @@ router.post("/next", async (req, res) => {
 
     res.json({
       success: true,
-      state: nextState,
+      state: summarizeJcc(nextState),
       complete,
       confidence,
       result,
-      grokHint: grokSuggestion,
+      grokHint: grokSuggestion?.hint ?? null,
+      grokHintTrial: grokSuggestion?.trial ?? null,
     });
   } catch (error: any) {
     console.error("JCC next error:", error);
@@ -5,6 +5,9 @@
 import { Router } from "express";
 import { nanoid } from "nanoid";
 import { sessionQueries } from "../db";
+import { dbWriter } from "../dbWriter";
+import { dashboards } from "../dashboard";
+import { decodeCursor, parseLimit, toPage } from "../pagination";
 
 const router = Router();
 
@@ -12,22 +15,28 @@ const router = Router();
  * POST /api/session
  * Create a new test session
  */
-router.post("/", (req, res) => {
+router.post("/", async (req, res) => {
   try {
     const { deviceInfo, distanceCm, screenPpi, lighting } = req.body;
 
     const sessionId = nanoid();
-    const createdAt = new Date().toISOString();
-
-    sessionQueries.create.run(
-      sessionId,
-      createdAt,
-      deviceInfo || "Unknown",
-      distanceCm || 0,
-      screenPpi || 0,
-      lighting || "photopic",
-      "active"
-    );
+    const now = new Date();
+    const createdAt = now.toISOString();
+
+    // Durable before the id goes out: clients read the session right back
+    await dbWriter.commit([
+      "sessions.create",
+      [
+        sessionId,
+        createdAt,
+        now.getTime(),
+        deviceInfo || "Unknown",
+        distanceCm || 0,
+        screenPpi || 0,
+        lighting || "photopic",
+        "active",
+      ],
+    ]);
 
     console.log(`📋 Created session ${sessionId}`);
 
@@ -66,7 +75,7 @@ router.get("/:id", (req, res) => {
  * PATCH /api/session/:id
  * Update session state
  */
-router.patch("/:id", (req, res) => {
+router.patch("/:id", async (req, res) => {
   try {
     const { id } = req.params;
     const { state } = req.body;
@@ -75,7 +84,8 @@ router.patch("/:id", (req, res) => {
       return res.status(400).json({ error: "Invalid state" });
     }
 
-    sessionQueries.updateState.run(state, id);
+    await dbWriter.commit(["sessions.updateState", [state, id]]);
+    dashboards.invalidate();
 
     console.log(`📋 Updated session ${id} to ${state}`);
 
@@ -87,13 +97,26 @@ router.patch("/:id", (req, res) => {
 });
 
 /**
- * GET /api/sessions
- * List recent sessions
+ * GET /api/session?limit=50&cursor=...
+ * List sessions newest first; pass nextCursor back to get the next page
  */
 router.get("/", (req, res) => {
   try {
-    const sessions = sessionQueries.getAll.all();
-    res.json(sessions);
+    const limit = parseLimit(req.query.limit);
+    let after;
+    try {
+      after = decodeCursor(req.query.cursor, 2);
+    } catch {
+      return res.status(400).json({ error: "Invalid cursor" });
+    }
+
+    const rows = (
+      after
+        ? sessionQueries.getPageBefore.all(after[0], after[1], limit + 1)
+        : sessionQueries.getPage.all(limit + 1)
+    ) as Array<{ id: string; createdAtMs: number }>;
+
+    res.json(toPage(rows, limit, (row) => [row.createdAtMs, row.id]));
   } catch (error: any) {
     console.error("Error fetching sessions:", error);
     res.status(500).json({ error: error.message });
@@ -1,39 +1,70 @@
 /**
- * Staircase algorithm routes
+ * Acuity threshold routes (QUEST+ or 1-up/2-down staircase)
  */
 
 import { Router } from "express";
 import {
-  initStaircase,
-  nextStairState,
-  isStaircaseComplete,
-  calculateThreshold,
-  calculateConfidence,
+  LOGMAR_STEPS,
+  getThresholdEngine,
   logmarToSphere,
+  ThresholdEngine,
+  ThresholdEngineName,
 } from "@OptiX/core";
-import { grokHint } from "@OptiX/agent";
+import { examState } from "../examState";
+import { hints } from "../hints";
+import { timeStage } from "../metrics";
+import { recordAcuityTrial } from "../trials";
 
 const router = Router();
 
+const DEFAULT_ENGINE: ThresholdEngineName =
+  process.env.THRESHOLD_ENGINE === "staircase" ? "staircase" : "quest";
+
+/**
+ * Stored per session/eye: which engine is running and its state
+ */
+interface ThresholdRecord {
+  engine: ThresholdEngineName;
+  state: any;
+}
+
+/**
+ * Compact view of the search sent to clients (engine state stays server-side)
+ */
+function summarize(engine: ThresholdEngine, state: any) {
+  return { engine: engine.name, ...engine.progress(state) };
+}
+
 /**
  * POST /api/staircase/init
- * Initialize staircase for one eye
+ * Initialize the acuity threshold search for one eye
+ * Optional `engine`: "quest" (default) or "staircase"
  */
 router.post("/init", (req, res) => {
   try {
-    const { eye, startIndex } = req.body;
+    const { sessionId, eye, startIndex, engine: engineName = DEFAULT_ENGINE } = req.body;
+
+    if (!sessionId) {
+      return res.status(400).json({ error: "Missing sessionId" });
+    }
 
     if (!eye || !["OD", "OS"].includes(eye)) {
       return res.status(400).json({ error: "Invalid eye" });
     }
 
-    const state = initStaircase(eye, startIndex);
+    const engine = getThresholdEngine(engineName);
+    if (!engine) {
+      return res.status(400).json({ error: "Invalid engine" });
+    }
+
+    const state = engine.init(eye, startIndex);
+    examState.set<ThresholdRecord>("staircase", sessionId, eye, { engine: engine.name, state });
 
-    console.log(`👁️  Initialized staircase for ${eye}`);
+    console.log(`👁️  Initialized ${engine.name} for ${eye}`);
 
     res.json({
       success: true,
-      state,
+      state: summarize(engine, state),
     });
   } catch (error: any) {
     console.error("Staircase init error:", error);
@@ -43,49 +74,80 @@ router.post("/init", (req, res) => {
 
 /**
  * POST /api/staircase/next
- * Advance staircase based on response
+ * Advance the threshold search based on response
+ * Optional `sizeIndex`: the LOGMAR_STEPS size actually shown, for clients
+ * that pace presentation themselves (the line-by-line chart)
  */
-router.post("/next", async (req, res) => {
+router.post("/next", (req, res) => {
   try {
-    const { state, wasCorrect, latencyMs } = req.body;
+    const { sessionId, eye, wasCorrect, latencyMs, sizeIndex } = req.body;
+    // Client-measured stimulus onset → speech onset; absent when it couldn't be timed
+    const measuredMs = Number.isFinite(latencyMs) && latencyMs >= 0 ? Math.round(latencyMs) : undefined;
+
+    if (!sessionId || !eye || wasCorrect === undefined) {
+      return res.status(400).json({ error: "Missing sessionId, eye or wasCorrect" });
+    }
 
-    if (!state || wasCorrect === undefined) {
-      return res.status(400).json({ error: "Missing state or wasCorrect" });
+    const record = examState.get<ThresholdRecord>("staircase", sessionId, eye);
+    if (!record) {
+      return res.status(404).json({ error: "Staircase not initialized for this eye" });
     }
 
-    const nextState = nextStairState(state, wasCorrect);
-    const complete = isStaircaseComplete(nextState);
-    const confidence = calculateConfidence(nextState);
+    const engine = getThresholdEngine(record.engine);
+    if (!engine) {
+      return res.status(500).json({ error: `Unknown engine ${record.engine}` });
+    }
+
+    if (Number.isInteger(sizeIndex) && sizeIndex >= 0 && sizeIndex < LOGMAR_STEPS.length) {
+      record.state = engine.presented(record.state, sizeIndex);
+    }
+
+    // Read before next(), which may update the state in place
+    const shownIndex = engine.sizeIndex(record.state);
+    const nextState = timeStage(engine.next.name || `${engine.name}.next`, () =>
+      engine.next(record.state, wasCorrect)
+    );
+    examState.set<ThresholdRecord>("staircase", sessionId, eye, {
+      engine: engine.name,
+      state: nextState,
+    });
+    recordAcuityTrial(sessionId, eye, engine.name, shownIndex, Boolean(wasCorrect), measuredMs);
+    const complete = engine.isComplete(nextState);
+    const confidence = engine.confidence(nextState);
+    const progress = engine.progress(nextState);
 
     let threshold = null;
     let sphere = null;
 
     if (complete) {
-      threshold = calculateThreshold(nextState);
+      threshold = engine.threshold(nextState);
       sphere = logmarToSphere(threshold);
       console.log(
-        `👁️  Staircase complete for ${state.eye}: threshold=${threshold} logMAR, sphere=${sphere}D`
+        `👁️  ${engine.name} complete for ${eye} after ${progress.trialCount} trials: threshold=${threshold} logMAR, sphere=${sphere}D`
       );
     }
 
-    // Get Grok hint for optimization
-    const grokSuggestion = await grokHint({
-      misses: nextState.history.filter((h) => !h.correct).length,
-      latencyMs: latencyMs || 2000,
+    // Hints are computed in the background; this response carries the most
+    // recent finished one and fresher ones arrive on /api/hints/:sessionId/stream
+    const grokSuggestion = hints.latestFor(sessionId, eye, "sphere");
+    hints.request(sessionId, eye, {
+      misses: progress.misses,
+      latencyMs: measuredMs ?? 2000,
       confidence,
       stage: "sphere",
-      reversals: nextState.reversals,
-      trialCount: nextState.history.length,
+      reversals: progress.reversals,
+      trialCount: progress.trialCount,
     });
 
     res.json({
       success: true,
-      state: nextState,
+      state: { engine: engine.name, ...progress },
       complete,
       confidence,
       threshold,
       sphere,
-      grokHint: grokSuggestion,
+      grokHint: grokSuggestion?.hint ?? null,
+      grokHintTrial: grokSuggestion?.trial ?? null,
     });
   } catch (error: any) {
     console.error("Staircase next error:", error);
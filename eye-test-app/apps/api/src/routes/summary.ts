@@ -3,31 +3,20 @@
  */
 
 import { Router } from "express";
-import fs from "fs";
-import path from "path";
 import { rxQueries, sessionQueries } from "../db";
+import { ExportFormat, ExportTable, parseFormat, streamExport } from "../export";
+import { prescriptions } from "../prescription";
+import { dbWriter } from "../dbWriter";
+import { WriteOp } from "../writeStatements";
+import { dashboards } from "../dashboard";
 
 const router = Router();
-const resultsDir = path.resolve(__dirname, "../../../../results");
-const resultsFile = path.join(resultsDir, "latest-prescription.json");
-
-function writeLatestPrescription(payload: any) {
-  try {
-    if (!fs.existsSync(resultsDir)) {
-      fs.mkdirSync(resultsDir, { recursive: true });
-    }
-    fs.writeFileSync(resultsFile, JSON.stringify(payload, null, 2));
-    console.log(`📝 Prescription written to ${resultsFile}`);
-  } catch (error) {
-    console.error("❌ Failed to write prescription file:", error);
-  }
-}
 
 /**
  * POST /api/summary
  * Generate and save final Rx
  */
-router.post("/", (req, res) => {
+router.post("/", async (req, res) => {
   try {
     const { sessionId, results } = req.body;
 
@@ -37,39 +26,25 @@ router.post("/", (req, res) => {
 
     const { OD, OS } = results;
 
-    // Save Rx for both eyes
-    if (OD) {
-      rxQueries.upsert.run(
-        sessionId,
-        "OD",
-        OD.S || 0,
-        OD.C || 0,
-        OD.Axis || 0,
-        OD.VA_logMAR || null,
-        OD.confidence || null
-      );
-    }
-
-    if (OS) {
-      rxQueries.upsert.run(
-        sessionId,
-        "OS",
-        OS.S || 0,
-        OS.C || 0,
-        OS.Axis || 0,
-        OS.VA_logMAR || null,
-        OS.confidence || null
-      );
+    // Save Rx for both eyes and complete the session in one atomic unit,
+    // acknowledged only once it's durable
+    const writes: WriteOp[] = [];
+    for (const [eye, rx] of [["OD", OD], ["OS", OS]] as const) {
+      if (!rx) continue;
+      writes.push([
+        "rx.upsert",
+        [sessionId, eye, rx.S || 0, rx.C || 0, rx.Axis || 0, rx.VA_logMAR || null, rx.confidence || null],
+      ]);
     }
-
-    // Update session state to completed
-    sessionQueries.updateState.run("completed", sessionId);
+    writes.push(["sessions.updateState", ["completed", sessionId]]);
+    await dbWriter.commit(...writes);
+    dashboards.invalidate();
 
     console.log(`📊 Generated Rx for session ${sessionId}`);
     console.log(`   OD: ${OD.S} ${OD.C} × ${OD.Axis}°`);
     console.log(`   OS: ${OS.S} ${OS.C} × ${OS.Axis}°`);
 
-    writeLatestPrescription({
+    prescriptions.publish({
       sessionId,
       timestamp: Date.now(),
       rx: { OD, OS },
@@ -85,76 +60,171 @@ router.post("/", (req, res) => {
   }
 });
 
+const DAY_MS = 24 * 60 * 60 * 1000;
+
+const SESSION_COLUMNS: ExportTable["columns"] = [
+  ["id", "sessionId"],
+  ["createdAt", "createdAt"],
+  ["deviceInfo", "deviceInfo"],
+  ["distanceCm", "distanceCm"],
+  ["screenPpi", "screenPpi"],
+  ["lighting", "lighting"],
+  ["state", "state"],
+];
+
+const RX_COLUMNS: ExportTable["columns"] = [
+  ["sessionId", "sessionId"],
+  ["eye", "eye"],
+  ["S", "S"],
+  ["C", "C"],
+  ["Axis", "Axis"],
+  ["VA_logMAR", "VA_logMAR"],
+  ["confidence", "confidence"],
+];
+
+const EVENT_COLUMNS: ExportTable["columns"] = [
+  ["id", "id"],
+  ["sessionId", "sessionId"],
+  ["t", "t"],
+  ["step", "step"],
+  ["lettersShown", "lettersShown"],
+  ["speechText", "speechText"],
+  ["correct", "correct"],
+  ["latencyMs", "latencyMs"],
+  ["params", "params"],
+];
+
+// Raw codes (see TRIAL_STEPS in trials.ts): exports stay compact and typed
+const TRIAL_COLUMNS: ExportTable["columns"] = [
+  ["id", "id"],
+  ["sessionId", "sessionId"],
+  ["t", "t"],
+  ["eye", "eye"],
+  ["step", "step"],
+  ["sizeIndex", "sizeIndex"],
+  ["correct", "correct"],
+  ["latencyMs", "latencyMs"],
+  ["axisDeg", "axisDeg"],
+  ["cyl", "cyl"],
+  ["choice", "choice"],
+];
+
 /**
- * GET /api/summary/:sessionId
- * Retrieve saved Rx for a session
+ * Resolve ?table= against the available tables
+ * CSV needs exactly one table; NDJSON takes all of them by default.
  */
-router.get("/:sessionId", (req, res) => {
-  try {
-    const { sessionId } = req.params;
+function selectTables(
+  tables: Record<string, ExportTable>,
+  table: unknown,
+  format: ExportFormat,
+  csvDefault: string
+): ExportTable[] | null {
+  if (table === undefined) {
+    return format === "csv" ? [tables[csvDefault]] : Object.values(tables);
+  }
+  const names = String(table).split(",");
+  if (format === "csv" && names.length !== 1) return null;
+  // A Map, so ?table=constructor can't resolve to an Object.prototype member
+  const byName = new Map(Object.entries(tables));
+  const selected = names.map((name) => byName.get(name));
+  return selected.every((entry): entry is ExportTable => entry !== undefined) ? selected : null;
+}
 
-    const rxData = rxQueries.getBySession.all(sessionId);
+/**
+ * GET /api/summary/export?from=ISO&to=ISO&format=csv|ndjson&table=sessions|rx|events|trials&gzip=1
+ * Bulk export for sessions created in [from, to). Defaults to the last 24h.
+ * CSV exports one table (events by default); NDJSON exports all of them.
+ */
+router.get("/export", (req, res) => {
+  try {
+    const format = parseFormat(req.query.format);
+    if (!format) {
+      return res.status(400).json({ error: "Invalid format" });
+    }
 
-    if (rxData.length === 0) {
-      return res.status(404).json({ error: "No Rx found for this session" });
+    const toMs = req.query.to ? Date.parse(String(req.query.to)) : Date.now();
+    const fromMs = req.query.from ? Date.parse(String(req.query.from)) : toMs - DAY_MS;
+    if (Number.isNaN(fromMs) || Number.isNaN(toMs) || fromMs >= toMs) {
+      return res.status(400).json({ error: "Invalid from/to range" });
     }
 
-    const rx: any = {};
-    for (const row of rxData) {
-      const r = row as any;
-      rx[r.eye] = {
-        S: r.S,
-        C: r.C,
-        Axis: r.Axis,
-        VA_logMAR: r.VA_logMAR,
-        confidence: r.confidence,
-        eye: r.eye,
-      };
+    const tables: Record<string, ExportTable> = {
+      sessions: {
+        name: "session",
+        columns: SESSION_COLUMNS,
+        rows: (queries) => queries.sessionsInRange.iterate(fromMs, toMs),
+      },
+      rx: {
+        name: "rx",
+        columns: RX_COLUMNS,
+        rows: (queries) => queries.rxInRange.iterate(fromMs, toMs),
+      },
+      events: {
+        name: "event",
+        columns: EVENT_COLUMNS,
+        rows: (queries) => queries.eventsInRange.iterate(fromMs, toMs),
+      },
+      trials: {
+        name: "trial",
+        columns: TRIAL_COLUMNS,
+        rows: (queries) => queries.trialsInRange.iterate(fromMs, toMs),
+      },
+    };
+
+    const selected = selectTables(tables, req.query.table, format, "events");
+    if (!selected) {
+      return res.status(400).json({ error: "Invalid table" });
     }
 
-    res.json({
-      sessionId,
-      rx,
-    });
+    const range = `${new Date(fromMs).toISOString().slice(0, 10)}_${new Date(toMs).toISOString().slice(0, 10)}`;
+    console.log(`📦 Bulk ${format} export ${new Date(fromMs).toISOString()} → ${new Date(toMs).toISOString()}`);
+
+    streamExport(req, res, `OptiX-export-${range}`, selected, format);
   } catch (error: any) {
-    console.error("Summary retrieval error:", error);
+    console.error("Bulk export error:", error);
     res.status(500).json({ error: error.message });
   }
 });
 
 /**
- * GET /api/summary/:sessionId/export
- * Export session data as CSV
+ * GET /api/summary/dashboard?from=YYYY-MM-DD&to=YYYY-MM-DD
+ * Population dashboard over [from, to) from the trigger-maintained rollups
+ * (default: the last 30 days). Cached per range; registered before /:sessionId.
  */
-router.get("/:sessionId/export", (req, res) => {
+router.get("/dashboard", (req, res) => {
   try {
-    const { sessionId } = req.params;
-
-    const rxData = rxQueries.getBySession.all(sessionId);
-
-    if (rxData.length === 0) {
-      return res.status(404).json({ error: "No data to export" });
+    const toMs = req.query.to ? Date.parse(String(req.query.to)) : Date.now() + DAY_MS;
+    const fromMs = req.query.from ? Date.parse(String(req.query.from)) : toMs - 30 * DAY_MS;
+    if (Number.isNaN(fromMs) || Number.isNaN(toMs) || fromMs >= toMs) {
+      return res.status(400).json({ error: "Invalid from/to range" });
     }
 
-    // Generate CSV
-    let csv = "Eye,Sphere,Cylinder,Axis,VA_logMAR,Confidence\n";
-    for (const row of rxData) {
-      const r = row as any;
-      csv += `${r.eye},${r.S},${r.C},${r.Axis},${r.VA_logMAR || ""},${r.confidence || ""}\n`;
-    }
+    const from = new Date(fromMs).toISOString().slice(0, 10);
+    const to = new Date(toMs).toISOString().slice(0, 10);
 
-    res.set("Content-Type", "text/csv");
-    res.set("Content-Disposition", `attachment; filename="OptiX-${sessionId}.csv"`);
-    res.send(csv);
+    res.set("Cache-Control", `private, max-age=${Math.floor(dashboards.ttlMs / 1000)}`);
+    res.json(dashboards.get(from, to));
   } catch (error: any) {
-    console.error("Export error:", error);
+    console.error("Dashboard error:", error);
     res.status(500).json({ error: error.message });
   }
 });
 
+/**
+ * GET /api/summary/stream
+ * Server-Sent Events stream of finalized prescriptions (consumed by the overlay)
+ */
+router.get("/stream", (req, res) => {
+  prescriptions.subscribe(res);
+});
+
+/**
+ * GET /api/summary/latest
+ * Rx of the most recent session (registered before /:sessionId so it isn't shadowed)
+ */
 router.get("/latest", (req, res) => {
   try {
-    const latestSession = sessionQueries.getLatest.get();
+    const latestSession = sessionQueries.getLatest.get() as any;
     if (!latestSession) {
       return res.status(404).json({ error: "No sessions found" });
     }
@@ -188,5 +258,91 @@ router.get("/latest", (req, res) => {
   }
 });
 
+/**
+ * GET /api/summary/:sessionId
+ * Retrieve saved Rx for a session
+ */
+router.get("/:sessionId", (req, res) => {
+  try {
+    const { sessionId } = req.params;
+
+    const rxData = rxQueries.getBySession.all(sessionId);
+
+    if (rxData.length === 0) {
+      return res.status(404).json({ error: "No Rx found for this session" });
+    }
+
+    const rx: any = {};
+    for (const row of rxData) {
+      const r = row as any;
+      rx[r.eye] = {
+        S: r.S,
+        C: r.C,
+        Axis: r.Axis,
+        VA_logMAR: r.VA_logMAR,
+        confidence: r.confidence,
+        eye: r.eye,
+      };
+    }
+
+    res.json({
+      sessionId,
+      rx,
+    });
+  } catch (error: any) {
+    console.error("Summary retrieval error:", error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * GET /api/summary/:sessionId/export?format=csv|ndjson&table=rx|events&gzip=1
+ * Stream a session's data. CSV exports one table (Rx by default); NDJSON
+ * exports Rx and events unless ?table= narrows it.
+ */
+router.get("/:sessionId/export", (req, res) => {
+  try {
+    const { sessionId } = req.params;
+    const format = parseFormat(req.query.format);
+    if (!format) {
+      return res.status(400).json({ error: "Invalid format" });
+    }
+
+    if (!sessionQueries.getById.get(sessionId)) {
+      return res.status(404).json({ error: "No data to export" });
+    }
+
+    const tables: Record<string, ExportTable> = {
+      rx: {
+        name: "rx",
+        columns: [
+          ["eye", "Eye"],
+          ["S", "Sphere"],
+          ["C", "Cylinder"],
+          ["Axis", "Axis"],
+          ["VA_logMAR", "VA_logMAR"],
+          ["confidence", "Confidence"],
+        ],
+        rows: (queries) => queries.rxBySession.iterate(sessionId),
+      },
+      events: {
+        name: "event",
+        columns: EVENT_COLUMNS,
+        rows: (queries) => queries.eventsBySession.iterate(sessionId),
+      },
+    };
+
+    const selected = selectTables(tables, req.query.table, format, "rx");
+    if (!selected) {
+      return res.status(400).json({ error: "Invalid table" });
+    }
+
+    streamExport(req, res, `OptiX-${sessionId}`, selected, format);
+  } catch (error: any) {
+    console.error("Export error:", error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
 export default router;
 
@@ -0,0 +1,96 @@
+/**
+ * Typed trial history and trial analytics
+ */
+
+import { Router } from "express";
+import { LOGMAR_STEPS } from "@OptiX/core";
+import { trialQueries } from "../db";
+import { TRIAL_STEPS, TrialRow, decodeTrial, stepName } from "../trials";
+
+const router = Router();
+
+const DAY_MS = 24 * 60 * 60 * 1000;
+const DEFAULT_BUCKET_MS = 250;
+
+/**
+ * GET /api/trials/stats?from=...&to=...&bucketMs=250
+ * Per-logMAR hit rates and per-step latency histograms over a date range
+ * (default: the last 30 days). Registered before /:sessionId.
+ */
+router.get("/stats", (req, res) => {
+  try {
+    const toMs = req.query.to ? Date.parse(String(req.query.to)) : Date.now();
+    const fromMs = req.query.from ? Date.parse(String(req.query.from)) : toMs - 30 * DAY_MS;
+    if (Number.isNaN(fromMs) || Number.isNaN(toMs) || fromMs >= toMs) {
+      return res.status(400).json({ error: "Invalid from/to range" });
+    }
+
+    const bucketMs = Math.floor(Number(req.query.bucketMs)) || DEFAULT_BUCKET_MS;
+    if (bucketMs <= 0) {
+      return res.status(400).json({ error: "Invalid bucketMs" });
+    }
+
+    const acuity = (
+      trialQueries.hitRateBySize.all(TRIAL_STEPS.staircase, TRIAL_STEPS.quest, fromMs, toMs) as Array<{
+        sizeIndex: number;
+        trials: number;
+        correct: number;
+        meanLatencyMs: number | null;
+      }>
+    ).map((row) => ({
+      sizeIndex: row.sizeIndex,
+      logMAR: LOGMAR_STEPS[row.sizeIndex] ?? null,
+      trials: row.trials,
+      hitRate: row.trials > 0 ? row.correct / row.trials : null,
+      meanLatencyMs: row.meanLatencyMs === null ? null : Math.round(row.meanLatencyMs),
+    }));
+
+    const latency = (
+      trialQueries.latencyHistogram.all(
+        bucketMs,
+        bucketMs,
+        TRIAL_STEPS.staircase,
+        TRIAL_STEPS.quest,
+        TRIAL_STEPS.jcc_axis,
+        TRIAL_STEPS.jcc_power,
+        fromMs,
+        toMs
+      ) as Array<{
+        step: number;
+        bucketMs: number;
+        trials: number;
+      }>
+    ).map((row) => ({ step: stepName(row.step), bucketMs: row.bucketMs, trials: row.trials }));
+
+    res.json({
+      from: new Date(fromMs).toISOString(),
+      to: new Date(toMs).toISOString(),
+      bucketMs,
+      acuity,
+      latency,
+    });
+  } catch (error: any) {
+    console.error("Trial stats error:", error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * GET /api/trials/:sessionId
+ * A session's trials in order, codes decoded
+ */
+router.get("/:sessionId", (req, res) => {
+  try {
+    const rows = trialQueries.bySession.all(req.params.sessionId) as TrialRow[];
+
+    res.json({
+      sessionId: req.params.sessionId,
+      trials: rows.map(decodeTrial),
+    });
+  } catch (error: any) {
+    console.error("Trial history error:", error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+export default router;
@@ -2,17 +2,56 @@
  * Voice processing routes (TTS + STT)
  */
 
-import { Router } from "express";
+import { Router, Request, Response } from "express";
 import multer from "multer";
-import { ttsSpeak } from "@OptiX/voice";
+import { pipeline } from "stream";
+import {
+  ttsSpeakCached,
+  getCachedTts,
+  putCachedTts,
+  ttsCacheKey,
+  openTtsStream,
+  CachedAudio,
+} from "@OptiX/voice";
 import { sttGemini, detectIntent } from "@OptiX/voice";
+import { timeStage } from "../metrics";
 
 const router = Router();
 const upload = multer({ storage: multer.memoryStorage() });
 
 /**
- * POST /api/tts
- * Text-to-speech via ElevenLabs
+ * TTS through the cache, timed per tier (memory/disk/origin/mock)
+ */
+function speak(text: string, voiceId?: string): Promise<CachedAudio> {
+  return timeStage("ttsSpeak", () => ttsSpeakCached(text, { voiceId }), (result) => result.tier);
+}
+
+/**
+ * Send cached audio; content-addressed keys make real audio immutable
+ */
+function sendAudio(req: Request, res: Response, result: CachedAudio) {
+  res.set("Content-Type", "audio/mpeg");
+  res.set("X-TTS-Cache", result.tier);
+
+  if (result.tier === "mock") {
+    res.set("Cache-Control", "no-store");
+    return res.send(result.audio);
+  }
+
+  const etag = `"${result.key}"`;
+  res.set("ETag", etag);
+  res.set("Cache-Control", "public, max-age=31536000, immutable");
+  res.set("Content-Location", `/api/voice/tts/${result.key}`);
+
+  if (req.headers["if-none-match"] === etag) {
+    return res.status(304).end();
+  }
+  return res.send(result.audio);
+}
+
+/**
+ * POST /api/voice/tts
+ * Text-to-speech via ElevenLabs, served through the TTS cache
  */
 router.post("/tts", async (req, res) => {
   try {
@@ -22,12 +61,83 @@ router.post("/tts", async (req, res) => {
       return res.status(400).json({ error: "Missing text" });
     }
 
-    const audioBuffer = await ttsSpeak(text, { voiceId });
+    const result = await speak(text, voiceId);
+    sendAudio(req, res, result);
+  } catch (error: any) {
+    console.error("TTS error:", error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * POST /api/voice/tts/stream
+ * Streaming text-to-speech: ElevenLabs chunks are piped straight into a
+ * chunked response. Cache hits (and mock audio) are sent in one piece; a
+ * completed stream is stored in the TTS cache on the way through.
+ */
+router.post("/tts/stream", async (req, res) => {
+  try {
+    const { text, voiceId } = req.body;
+
+    if (!text) {
+      return res.status(400).json({ error: "Missing text" });
+    }
+
+    const key = ttsCacheKey(text, { voiceId });
+    const cached = await getCachedTts(key);
+    if (cached || !process.env.ELEVENLABS_API_KEY) {
+      return sendAudio(req, res, cached ?? (await speak(text, voiceId)));
+    }
+
+    let upstream: NodeJS.ReadableStream;
+    try {
+      upstream = await timeStage("ttsStreamOpen", () => openTtsStream(text, { voiceId }));
+    } catch (error) {
+      console.error("ElevenLabs TTS stream error:", error);
+      return sendAudio(req, res, await speak(text, voiceId));
+    }
 
     res.set("Content-Type", "audio/mpeg");
-    res.send(Buffer.from(audioBuffer));
+    res.set("Cache-Control", "no-store");
+    res.set("X-TTS-Cache", "stream");
+    res.set("X-TTS-Key", key);
+    res.flushHeaders();
+
+    const chunks: Buffer[] = [];
+    upstream.on("data", (chunk: Buffer) => chunks.push(chunk));
+
+    pipeline(upstream, res, (error) => {
+      if (error) {
+        console.error("TTS stream aborted:", error.message);
+        return;
+      }
+      putCachedTts(key, Buffer.concat(chunks)).catch(() => {});
+    });
   } catch (error: any) {
-    console.error("TTS error:", error);
+    console.error("TTS stream error:", error);
+    if (!res.headersSent) {
+      res.status(500).json({ error: error.message });
+    } else {
+      res.destroy(error);
+    }
+  }
+});
+
+/**
+ * GET /api/voice/tts/:key
+ * Fetch previously synthesized audio by its content hash
+ */
+router.get("/tts/:key", async (req, res) => {
+  try {
+    const result = await getCachedTts(req.params.key);
+
+    if (!result) {
+      return res.status(404).json({ error: "Audio not cached" });
+    }
+
+    sendAudio(req, res, result);
+  } catch (error: any) {
+    console.error("TTS cache lookup error:", error);
     res.status(500).json({ error: error.message });
   }
 });
@@ -45,7 +155,7 @@ router.post("/stt", upload.single("audio"), async (req, res) => {
     // Convert buffer to base64
     const audioBase64 = req.file.buffer.toString("base64");
 
-    const result = await sttGemini(audioBase64);
+    const result = await timeStage("sttGemini", () => sttGemini(audioBase64));
 
     res.json({
       success: true,
@@ -64,13 +174,15 @@ router.post("/stt", upload.single("audio"), async (req, res) => {
  */
 router.post("/intent", async (req, res) => {
   try {
-    const { text } = req.body;
+    const { text, expect } = req.body;
 
     if (!text) {
       return res.status(400).json({ error: "Missing text" });
     }
 
-    const intent = await detectIntent(text);
+    // Optional hint from the current step: "letters", "choice" or "command"
+    const expected = ["letters", "choice", "command"].includes(expect) ? expect : undefined;
+    const intent = await detectIntent(text, expected);
 
     res.json(intent);
   } catch (error: any) {
@@ -0,0 +1,80 @@
+/**
+ * Minimal Server-Sent Events hub
+ * Clients subscribe to a named channel; publishers push JSON events to it.
+ */
+
+import { Response } from "express";
+
+const HEARTBEAT_MS = 15000;
+
+export class SseHub {
+  private channels = new Map<string, Set<Response>>();
+  private heartbeat: NodeJS.Timeout | null = null;
+
+  /**
+   * Attach an HTTP response as a subscriber of a channel
+   */
+  subscribe(channel: string, res: Response): void {
+    res.set({
+      "Content-Type": "text/event-stream",
+      "Cache-Control": "no-cache, no-transform",
+      Connection: "keep-alive",
+      "X-Accel-Buffering": "no",
+    });
+    res.flushHeaders();
+    res.write("retry: 2000\n\n");
+
+    let subscribers = this.channels.get(channel);
+    if (!subscribers) {
+      subscribers = new Set();
+      this.channels.set(channel, subscribers);
+    }
+    subscribers.add(res);
+    this.startHeartbeat();
+
+    res.on("close", () => {
+      subscribers!.delete(res);
+      if (subscribers!.size === 0) {
+        this.channels.delete(channel);
+      }
+    });
+  }
+
+  /**
+   * Push an event to every subscriber of a channel
+   */
+  publish(channel: string, event: string, data: unknown): number {
+    const subscribers = this.channels.get(channel);
+    if (!subscribers) return 0;
+
+    const frame = `event: ${event}\ndata: ${JSON.stringify(data)}\n\n`;
+    for (const res of subscribers) {
+      res.write(frame);
+    }
+    return subscribers.size;
+  }
+
+  /**
+   * Send an event to a single subscriber (e.g. the current state on connect)
+   */
+  send(res: Response, event: string, data: unknown): void {
+    res.write(`event: ${event}\ndata: ${JSON.stringify(data)}\n\n`);
+  }
+
+  private startHeartbeat() {
+    if (this.heartbeat) return;
+    this.heartbeat = setInterval(() => {
+      if (this.channels.size === 0) {
+        clearInterval(this.heartbeat!);
+        this.heartbeat = null;
+        return;
+      }
+      for (const subscribers of this.channels.values()) {
+        for (const res of subscribers) {
+          res.write(": ping\n\n");
+        }
+      }
+    }, HEARTBEAT_MS);
+    this.heartbeat.unref();
+  }
+}
@@ -0,0 +1,105 @@
+/**
+ * Typed trial history
+ *
+ * Every staircase/QUEST+/JCC trial is stored as one row of small typed
+ * columns (codes below) alongside the free-form events log, so analytics
+ * aggregate over indexed columns instead of JSON-parsing events.params.
+ * Writes are fire-and-forget through the writer thread.
+ */
+
+import { dbWriter } from "./dbWriter";
+
+export const TRIAL_STEPS = {
+  staircase: 1,
+  quest: 2,
+  jcc_axis: 3,
+  jcc_power: 4,
+} as const;
+
+export type TrialStepName = keyof typeof TRIAL_STEPS;
+
+const STEP_NAMES = Object.fromEntries(
+  Object.entries(TRIAL_STEPS).map(([name, code]) => [code, name])
+) as Record<number, TrialStepName>;
+
+const EYES = ["OD", "OS"] as const;
+
+export interface TrialRow {
+  id: number;
+  sessionId: string;
+  t: number;
+  eye: number;
+  step: number;
+  sizeIndex: number | null;
+  correct: number | null;
+  latencyMs: number | null;
+  axisDeg: number | null;
+  cyl: number | null;
+  choice: number | null;
+}
+
+function eyeCode(eye: string): number {
+  return eye === "OS" ? 1 : 0;
+}
+
+/**
+ * Record an acuity trial: the LOGMAR_STEPS index shown and the answer
+ */
+export function recordAcuityTrial(
+  sessionId: string,
+  eye: string,
+  engine: "staircase" | "quest",
+  sizeIndex: number,
+  correct: boolean,
+  latencyMs?: number
+): void {
+  dbWriter.enqueue([
+    "trials.create",
+    [sessionId, Date.now(), eyeCode(eye), TRIAL_STEPS[engine], sizeIndex, correct ? 1 : 0, latencyMs ?? null, null, null, null],
+  ]);
+}
+
+/**
+ * Record a JCC trial: the axis/cylinder under test and the choice made
+ */
+export function recordJccTrial(
+  sessionId: string,
+  eye: string,
+  stage: "axis" | "power",
+  axisDeg: number,
+  cyl: number,
+  choice: 1 | 2,
+  latencyMs?: number
+): void {
+  dbWriter.enqueue([
+    "trials.create",
+    [
+      sessionId,
+      Date.now(),
+      eyeCode(eye),
+      stage === "axis" ? TRIAL_STEPS.jcc_axis : TRIAL_STEPS.jcc_power,
+      null,
+      null,
+      latencyMs ?? null,
+      axisDeg,
+      cyl,
+      choice,
+    ],
+  ]);
+}
+
+/**
+ * Row with its codes decoded, for API responses
+ */
+export function decodeTrial(row: TrialRow) {
+  return {
+    ...row,
+    eye: EYES[row.eye] ?? "OD",
+    step: STEP_NAMES[row.step] ?? "unknown",
+    correct: row.correct === null ? null : row.correct === 1,
+  };
+}
+
+export function stepName(code: number): TrialStepName | "unknown" {
+  return STEP_NAMES[code] ?? "unknown";
+}
@@ -0,0 +1,91 @@
+/**
+ * SQL for every write that goes through the writer thread
+ *
+ * Shared by db.ts (main-thread statements, used when the writer is off and
+ * for the exit-time fallback) and dbWriterWorker.ts, so both connections
+ * always run identical statements.
+ */
+
+export const WRITE_SQL = {
+  "sessions.create": `
+    INSERT INTO sessions (id, createdAt, createdAtMs, deviceInfo, distanceCm, screenPpi, lighting, state)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+  `,
+
+  "sessions.updateState": "UPDATE sessions SET state = ? WHERE id = ?",
+
+  "events.create": `
+    INSERT INTO events (sessionId, t, step, lettersShown, speechText, correct, latencyMs, params)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+  `,
+
+  "trials.create": `
+    INSERT INTO trials (sessionId, t, eye, step, sizeIndex, correct, latencyMs, axisDeg, cyl, choice)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+  `,
+
+  "rx.upsert": `
+    INSERT INTO rx (sessionId, eye, S, C, Axis, VA_logMAR, confidence)
+    VALUES (?, ?, ?, ?, ?, ?, ?)
+    ON CONFLICT(sessionId, eye) DO UPDATE SET
+      S = excluded.S,
+      C = excluded.C,
+      Axis = excluded.Axis,
+      VA_logMAR = excluded.VA_logMAR,
+      confidence = excluded.confidence
+  `,
+
+  "examState.upsert": `
+    INSERT INTO exam_state (sessionId, eye, kind, state, updatedAt)
+    VALUES (?, ?, ?, ?, ?)
+    ON CONFLICT(sessionId, eye, kind) DO UPDATE SET
+      state = excluded.state,
+      updatedAt = excluded.updatedAt
+  `,
+
+  "conversations.upsert": `
+    INSERT INTO conversations (key, conversationId, expiresAt)
+    VALUES (?, ?, ?)
+    ON CONFLICT(key) DO UPDATE SET
+      conversationId = excluded.conversationId,
+      expiresAt = excluded.expiresAt
+  `,
+
+  // (expiresAt, key, now)
+  "conversations.touch":
+    "UPDATE conversations SET expiresAt = ? WHERE key = ? AND expiresAt > ? RETURNING conversationId",
+
+  "conversations.delete": "DELETE FROM conversations WHERE key = ? RETURNING conversationId",
+
+  "conversations.claimExpired": "DELETE FROM conversations WHERE expiresAt <= ? RETURNING key, conversationId",
+} as const;
+
+export type WriteStatement = keyof typeof WRITE_SQL;
+
+/**
+ * One statement execution: [statement, params]
+ */
+export type WriteOp = [WriteStatement, unknown[]];
+
+/**
+ * RETURNING rows of each op in a unit ([] for ops that return none)
+ */
+export type WriteRows = unknown[][];
+
+/**
+ * Messages between dbWriter (main thread) and dbWriterWorker
+ * A unit is committed atomically; units are grouped into one transaction.
+ * A `returning` unit gets its rows back with the commit acknowledgement.
+ */
+export interface WriteUnit {
+  id: number;
+  ops: WriteOp[];
+  returning?: boolean;
+}
+
+export type ToWriter = { type: "units"; units: WriteUnit[] } | { type: "close" };
+
+export type FromWriter =
+  | { type: "committed"; ids: number[]; ms: number; size: number; rows: Record<number, WriteRows> }
+  | { type: "failed"; id: number; error: string; code?: string }
+  | { type: "closed" };
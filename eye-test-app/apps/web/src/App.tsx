@@ -2,6 +2,7 @@ import { BrowserRouter as Router, Routes, Route } from 'react-router-dom';
 import { AIProvider } from './contexts/AIContext';
 import Header from './components/Header';
 import GlobalAIAssistant from './components/GlobalAIAssistant';
+import RenderProfiler from './components/RenderProfiler';
 import Home from './pages/Home';
 import Calibration from './pages/Calibration';
 import SphereTest from './pages/SphereTest';
@@ -15,17 +16,22 @@ function App() {
         <div style={{ minHeight: '100vh', display: 'flex', flexDirection: 'column' }}>
           <Header />
           <main style={{ flex: 1 }}>
-            <Routes>
-              <Route path="/" element={<Home />} />
-              <Route path="/calibration" element={<Calibration />} />
-              <Route path="/sphere" element={<SphereTest />} />
-              <Route path="/jcc" element={<JCCTest />} />
-              <Route path="/summary" element={<Summary />} />
-            </Routes>
+            {/* Dev builds count renders per subtree: chat updates shouldn't show up under "exam" */}
+            <RenderProfiler id="exam">
+              <Routes>
+                <Route path="/" element={<Home />} />
+                <Route path="/calibration" element={<Calibration />} />
+                <Route path="/sphere" element={<SphereTest />} />
+                <Route path="/jcc" element={<JCCTest />} />
+                <Route path="/summary" element={<Summary />} />
+              </Routes>
+            </RenderProfiler>
           </main>
           
           {/* Global AI Assistant - SDK-based conversation */}
-          <GlobalAIAssistant />
+          <RenderProfiler id="assistant">
+            <GlobalAIAssistant />
+          </RenderProfiler>
         </div>
       </AIProvider>
     </Router>
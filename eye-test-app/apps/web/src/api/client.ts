@@ -2,13 +2,73 @@
  * API client for backend communication
  */
 
-const API_BASE = (import.meta as any).env?.VITE_API_URL || 'http://localhost:8787';
+// Set VITE_API_URL at build time when the API isn't on the default port
+const API_BASE = import.meta.env.VITE_API_URL || 'http://localhost:8787';
+
+// Events are buffered and sent to /api/event/batch in one request
+const EVENT_BATCH_SIZE = 25;
+const EVENT_FLUSH_MS = 2000;
+const EVENT_QUEUE_LIMIT = 1000;
+const EVENT_BATCH_MAX = 500; // The API answers 413 above this
+// keepalive fetches and beacons share a ~64 KB in-flight body quota
+const EVENT_BATCH_MAX_BYTES = 60 * 1024;
+
+interface EventBatch {
+  events: any[];
+  body: string;
+  bytes: number;
+}
+
+const encoder = new TextEncoder();
+
+/**
+ * Serialize queued events into batch bodies within the count and byte limits
+ * An event too large for the byte limit on its own goes out as its own batch.
+ */
+function eventBatches(events: any[]): EventBatch[] {
+  const batches: EventBatch[] = [];
+  const envelopeBytes = '{"events":[]}'.length;
+  let pending: any[] = [];
+  let json: string[] = [];
+  let bytes = envelopeBytes;
+
+  const close = () => {
+    if (pending.length === 0) return;
+    batches.push({ events: pending, body: `{"events":[${json.join(',')}]}`, bytes });
+    pending = [];
+    json = [];
+    bytes = envelopeBytes;
+  };
+
+  for (const event of events) {
+    const serialized = JSON.stringify(event);
+    const size = encoder.encode(serialized).length + 1; // + separator
+    if (pending.length >= EVENT_BATCH_MAX || (pending.length > 0 && bytes + size > EVENT_BATCH_MAX_BYTES)) {
+      close();
+    }
+    pending.push(event);
+    json.push(serialized);
+    bytes += size;
+  }
+  close();
+  return batches;
+}
 
 class APIClient {
   private baseURL: string;
+  private eventQueue: any[] = [];
+  private eventFlushTimer: ReturnType<typeof setTimeout> | null = null;
 
   constructor(baseURL: string) {
     this.baseURL = baseURL;
+
+    // Page may be closed or frozen when hidden, so hand the queue to the beacon
+    if (typeof document !== 'undefined') {
+      document.addEventListener('visibilitychange', () => {
+        if (document.visibilityState === 'hidden') this.flushEventsBeacon();
+      });
+      window.addEventListener('pagehide', () => this.flushEventsBeacon());
+    }
   }
 
   async request<T>(
@@ -53,11 +113,70 @@ class APIClient {
   }
 
   // Events
-  async logEvent(event: any) {
-    return this.request<any>('/api/event', {
-      method: 'POST',
-      body: JSON.stringify(event),
-    });
+  logEvent(event: any) {
+    this.eventQueue.push(event);
+
+    if (this.eventQueue.length >= EVENT_BATCH_SIZE) {
+      void this.flushEvents();
+    } else if (!this.eventFlushTimer) {
+      this.eventFlushTimer = setTimeout(() => void this.flushEvents(), EVENT_FLUSH_MS);
+    }
+  }
+
+  async flushEvents() {
+    if (this.eventFlushTimer) {
+      clearTimeout(this.eventFlushTimer);
+      this.eventFlushTimer = null;
+    }
+    if (this.eventQueue.length === 0) return;
+
+    const batches = eventBatches(this.eventQueue.splice(0, this.eventQueue.length));
+    for (let i = 0; i < batches.length; i++) {
+      const batch = batches[i];
+      let status = 0;
+      try {
+        const response = await fetch(`${this.baseURL}/api/event/batch`, {
+          method: 'POST',
+          headers: { 'Content-Type': 'application/json' },
+          body: batch.body,
+          keepalive: batch.bytes <= EVENT_BATCH_MAX_BYTES,
+        });
+        status = response.status;
+      } catch (error) {
+        console.warn('⚠️ Event batch failed, will retry:', error);
+      }
+
+      if (status >= 200 && status < 300) continue;
+      if (status >= 400 && status < 500) {
+        // Retrying a batch the API rejected would only wedge the queue
+        console.warn(`⚠️ Event batch rejected (HTTP ${status}), dropping ${batch.events.length} events`);
+        continue;
+      }
+
+      // Network error or 5xx: put this and the unsent batches back in front,
+      // dropping the oldest if we are backed up
+      const unsent = batches.slice(i).flatMap((remaining) => remaining.events);
+      this.eventQueue = [...unsent, ...this.eventQueue].slice(-EVENT_QUEUE_LIMIT);
+      if (!this.eventFlushTimer) {
+        this.eventFlushTimer = setTimeout(() => void this.flushEvents(), EVENT_FLUSH_MS);
+      }
+      return;
+    }
+  }
+
+  private flushEventsBeacon() {
+    if (this.eventQueue.length === 0 || typeof navigator.sendBeacon !== 'function') return;
+
+    // text/plain keeps the beacon a simple CORS request; the API parses it as JSON
+    const batches = eventBatches(this.eventQueue.splice(0, this.eventQueue.length));
+    for (let i = 0; i < batches.length; i++) {
+      const payload = new Blob([batches[i].body], { type: 'text/plain' });
+      if (!navigator.sendBeacon(`${this.baseURL}/api/event/batch`, payload)) {
+        // Over the beacon quota: keep the rest for the next flush (if the page survives)
+        this.eventQueue.unshift(...batches.slice(i).flatMap((remaining) => remaining.events));
+        return;
+      }
+    }
   }
 
   // Voice
@@ -93,40 +212,40 @@ class APIClient {
     return response.json();
   }
 
-  async detectIntent(text: string) {
+  async detectIntent(text: string, expect?: 'letters' | 'choice' | 'command') {
     return this.request<any>('/api/voice/intent', {
       method: 'POST',
-      body: JSON.stringify({ text }),
+      body: JSON.stringify({ text, expect }),
     });
   }
 
-  // Staircase
-  async initStaircase(eye: string, startIndex?: number) {
+  // Staircase (state is held server-side per session + eye)
+  async initStaircase(sessionId: string, eye: string, startIndex?: number) {
     return this.request<any>('/api/staircase/init', {
       method: 'POST',
-      body: JSON.stringify({ eye, startIndex }),
+      body: JSON.stringify({ sessionId, eye, startIndex }),
     });
   }
 
-  async nextStaircase(state: any, wasCorrect: boolean, latencyMs: number) {
+  async nextStaircase(sessionId: string, eye: string, wasCorrect: boolean, latencyMs?: number, sizeIndex?: number) {
     return this.request<any>('/api/staircase/next', {
       method: 'POST',
-      body: JSON.stringify({ state, wasCorrect, latencyMs }),
+      body: JSON.stringify({ sessionId, eye, wasCorrect, latencyMs, sizeIndex }),
     });
   }
 
   // JCC
-  async initJCC(eye: string, startAxis?: number) {
+  async initJCC(sessionId: string, eye: string, startAxis?: number) {
     return this.request<any>('/api/jcc/init', {
       method: 'POST',
-      body: JSON.stringify({ eye, startAxis }),
+      body: JSON.stringify({ sessionId, eye, startAxis }),
     });
   }
 
-  async nextJCC(state: any, choice: 1 | 2, latencyMs: number) {
+  async nextJCC(sessionId: string, eye: string, choice: 1 | 2, latencyMs?: number) {
     return this.request<any>('/api/jcc/next', {
       method: 'POST',
-      body: JSON.stringify({ state, choice, latencyMs }),
+      body: JSON.stringify({ sessionId, eye, choice, latencyMs }),
     });
   }
 
@@ -188,6 +307,24 @@ class APIClient {
   }
 
   // Agent - xAI Analysis
+  // Exam progression for an examiner message (decided server-side, see /api/agent/decide)
+  async decideAgent(
+    message: string,
+    currentState: { stage: string; currentEye?: string },
+    availableTools: Array<{ name: string; description: string; parameters: Record<string, any> }>
+  ) {
+    return this.request<{
+      success: boolean;
+      toolCalls: Array<{ name: string; parameters: Record<string, any> }>;
+      reasoning?: string;
+      engine?: 'local' | 'grok';
+      ambiguous?: boolean;
+    }>('/api/agent/decide', {
+      method: 'POST',
+      body: JSON.stringify({ message, currentState, availableTools }),
+    });
+  }
+
   async analyzeResponse(data: {
     patientSpeech: string;
     expectedLetters: string;
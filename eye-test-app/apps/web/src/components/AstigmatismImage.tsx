@@ -1,4 +1,6 @@
 import { useMemo } from 'react';
+import DialCanvas from './DialCanvas';
+import type { DialSpec } from '../services/dialLayers';
 
 interface AstigmatismImageProps {
   scale?: number;
@@ -35,38 +37,53 @@ export default function AstigmatismImage({ scale = 1 }: AstigmatismImageProps) {
   );
 }
 
-function RadialPattern() {
+// Static dials: rendered once into a cached layer (see dialLayers)
+const RADIAL_DIAL: DialSpec = {
+  size: 400,
+  radius: 150,
+  lines: Array.from({ length: 12 }, (_, i) => ({ angleDeg: i * 30 })),
+  strokeWidth: 3,
+  color: '#fff',
+  hubRadius: 20,
+  hubColor: '#fff',
+  background: '#000',
+};
+
+const FAN_DIAL: DialSpec = {
+  size: 400,
+  radius: 150,
+  lines: Array.from({ length: 24 }, (_, i) => ({ angleDeg: i * 15 })),
+  strokeWidth: 2,
+  color: '#fff',
+  lineCap: 'round',
+  hubRadius: 15,
+  hubColor: '#fff',
+  background: '#000',
+};
+
+function DialPattern({ spec, caption }: { spec: DialSpec; caption: string }) {
   return (
-    <svg width="400" height="400" viewBox="0 0 400 400">
-      <rect width="400" height="400" fill="#000" />
-      <g transform="translate(200, 200)">
-        {/* Clock dial - 12 radial lines */}
-        {Array.from({ length: 12 }).map((_, i) => {
-          const angle = (i * 30 * Math.PI) / 180;
-          const x2 = Math.cos(angle) * 150;
-          const y2 = Math.sin(angle) * 150;
-          return (
-            <line
-              key={i}
-              x1="0"
-              y1="0"
-              x2={x2}
-              y2={y2}
-              stroke="#fff"
-              strokeWidth="3"
-            />
-          );
-        })}
-        {/* Center circle */}
-        <circle r="20" fill="#fff" />
-      </g>
-      <text x="200" y="380" textAnchor="middle" fill="#888" fontSize="14">
-        Focus on the center. Do all lines appear equally sharp?
-      </text>
-    </svg>
+    <div style={{ position: 'relative', width: `${spec.size}px`, height: `${spec.size}px` }}>
+      <DialCanvas spec={spec} />
+      <div style={{
+        position: 'absolute',
+        left: 0,
+        right: 0,
+        bottom: '16px',
+        textAlign: 'center',
+        color: '#888',
+        fontSize: '14px',
+      }}>
+        {caption}
+      </div>
+    </div>
   );
 }
 
+function RadialPattern() {
+  return <DialPattern spec={RADIAL_DIAL} caption="Focus on the center. Do all lines appear equally sharp?" />;
+}
+
 function CrossPattern() {
   return (
     <svg width="400" height="400" viewBox="0 0 400 400">
@@ -103,36 +120,5 @@ function CrossPattern() {
 }
 
 function FanPattern() {
-  return (
-    <svg width="400" height="400" viewBox="0 0 400 400">
-      <rect width="400" height="400" fill="#000" />
-      <g transform="translate(200, 200)">
-        {/* Fan of lines at different angles */}
-        {Array.from({ length: 24 }).map((_, i) => {
-          const angle = (i * 15 * Math.PI) / 180;
-          const x2 = Math.cos(angle) * 150;
-          const y2 = Math.sin(angle) * 150;
-          return (
-            <line
-              key={i}
-              x1="0"
-              y1="0"
-              x2={x2}
-              y2={y2}
-              stroke="#fff"
-              strokeWidth="2"
-              strokeLinecap="round"
-            />
-          );
-        })}
-        <circle r="15" fill="#fff" />
-      </g>
-      <text x="200" y="380" textAnchor="middle" fill="#888" fontSize="14">
-        Which section appears clearest?
-      </text>
-    </svg>
-  );
+  return <DialPattern spec={FAN_DIAL} caption="Which section appears clearest?" />;
 }
-
-
-
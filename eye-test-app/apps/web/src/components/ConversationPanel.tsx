@@ -1,25 +1,20 @@
 import { useState, useEffect, useRef } from 'react';
-
-export interface ConversationMessage {
-  id: string;
-  type: 'user' | 'agent';
-  text: string;
-  timestamp: number;
-}
+import { useShallow } from 'zustand/react/shallow';
+import { useVoiceStore } from '../store/voiceStore';
 
 interface ConversationPanelProps {
-  messages: ConversationMessage[];
-  isListening: boolean;
-  isAgentSpeaking: boolean;
   onClose: () => void;
 }
 
-export default function ConversationPanel({
-  messages,
-  isListening,
-  isAgentSpeaking,
-  onClose,
-}: ConversationPanelProps) {
+export default function ConversationPanel({ onClose }: ConversationPanelProps) {
+  // Subscribes to voice state itself, so chat updates re-render only this panel
+  const { messages, isListening, isAgentSpeaking } = useVoiceStore(
+    useShallow((state) => ({
+      messages: state.messages,
+      isListening: state.isListening,
+      isAgentSpeaking: state.isAgentSpeaking,
+    }))
+  );
   const [isMinimized, setIsMinimized] = useState(false);
   const messagesEndRef = useRef<HTMLDivElement>(null);
 
@@ -0,0 +1,39 @@
+import { useEffect, useLayoutEffect, useRef } from 'react';
+import { DialSpec, dialLayer } from '../services/dialLayers';
+
+interface DialCanvasProps {
+  spec: DialSpec;
+  prefetch?: DialSpec[]; // Layers to have ready for the next swap (e.g. the other JCC choice)
+}
+
+/**
+ * Radial dial blitted from a cached layer
+ *
+ * Drawn in a layout effect, so a swap lands in the same frame as the
+ * React commit (and the frame stimulusTiming reports as onset).
+ */
+export default function DialCanvas({ spec, prefetch }: DialCanvasProps) {
+  const canvasRef = useRef<HTMLCanvasElement>(null);
+
+  useLayoutEffect(() => {
+    const canvas = canvasRef.current;
+    const ctx = canvas?.getContext('2d');
+    if (!canvas || !ctx) return;
+
+    const dpr = window.devicePixelRatio || 1;
+    const layer = dialLayer(spec, dpr);
+    if (canvas.width !== layer.width || canvas.height !== layer.height) {
+      canvas.width = layer.width;
+      canvas.height = layer.height;
+    }
+    ctx.drawImage(layer, 0, 0);
+  }, [spec]);
+
+  // After paint, so rendering upcoming layers never delays this one
+  useEffect(() => {
+    const dpr = window.devicePixelRatio || 1;
+    prefetch?.forEach((next) => dialLayer(next, dpr));
+  }, [prefetch]);
+
+  return <canvas ref={canvasRef} style={{ width: `${spec.size}px`, height: `${spec.size}px` }} />;
+}
@@ -1,9 +1,10 @@
 import { useEffect, useState, useRef } from 'react';
 import { useNavigate } from 'react-router-dom';
 import { useAI } from '../contexts/AIContext';
-import { useTestStore } from '../store/testStore';
+import { useTestStore, useTestSlice } from '../store/testStore';
+import { type ConversationMessage, useVoiceStore } from '../store/voiceStore';
 import { useAIAgent } from '../hooks/useAIAgent';
-import ConversationPanel, { ConversationMessage } from './ConversationPanel';
+import ConversationPanel from './ConversationPanel';
 import { SimpleConversationFlow } from '../services/simpleConversationFlow';
 import { ConversationOrchestrator } from '../services/conversationOrchestrator';
 
@@ -14,15 +15,20 @@ interface GlobalAIAssistantProps {
 export default function GlobalAIAssistant({ agentId: providedAgentId }: GlobalAIAssistantProps) {
   const navigate = useNavigate();
   const { isAIActive } = useAI();
-  const { stage, currentEye, setElevenLabsReady, addPatientTranscription, addXAIAnalysis, setCurrentTestLine, setCurrentEye, setSphereResult, setStage } = useTestStore();
+  const { stage, currentEye, setElevenLabsReady, setCurrentTestLine, setCurrentEye, setSphereResult, setStage } = useTestSlice(
+    'stage',
+    'currentEye',
+    'setElevenLabsReady',
+    'setCurrentTestLine',
+    'setCurrentEye',
+    'setSphereResult',
+    'setStage'
+  );
   const { startAgent, agentThinking, executeManualAction, lastMessage } = useAIAgent();
   const [lastStage, setLastStage] = useState(stage);
   const [showManualControls, setShowManualControls] = useState(false);
   
-  // Conversation state
-  const [messages, setMessages] = useState<ConversationMessage[]>([]);
-  const [isListening, setIsListening] = useState(false);
-  const [isAgentSpeaking, setIsAgentSpeaking] = useState(false);
+  // Conversation state lives in useVoiceStore; only ConversationPanel subscribes to it
   const [showPanel, setShowPanel] = useState(false);
   
   // Simple conversation flow (ElevenLabs + Web Speech API + xAI)
@@ -93,33 +99,36 @@ export default function GlobalAIAssistant({ agentId: providedAgentId }: GlobalAI
       // Create conversation flow
       const conversation = new SimpleConversationFlow({
         onAgentSpeaking: (speaking) => {
-          setIsAgentSpeaking(speaking);
+          useVoiceStore.getState().setAgentSpeaking(speaking);
           console.log(speaking ? '🗣️ Agent speaking' : '✅ Agent finished');
         },
         onListening: (listening) => {
-          setIsListening(listening);
+          useVoiceStore.getState().setListening(listening);
           console.log(listening ? '👂 Listening for user' : '🛑 Stopped listening');
         },
         onMessage: (message) => {
           console.log(`💬 ${message.type}: "${message.text}"`);
           
           // Add to conversation panel
+          const voice = useVoiceStore.getState();
           const msg: ConversationMessage = {
             id: `${message.type}-${Date.now()}-${Math.random().toString(36).substr(2, 9)}`,
             type: message.type,
             text: message.text,
             timestamp: Date.now(),
           };
-          setMessages(prev => [...prev, msg]);
+          voice.addMessage(msg);
           
           // Store user transcriptions
           if (message.type === 'user') {
-            addPatientTranscription({
+            // Read at call time: this callback outlives the render that created it
+            const exam = useTestStore.getState();
+            voice.addPatientTranscription({
               timestamp: msg.timestamp,
               text: msg.text,
-              eye: currentEye,
+              eye: exam.currentEye,
               line: orchestratorRef.current?.getState().currentLine || 1,
-              stage: stage,
+              stage: exam.stage,
             });
             
             // Handle user response through orchestrator
@@ -136,6 +145,7 @@ export default function GlobalAIAssistant({ agentId: providedAgentId }: GlobalAI
       // Create orchestrator (xAI brain)
       const orchestrator = new ConversationOrchestrator({
         conversation,
+        getSessionId: () => useTestStore.getState().sessionId,
         onLineAdvance: (line) => {
           console.log(`⬇️ Advancing to line ${line}`);
           setCurrentTestLine(line);
@@ -189,11 +199,11 @@ export default function GlobalAIAssistant({ agentId: providedAgentId }: GlobalAI
         },
         onXAIAnalysis: (analysis) => {
           console.log('🧠 xAI Analysis:', analysis);
-          addXAIAnalysis({
+          useVoiceStore.getState().addXAIAnalysis({
             timestamp: Date.now(),
             patientSpeech: analysis.patientSpeech || '',
             expectedLetters: analysis.expectedLetters || '',
-            eye: currentEye,
+            eye: useTestStore.getState().currentEye,
             line: orchestratorRef.current?.getState().currentLine || 1,
             correct: analysis.correct,
             confidence: analysis.confidence,
@@ -235,12 +245,7 @@ export default function GlobalAIAssistant({ agentId: providedAgentId }: GlobalAI
     <>
       {/* Conversation Panel */}
       {showPanel && (
-        <ConversationPanel
-          messages={messages}
-          isListening={isListening}
-          isAgentSpeaking={isAgentSpeaking}
-          onClose={handleClosePanel}
-        />
+        <ConversationPanel onClose={handleClosePanel} />
       )}
 
       {/* Agent thinking indicator */}
@@ -1,7 +1,7 @@
-import { useTestStore } from '../store/testStore';
+import { useTestSlice } from '../store/testStore';
 
 export default function Header() {
-  const { stage } = useTestStore();
+  const { stage } = useTestSlice('stage');
 
   const getStageLabel = () => {
     switch (stage) {
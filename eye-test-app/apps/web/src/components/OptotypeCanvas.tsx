@@ -1,57 +1,142 @@
-import { useEffect, useRef } from 'react';
+import { useEffect, useRef, useState } from 'react';
+import { ATLAS_PADDING, glyphOffset } from '../services/sloanGlyphs';
+import { deviceSize, glyphAtlas } from '../services/glyphAtlas';
 
 interface OptotypeCanvasProps {
   letters: string[];
-  sizePx: number;
+  sizePx: number; // CSS px, from calculateLetterSize()
   spacing?: number;
+  height?: number; // CSS px
+  prefetchSizesPx?: number[]; // CSS px sizes to rasterize ahead (e.g. every logMAR step)
+  onPresented?: (onsetMs: number, letters: string[]) => void; // performance.now() timebase
 }
 
-export default function OptotypeCanvas({ letters, sizePx, spacing = 1.5 }: OptotypeCanvasProps) {
+interface Backing {
+  width: number; // Device px
+  height: number;
+  dpr: number;
+}
+
+const BACKGROUND = '#0a0a0b';
+
+/**
+ * Sloan line blitted from a pre-rasterized atlas at exact device-pixel size
+ *
+ * The backing store tracks the element's device-pixel box, so letters are
+ * never resampled by CSS scaling. A new line is drawn in a single
+ * requestAnimationFrame callback once its atlas is ready, and that frame's
+ * timestamp is reported as stimulus onset.
+ */
+export default function OptotypeCanvas({
+  letters,
+  sizePx,
+  spacing = 1.5,
+  height = 400,
+  prefetchSizesPx,
+  onPresented,
+}: OptotypeCanvasProps) {
   const canvasRef = useRef<HTMLCanvasElement>(null);
+  const onPresentedRef = useRef(onPresented);
+  const [backing, setBacking] = useState<Backing | null>(null);
 
+  onPresentedRef.current = onPresented;
+
+  // Match the backing store to the device-pixel content box
   useEffect(() => {
     const canvas = canvasRef.current;
     if (!canvas) return;
 
-    const ctx = canvas.getContext('2d');
-    if (!ctx) return;
+    const observer = new ResizeObserver(([entry]) => {
+      const dpr = window.devicePixelRatio || 1;
+      const box = entry.devicePixelContentBoxSize?.[0];
+      const width = box ? box.inlineSize : Math.round(entry.contentRect.width * dpr);
+      const height = box ? box.blockSize : Math.round(entry.contentRect.height * dpr);
 
-    // Clear canvas
-    ctx.fillStyle = '#0a0a0b';
-    ctx.fillRect(0, 0, canvas.width, canvas.height);
+      setBacking((current) =>
+        current && current.width === width && current.height === height && current.dpr === dpr
+          ? current
+          : { width, height, dpr }
+      );
+    });
 
-    // Draw letters
-    ctx.fillStyle = '#f9fafb';
-    ctx.font = `${sizePx}px "Courier New", monospace`;
-    ctx.textAlign = 'center';
-    ctx.textBaseline = 'middle';
+    try {
+      observer.observe(canvas, { box: 'device-pixel-content-box' });
+    } catch {
+      observer.observe(canvas);
+    }
+    return () => observer.disconnect();
+  }, []);
 
-    const totalWidth = letters.length * sizePx * spacing;
-    const startX = (canvas.width - totalWidth) / 2 + (sizePx * spacing) / 2;
-    const y = canvas.height / 2;
+  useEffect(() => {
+    if (!backing || !prefetchSizesPx) return;
+    glyphAtlas.prepare(prefetchSizesPx.map((size) => deviceSize(size, backing.dpr)));
+  }, [backing, prefetchSizesPx]);
 
-    letters.forEach((letter, i) => {
-      const x = startX + i * sizePx * spacing;
-      ctx.fillText(letter, x, y);
-    });
-  }, [letters, sizePx, spacing]);
+  // Present the line in one frame
+  useEffect(() => {
+    const canvas = canvasRef.current;
+    if (!canvas || !backing) return;
+
+    const size = deviceSize(sizePx, backing.dpr);
+    let frame = 0;
+    let cancelled = false;
+
+    const present = () => {
+      frame = requestAnimationFrame((onsetMs) => {
+        const atlas = glyphAtlas.get(size);
+        const ctx = canvas.getContext('2d');
+        if (!atlas || !ctx) return;
+
+        if (canvas.width !== backing.width || canvas.height !== backing.height) {
+          canvas.width = backing.width;
+          canvas.height = backing.height;
+        }
+
+        ctx.imageSmoothingEnabled = false;
+        ctx.fillStyle = BACKGROUND;
+        ctx.fillRect(0, 0, canvas.width, canvas.height);
+
+        // Integer destinations keep every blit 1:1 with device pixels
+        const pitch = Math.round(size * spacing);
+        const startX = Math.round((canvas.width - letters.length * pitch + pitch - size) / 2);
+        const y = Math.round((canvas.height - size) / 2);
+
+        letters.forEach((letter, i) => {
+          const offset = glyphOffset(letter, size);
+          if (offset === null) return;
+          ctx.drawImage(atlas, offset, ATLAS_PADDING, size, size, startX + i * pitch, y, size, size);
+        });
+
+        onPresentedRef.current?.(onsetMs, letters);
+      });
+    };
+
+    if (glyphAtlas.get(size)) {
+      present();
+    } else {
+      glyphAtlas.prepare([size]).then(() => {
+        if (!cancelled) present();
+      });
+    }
+
+    return () => {
+      cancelled = true;
+      cancelAnimationFrame(frame);
+    };
+  }, [letters, sizePx, spacing, backing]);
 
   return (
     <canvas
       ref={canvasRef}
-      width={1200}
-      height={400}
       style={{
+        display: 'block',
         width: '100%',
         maxWidth: '1200px',
-        height: 'auto',
-        background: '#0a0a0b',
+        height: `${height}px`,
+        background: BACKGROUND,
         borderRadius: '0.5rem',
         border: '1px solid rgba(255, 255, 255, 0.1)',
       }}
     />
   );
 }
-
-
-
@@ -0,0 +1,75 @@
+import { Profiler, ProfilerOnRenderCallback, ReactNode } from 'react';
+
+interface RenderProfilerProps {
+  id: string;
+  children: ReactNode;
+}
+
+// Half a 60 Hz frame: a commit over this risks delaying the next stimulus frame
+const RENDER_BUDGET_MS = 8;
+const REPORT_INTERVAL_MS = 10 * 1000;
+
+interface RenderStats {
+  commits: number;
+  overBudget: number;
+  totalMs: number;
+  maxMs: number;
+}
+
+const stats = new Map<string, RenderStats>();
+let dirty = false;
+
+const onRender: ProfilerOnRenderCallback = (id, phase, actualDuration) => {
+  let entry = stats.get(id);
+  if (!entry) {
+    entry = { commits: 0, overBudget: 0, totalMs: 0, maxMs: 0 };
+    stats.set(id, entry);
+  }
+  entry.commits++;
+  entry.totalMs += actualDuration;
+  entry.maxMs = Math.max(entry.maxMs, actualDuration);
+  dirty = true;
+
+  if (actualDuration > RENDER_BUDGET_MS) {
+    entry.overBudget++;
+    console.warn(`🐢 ${id} ${phase} render took ${actualDuration.toFixed(1)}ms (budget ${RENDER_BUDGET_MS}ms)`);
+  }
+};
+
+function renderReport() {
+  return Object.fromEntries(
+    Array.from(stats, ([id, entry]) => [
+      id,
+      {
+        commits: entry.commits,
+        overBudget: entry.overBudget,
+        meanMs: Math.round((entry.totalMs / entry.commits) * 100) / 100,
+        maxMs: Math.round(entry.maxMs * 100) / 100,
+      },
+    ])
+  );
+}
+
+if (import.meta.env.DEV) {
+  // window.__renderReport() in the console; also logged while renders happen
+  (window as any).__renderReport = renderReport;
+  setInterval(() => {
+    if (!dirty) return;
+    dirty = false;
+    console.table(renderReport());
+  }, REPORT_INTERVAL_MS);
+}
+
+/**
+ * Dev-mode render counter and budget check for a subtree
+ * Production builds render children directly, without a Profiler.
+ */
+export default function RenderProfiler({ id, children }: RenderProfilerProps) {
+  if (!import.meta.env.DEV) return <>{children}</>;
+
+  return (
+    <Profiler id={id} onRender={onRender}>
+      {children}
+    </Profiler>
+  );
+}
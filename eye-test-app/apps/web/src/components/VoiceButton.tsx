@@ -1,4 +1,5 @@
 import { useState, useRef, useEffect } from 'react';
+import { stimulusTiming } from '../services/stimulusTiming';
 
 interface VoiceButtonProps {
   onTranscript: (text: string, confidence: number) => void;
@@ -31,6 +32,10 @@ export default function VoiceButton({ onTranscript, disabled }: VoiceButtonProps
       setIsRecording(true);
     };
 
+    recognition.onspeechstart = (event: any) => {
+      stimulusTiming.speechOnset(event.timeStamp || performance.now());
+    };
+
     recognition.onresult = (event: any) => {
       const result = event.results[0][0];
       const transcript = result.transcript.toUpperCase().trim();
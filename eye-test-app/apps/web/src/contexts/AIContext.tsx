@@ -1,6 +1,6 @@
 import { createContext, useContext, useState, useEffect, ReactNode } from 'react';
 import { useNavigate } from 'react-router-dom';
-import { useTestStore } from '../store/testStore';
+import { useTestSlice } from '../store/testStore';
 
 interface AICommand {
   action: string;
@@ -32,14 +32,16 @@ interface AIProviderProps {
 
 export function AIProvider({ children }: AIProviderProps) {
   const navigate = useNavigate();
-  const { 
-    stage, 
-    setStage, 
-    currentEye, 
+  const {
+    stage,
+    setStage,
+    currentEye,
     setCurrentEye,
     calibration,
     setCalibration,
-  } = useTestStore();
+  } = useTestSlice(
+    'stage', 'setStage', 'currentEye', 'setCurrentEye', 'calibration', 'setCalibration'
+  );
 
   const [isAIActive, setIsAIActive] = useState(false);
   const [currentStage, setCurrentStage] = useState('home');
@@ -1,6 +1,6 @@
 import { useState, useEffect, useCallback, useMemo } from 'react';
 import { useNavigate } from 'react-router-dom';
-import { useTestStore } from '../store/testStore';
+import { useTestStore, useTestSlice } from '../store/testStore';
 import { api } from '../api/client';
 
 interface AgentTool {
@@ -16,7 +16,10 @@ interface AgentTool {
  */
 export function useAIAgent() {
   const navigate = useNavigate();
-  const testStore = useTestStore();
+  // Tools read the store when they run; only what the effects below
+  // depend on is subscribed, so agent callbacks stay stable across updates
+  const { stage, calibration, sphereResults } = useTestSlice('stage', 'calibration', 'sphereResults');
+  const testStore = useTestStore.getState;
   const [isAgentActive, setIsAgentActive] = useState(false);
   const [agentThinking, setAgentThinking] = useState(false);
   const [lastMessage, setLastMessage] = useState('');
@@ -47,8 +50,8 @@ export function useAIAgent() {
         };
         
         // Update store stage BEFORE navigating
-        console.log(`🎯 Updating stage from ${testStore.stage} to ${stage}`);
-        testStore.setStage(stage as any);
+        console.log(`🎯 Updating stage from ${testStore().stage} to ${stage}`);
+        testStore().setStage(stage as any);
         
         // Then navigate
         console.log(`🧭 Navigating to ${routes[stage]}`);
@@ -81,7 +84,7 @@ export function useAIAgent() {
         const arcminCm = Math.tan(arcminRad) * viewingDistanceCm;
         const pixelsPerArcmin = arcminCm * pixelsPerCm;
 
-        testStore.setCalibration({
+        testStore().setCalibration({
           pixelsPerCm,
           viewingDistanceCm,
           pixelsPerArcmin,
@@ -116,8 +119,8 @@ export function useAIAgent() {
         required: ['eye'],
       },
       execute: async ({ eye }) => {
-        testStore.setCurrentEye(eye);
-        testStore.setStage(eye === 'OD' ? 'sphere_od' : 'sphere_os');
+        testStore().setCurrentEye(eye);
+        testStore().setStage(eye === 'OD' ? 'sphere_od' : 'sphere_os');
         return { success: true, message: `Started ${eye} test` };
       },
     },
@@ -157,7 +160,7 @@ export function useAIAgent() {
         const threshold = lineToLogMAR(bestLine);
         const sphere = lineToSphere(bestLine);
 
-        testStore.setSphereResult(eye, {
+        testStore().setSphereResult(eye, {
           threshold,
           sphere,
           confidence: 0.85,
@@ -177,7 +180,7 @@ export function useAIAgent() {
       description: 'Mark calibration as complete and proceed to testing',
       parameters: { type: 'object', properties: {} },
       execute: async () => {
-        testStore.setStage('sphere_od');
+        testStore().setStage('sphere_od');
         navigate('/sphere');
         return { success: true, message: 'Calibration complete, moving to sphere test' };
       },
@@ -187,13 +190,13 @@ export function useAIAgent() {
       description: 'Mark current sphere test as complete',
       parameters: { type: 'object', properties: {} },
       execute: async () => {
-        const currentEye = testStore.currentEye;
+        const currentEye = testStore().currentEye;
         if (currentEye === 'OD') {
-          testStore.setCurrentEye('OS');
-          testStore.setStage('sphere_os');
+          testStore().setCurrentEye('OS');
+          testStore().setStage('sphere_os');
           return { success: true, message: 'OD complete, switching to OS' };
         } else {
-          testStore.setStage('jcc_od');
+          testStore().setStage('jcc_od');
           navigate('/jcc');
           return { success: true, message: 'Both eyes complete, moving to astigmatism' };
         }
@@ -204,7 +207,7 @@ export function useAIAgent() {
       description: 'Mark astigmatism test as complete and show results',
       parameters: { type: 'object', properties: {} },
       execute: async () => {
-        testStore.setStage('summary');
+        testStore().setStage('summary');
         navigate('/summary');
         return { success: true, message: 'Exam complete, showing summary' };
       },
@@ -217,19 +220,19 @@ export function useAIAgent() {
         return {
           success: true,
           data: {
-            stage: testStore.stage,
-            currentEye: testStore.currentEye,
-            hasCalibration: !!testStore.calibration,
-            sessionId: testStore.sessionId,
+            stage: testStore().stage,
+            currentEye: testStore().currentEye,
+            hasCalibration: !!testStore().calibration,
+            sessionId: testStore().sessionId,
             sphereResults: {
-              OD: testStore.sphereResults.OD,
-              OS: testStore.sphereResults.OS,
+              OD: testStore().sphereResults.OD,
+              OS: testStore().sphereResults.OS,
             },
           },
         };
       },
     },
-  ], [navigate, testStore]); // Memoize with stable dependencies
+  ], [navigate]); // Memoize with stable dependencies
 
   /**
    * Manual tool execution (for debugging/testing)
@@ -269,8 +272,8 @@ export function useAIAgent() {
     console.log('📝 Message:', message);
     console.log('👤 Is User:', isUser);
     console.log('🤖 Agent Active:', isAgentActive);
-    console.log('📊 Stage:', testStore.stage);
-    console.log('👁️  Eye:', testStore.currentEye);
+    console.log('📊 Stage:', testStore().stage);
+    console.log('👁️  Eye:', testStore().currentEye);
     console.log('='.repeat(80) + '\n');
     
     if (isUser) {
@@ -283,74 +286,18 @@ export function useAIAgent() {
       return;
     }
 
-    // Simple pattern matching (fallback for now, will use Grok later)
+    // The API's transition table decides (with an opt-in LLM fallback for
+    // ambiguous messages), so the web and server never disagree on rules
     try {
       setAgentThinking(true);
-      console.log('🧠 Using simple pattern matching...');
-
-      const msg = message.toLowerCase();
-      const toolsToCall: Array<{name: string, parameters: any}> = [];
-
-      // Pattern matching based on message and current stage
-      console.log('🔍 Analyzing message:', msg);
-      console.log('🔍 Current stage:', testStore.stage);
-
-      // Starting examination or calibration (only when idle)
-      if (testStore.stage === 'idle' && 
-          (msg.includes('starting') || msg.includes('calibrate') || msg.includes('begin'))) {
-        console.log('✅ Detected: Starting calibration');
-        toolsToCall.push({ name: 'navigate_to_stage', parameters: { stage: 'calibration' } });
-      }
-      
-      // Calibration complete - look for transition language
-      if (testStore.stage === 'calibration' && 
-          ((msg.includes('now') && (msg.includes('test') || msg.includes('begin') || msg.includes('start'))) ||
-           msg.includes('move to') ||
-           msg.includes('proceed to') ||
-           (msg.includes('ready') && msg.includes('test')) ||
-           (msg.includes('good') && msg.includes('test')) ||
-           (msg.includes('test') && (msg.includes('right') || msg.includes('first'))))) {
-        console.log('✅ Detected: Calibration complete, moving to testing');
-        toolsToCall.push({ name: 'complete_calibration', parameters: {} });
-      }
-      
-      // Right eye test complete - look for moving to next eye
-      if (testStore.stage === 'sphere_od' && 
-          ((msg.includes('now') && (msg.includes('left') || msg.includes('other'))) ||
-           msg.includes('move to left') ||
-           msg.includes('test your left') ||
-           msg.includes('left eye') ||
-           (msg.includes('next') && msg.includes('eye')) ||
-           (msg.includes('good') && msg.includes('left')) ||
-           msg.includes('switch') ||
-           msg.includes('other eye'))) {
-        console.log('✅ Detected: Right eye complete, moving to left');
-        toolsToCall.push({ name: 'record_sphere_result', parameters: { eye: 'OD', bestLine: 8 } });
-        toolsToCall.push({ name: 'complete_sphere_test', parameters: {} });
-      }
-      
-      // Left eye test complete - look for moving to astigmatism
-      if (testStore.stage === 'sphere_os' && 
-          ((msg.includes('now') && (msg.includes('astigmatism') || msg.includes('next test'))) ||
-           msg.includes('move to astigmatism') ||
-           msg.includes('astigmatism test') ||
-           msg.includes('check astigmatism') ||
-           msg.includes('next phase') ||
-           (msg.includes('both eyes') && msg.includes('done')))) {
-        console.log('✅ Detected: Left eye complete, moving to astigmatism');
-        toolsToCall.push({ name: 'record_sphere_result', parameters: { eye: 'OS', bestLine: 8 } });
-        toolsToCall.push({ name: 'complete_sphere_test', parameters: {} });
-      }
-      
-      // Astigmatism test complete
-      if ((testStore.stage === 'jcc_od' || testStore.stage === 'jcc_os') && 
-          ((msg.includes('complete') || msg.includes('done') || msg.includes('finished')) ||
-           msg.includes('show') && msg.includes('result') ||
-           msg.includes('all done') ||
-           msg.includes('examination complete'))) {
-        console.log('✅ Detected: Astigmatism complete');
-        toolsToCall.push({ name: 'complete_astigmatism_test', parameters: {} });
-      }
+      const { stage, currentEye } = testStore();
+      const decision = await api.decideAgent(
+        message,
+        { stage, currentEye },
+        tools.map(({ name, description, parameters }) => ({ name, description, parameters }))
+      );
+      const toolsToCall = decision.toolCalls ?? [];
+      console.log(`🧠 Decision (${decision.engine ?? 'local'}): ${decision.reasoning ?? ''}`);
 
       // Execute tools
       if (toolsToCall.length > 0) {
@@ -366,14 +313,14 @@ export function useAIAgent() {
           }
         }
       } else {
-        console.log('ℹ️ No matching patterns found in message');
+        console.log('ℹ️ No tool calls for this message');
       }
     } catch (error) {
       console.error('❌ AI Agent error:', error);
     } finally {
       setAgentThinking(false);
     }
-  }, [isAgentActive, testStore, tools, navigate]);
+  }, [isAgentActive, tools, navigate]);
 
   /**
    * Auto-progress based on state changes
@@ -383,7 +330,7 @@ export function useAIAgent() {
 
     const autoProgress = async () => {
       // Auto-progress logic based on current state
-      const { stage, calibration, currentEye, sphereResults } = testStore;
+      const { currentEye } = testStore();
 
       // Example: Auto-start sphere test after calibration
       if (stage === 'calibration' && calibration) {
@@ -397,7 +344,7 @@ export function useAIAgent() {
     };
 
     autoProgress();
-  }, [testStore.stage, testStore.calibration, testStore.sphereResults, isAgentActive]);
+  }, [stage, calibration, sphereResults, isAgentActive]);
 
   const startAgent = useCallback(() => {
     console.log('🚀 Starting AI Agent...');
@@ -7,7 +7,7 @@
 
 import { useEffect } from 'react';
 import { useNavigate } from 'react-router-dom';
-import { useTestStore } from '../store/testStore';
+import { useTestSlice } from '../store/testStore';
 
 interface ProgressionConfig {
   /**
@@ -28,7 +28,7 @@ interface ProgressionConfig {
 
 export function useTestProgression(config: ProgressionConfig) {
   const navigate = useNavigate();
-  const { stage, currentEye, setStage, setCurrentEye } = useTestStore();
+  const { stage, currentEye, setStage, setCurrentEye } = useTestSlice('stage', 'currentEye', 'setStage', 'setCurrentEye');
 
   useEffect(() => {
     // Global event listener for test progression signals
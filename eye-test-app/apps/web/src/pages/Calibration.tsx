@@ -1,11 +1,11 @@
 import { useState, useEffect } from 'react';
 import { useNavigate } from 'react-router-dom';
-import { useTestStore } from '../store/testStore';
+import { useTestSlice } from '../store/testStore';
 import { useTestProgression, ProgressionEvents } from '../hooks/useTestProgression';
 
 export default function Calibration() {
   const navigate = useNavigate();
-  const { sessionId, setCalibration, setStage } = useTestStore();
+  const { sessionId, setCalibration, setStage } = useTestSlice('sessionId', 'setCalibration', 'setStage');
   const [cardWidthPx, setCardWidthPx] = useState(300);
   const [distance, setDistance] = useState(60);
 
@@ -1,11 +1,11 @@
 import { useNavigate } from 'react-router-dom';
-import { useTestStore } from '../store/testStore';
+import { useTestSlice } from '../store/testStore';
 import { useAI } from '../contexts/AIContext';
 import { api } from '../api/client';
 
 export default function Home() {
   const navigate = useNavigate();
-  const { setSessionId, reset } = useTestStore();
+  const { setSessionId, reset } = useTestSlice('setSessionId', 'reset');
   const { startAI } = useAI();
 
   const startTest = async () => {
@@ -1,12 +1,16 @@
-import { useState, useEffect, useRef } from 'react';
+import { useState, useEffect, useLayoutEffect, useMemo, useRef } from 'react';
 import { useNavigate } from 'react-router-dom';
-import { useTestStore } from '../store/testStore';
+import { useTestSlice } from '../store/testStore';
+import { useVoiceStore } from '../store/voiceStore';
 import { api } from '../api/client';
 import VoiceButton from '../components/VoiceButton';
 import TTSPlayer from '../components/TTSPlayer';
 import AlertBanner from '../components/AlertBanner';
+import DialCanvas from '../components/DialCanvas';
 import { sendSystemMessageToAgent, JCCTestMessages } from '../utils/elevenLabsMessenger';
 import { useTestProgression, ProgressionEvents } from '../hooks/useTestProgression';
+import { stimulusTiming } from '../services/stimulusTiming';
+import { jccDialSpec } from '../services/dialLayers';
 
 export default function JCCTest() {
   const navigate = useNavigate();
@@ -24,13 +28,29 @@ export default function JCCTest() {
     hideGrok,
     showGrok,
     elevenLabsReady,
-    patientTranscriptions,
-  } = useTestStore();
+  } = useTestSlice(
+    'sessionId',
+    'calibration',
+    'currentEye',
+    'stage',
+    'setStage',
+    'setJccState',
+    'setJccResult',
+    'setCurrentEye',
+    'showGrokHint',
+    'grokMessage',
+    'hideGrok',
+    'showGrok',
+    'elevenLabsReady'
+  );
+  // Only the newest transcription: chat traffic doesn't re-render the exam
+  const latestTranscription = useVoiceStore(
+    (state) => state.patientTranscriptions[state.patientTranscriptions.length - 1]
+  );
 
   const [jccState, setJccStateLocal] = useState<any>(null);
   const [showingChoice, setShowingChoice] = useState<1 | 2>(1);
   const [prompt, setPrompt] = useState('');
-  const [trialStartTime, setTrialStartTime] = useState(0);
   const [isComplete, setIsComplete] = useState(false);
   const lastProcessedTranscription = useRef<number>(0);
 
@@ -61,8 +81,6 @@ export default function JCCTest() {
 
   // Watch for patient choices from ElevenLabs widget
   useEffect(() => {
-    const latestTranscription = patientTranscriptions[patientTranscriptions.length - 1];
-    
     // Only process transcriptions for current JCC test
     if (latestTranscription && 
         latestTranscription.timestamp > lastProcessedTranscription.current &&
@@ -76,18 +94,25 @@ export default function JCCTest() {
       // Process as if it came from handleTranscript
       handleTranscript(latestTranscription.text, 1.0);
     }
-  }, [patientTranscriptions, currentEye, stage, isComplete, jccState]);
+  }, [latestTranscription, currentEye, stage, isComplete, jccState]);
+
+  // Each comparison's onset is the frame that first paints it. A/B flips
+  // belong to the same trial, so they don't restart it (or drop speech
+  // that began before the flip)
+  useLayoutEffect(() => {
+    if (!jccState || isComplete) return;
+    stimulusTiming.present(`jcc ${jccState.axisDeg}° ${jccState.cyl}D`);
+  }, [jccState, isComplete]);
 
   const initJCC = async () => {
     try {
       console.log(`🔄 Initializing JCC for ${currentEye}...`);
       
-      const response = await api.initJCC(currentEye);
+      const response = await api.initJCC(sessionId!, currentEye);
       setJccStateLocal(response.state);
       setJccState(currentEye, response.state);
       
       setShowingChoice(1);
-      setTrialStartTime(Date.now());
       
       const eyeName = currentEye === 'OD' ? 'right' : 'left';
       setPrompt(`Now testing astigmatism for your ${eyeName} eye. Which is clearer: one... or two?`);
@@ -121,7 +146,8 @@ export default function JCCTest() {
       return;
     }
 
-    const latencyMs = Date.now() - trialStartTime;
+    const timing = stimulusTiming.respond();
+    if (timing) stimulusTiming.log(sessionId!, 'jcc_timing', timing);
 
     console.log(`📝 JCC choice: ${choice}`);
 
@@ -131,7 +157,7 @@ export default function JCCTest() {
     }
 
     try {
-      const response = await api.nextJCC(jccState, choice, latencyMs);
+      const response = await api.nextJCC(sessionId!, currentEye, choice, timing?.latencyMs);
       
       setJccStateLocal(response.state);
       setJccState(currentEye, response.state);
@@ -177,7 +203,6 @@ export default function JCCTest() {
         }
       } else {
         // Next comparison
-        setTrialStartTime(Date.now());
         setPrompt('Which is clearer: one... or two?');
         
         // 📤 Notify ElevenLabs agent about next comparison
@@ -217,7 +242,7 @@ export default function JCCTest() {
 
       {jccState && (
         <div className="text-center mb-3" style={{ fontSize: '0.875rem', color: 'var(--color-text-dim)' }}>
-          Comparisons: {jccState.history.length} | Current Axis: {jccState.axisDeg}° | Cylinder: {jccState.cyl}D
+          Comparisons: {jccState.trialCount} | Current Axis: {jccState.axisDeg}° | Cylinder: {jccState.cyl}D
         </div>
       )}
 
@@ -299,6 +324,8 @@ export default function JCCTest() {
 }
 
 function JCCSimulation({ showing, axisDeg }: { showing: 1 | 2; axisDeg: number; cyl: number }) {
+  const specs = useMemo(() => [jccDialSpec(axisDeg, 1), jccDialSpec(axisDeg, 2)], [axisDeg]);
+
   return (
     <div style={{
       width: '100%',
@@ -326,37 +353,8 @@ function JCCSimulation({ showing, axisDeg }: { showing: 1 | 2; axisDeg: number;
         {showing === 1 ? '① First' : '② Second'}
       </div>
 
-      {/* Simplified JCC visualization */}
-      <svg width="300" height="300" viewBox="0 0 300 300">
-        {/* Target with astigmatism simulation */}
-        <g transform="translate(150, 150)">
-          {/* Radial lines (some blurred) */}
-          {[0, 30, 60, 90, 120, 150].map((angle) => {
-            const rad = ((angle + (showing === 1 ? 0 : 45)) * Math.PI) / 180;
-            const x = Math.cos(rad) * 100;
-            const y = Math.sin(rad) * 100;
-            
-            // Simulate blur based on axis alignment
-            const blur = Math.abs(Math.sin((angle - axisDeg) * Math.PI / 180)) * 3;
-            
-            return (
-              <line
-                key={angle}
-                x1="0"
-                y1="0"
-                x2={x}
-                y2={y}
-                stroke="rgba(249, 250, 251, 0.8)"
-                strokeWidth="2"
-                filter={`blur(${blur}px)`}
-              />
-            );
-          })}
-          
-          {/* Center circle */}
-          <circle r="10" fill="var(--color-primary)" />
-        </g>
-      </svg>
+      {/* Simplified JCC visualization: both choices are cached layers, a flip swaps them */}
+      <DialCanvas spec={specs[showing - 1]} prefetch={specs} />
     </div>
   );
 }
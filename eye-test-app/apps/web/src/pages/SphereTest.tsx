@@ -1,23 +1,39 @@
-import { useState, useEffect } from 'react';
+import { useState, useEffect, useMemo } from 'react';
 import { useNavigate } from 'react-router-dom';
-import { useTestStore } from '../store/testStore';
-import FixedLettersChart from '../components/FixedLettersChart';
+import { calculateLetterSize } from '@OptiX/core';
+import { useTestStore, useTestSlice } from '../store/testStore';
+import OptotypeCanvas from '../components/OptotypeCanvas';
+import { CHART_LINE_COUNT, lineLetters, lineLogMAR } from '../services/acuityChart';
+import { stepSizesPx } from '../services/glyphAtlas';
+import { stimulusTiming } from '../services/stimulusTiming';
 import { useTestProgression } from '../hooks/useTestProgression';
 
 export default function SphereTest() {
   const navigate = useNavigate();
-  const {
-    sessionId,
-    calibration,
-    currentEye,
-    stage,
-    setStage,
-    elevenLabsReady,
-  } = useTestStore();
+  const { sessionId, calibration, currentEye, stage, setStage, elevenLabsReady } = useTestSlice(
+    'sessionId',
+    'calibration',
+    'currentEye',
+    'stage',
+    'setStage',
+    'elevenLabsReady'
+  );
 
   const currentLine = useTestStore(state => state.currentTestLine); // Get from global state
   const [isComplete, setIsComplete] = useState(false);
 
+  // Letters are drawn at the calibrated physical size of the line's logMAR
+  const letters = lineLetters(currentLine);
+  const sizePx = calibration
+    ? calculateLetterSize(lineLogMAR(currentLine), calibration.viewingDistanceCm, calibration.pixelsPerCm)
+    : 0;
+
+  // Rasterize every step up front so advancing a line never waits on an atlas
+  const prefetchSizesPx = useMemo(
+    () => (calibration ? stepSizesPx(calibration.viewingDistanceCm, calibration.pixelsPerCm) : undefined),
+    [calibration]
+  );
+
   // Auto-progression listener
   useTestProgression({
     currentStage: currentEye === 'OD' ? 'sphere_od' : 'sphere_os',
@@ -108,9 +124,11 @@ export default function SphereTest() {
         justifyContent: 'center',
         width: '100%',
       }}>
-        <FixedLettersChart
-          pixelsPerArcmin={calibration.pixelsPerArcmin}
-          currentLine={currentLine}
+        <OptotypeCanvas
+          letters={letters}
+          sizePx={sizePx}
+          prefetchSizesPx={prefetchSizesPx}
+          onPresented={stimulusTiming.markPresented}
         />
       </div>
 
@@ -128,7 +146,7 @@ export default function SphereTest() {
           color: 'var(--color-primary)',
           fontWeight: 600,
         }}>
-          Line {currentLine} of 11
+          Line {currentLine} of {CHART_LINE_COUNT}
         </p>
         <p style={{ 
           fontSize: '0.875rem', 
@@ -1,11 +1,11 @@
 import { useEffect } from 'react';
 import { useNavigate } from 'react-router-dom';
-import { useTestStore } from '../store/testStore';
+import { useTestSlice } from '../store/testStore';
 import { api } from '../api/client';
 
 export default function Summary() {
   const navigate = useNavigate();
-  const { sessionId, sphereResults, jccResults, reset } = useTestStore();
+  const { sessionId, sphereResults, jccResults, reset } = useTestSlice('sessionId', 'sphereResults', 'jccResults', 'reset');
 
   useEffect(() => {
     if (!sessionId) {
@@ -0,0 +1,56 @@
+/**
+ * The 11-line Sloan acuity chart the sphere test reads through
+ *
+ * Lines follow the printed Snellen chart, from 20/200 (line 1) to 20/20
+ * (line 8) and beyond, so letters and logMAR sizes match what the examiner
+ * scores against. Lines map to the nearest LOGMAR_STEPS index for the
+ * server-side threshold search.
+ */
+
+import { LOGMAR_STEPS } from '@OptiX/core';
+
+export const CHART_LINE_COUNT = 11;
+
+export const CHART_LINES: Record<number, string[]> = {
+  1: ['E'],
+  2: ['F', 'P'],
+  3: ['T', 'O', 'Z'],
+  4: ['L', 'P', 'E', 'D'],
+  5: ['P', 'E', 'C', 'F', 'D'],
+  6: ['E', 'D', 'F', 'C', 'Z', 'P'],
+  7: ['F', 'E', 'L', 'O', 'P', 'Z', 'D'],
+  8: ['D', 'E', 'F', 'P', 'O', 'T', 'E', 'C'],
+  9: ['L', 'E', 'F', 'O', 'D', 'P', 'C', 'T'],
+  10: ['F', 'D', 'P', 'L', 'T', 'C', 'E', 'O'],
+  11: ['F', 'E', 'Z', 'O', 'L', 'C', 'F', 'T', 'D'],
+};
+
+// 20/200, 20/100, 20/70, 20/50, 20/40, 20/30, 20/25, 20/20, 20/16, 20/12.5, 20/10
+const LINE_LOGMAR: Record<number, number> = {
+  1: 1.0, 2: 0.7, 3: 0.54, 4: 0.4, 5: 0.3,
+  6: 0.18, 7: 0.1, 8: 0.0, 9: -0.1, 10: -0.2, 11: -0.3,
+};
+
+function clampLine(line: number): number {
+  return Math.min(CHART_LINE_COUNT, Math.max(1, Math.round(line)));
+}
+
+export function lineLetters(line: number): string[] {
+  return CHART_LINES[clampLine(line)];
+}
+
+export function lineLogMAR(line: number): number {
+  return LINE_LOGMAR[clampLine(line)];
+}
+
+/**
+ * LOGMAR_STEPS index closest to a line's size
+ */
+export function lineStepIndex(line: number): number {
+  const logMAR = lineLogMAR(line);
+  let best = 0;
+  for (let i = 1; i < LOGMAR_STEPS.length; i++) {
+    if (Math.abs(LOGMAR_STEPS[i] - logMAR) < Math.abs(LOGMAR_STEPS[best] - logMAR)) best = i;
+  }
+  return best;
+}
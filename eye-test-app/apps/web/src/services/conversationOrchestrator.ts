@@ -8,11 +8,15 @@
  * - Eye switching and navigation
  */
 
+import { SpokenPrompts } from '@OptiX/voice/prompts';
 import { api } from '../api/client';
 import { SimpleConversationFlow } from './simpleConversationFlow';
+import { CHART_LINE_COUNT, lineLetters, lineStepIndex } from './acuityChart';
+import { TrialTiming, stimulusTiming } from './stimulusTiming';
 
 interface OrchestratorConfig {
   conversation: SimpleConversationFlow;
+  getSessionId: () => string | null;
   onLineAdvance: (line: number) => void;
   onEyeSwitch: (eye: 'OD' | 'OS') => void;
   onTestComplete: (stage: 'sphere' | 'jcc') => void;
@@ -25,21 +29,7 @@ export class ConversationOrchestrator {
   private currentEye: 'OD' | 'OS' = 'OD';
   private stage: 'sphere_od' | 'sphere_os' | 'jcc_od' | 'jcc_os' = 'sphere_od';
   private xaiAnalyses: any[] = [];
-
-  // Expected letters by line
-  private readonly expectedLetters: Record<number, string> = {
-    1: 'E',
-    2: 'F P',
-    3: 'T O Z',
-    4: 'L P E D',
-    5: 'P E C F D',
-    6: 'E D F C Z P',
-    7: 'F E L O P Z D',
-    8: 'D E F P O T E C',
-    9: 'L E F O D P C T',
-    10: 'F D P L T C E O',
-    11: 'F E Z O L C F T D',
-  };
+  private staircaseReady: Promise<boolean> | null = null;
 
   constructor(config: OrchestratorConfig) {
     this.config = config;
@@ -50,16 +40,23 @@ export class ConversationOrchestrator {
    */
   async startSphereTest(eye: 'OD' | 'OS'): Promise<void> {
     this.currentEye = eye;
-    this.currentLine = 1;
+    this.showLine(1);
     this.stage = eye === 'OD' ? 'sphere_od' : 'sphere_os';
     this.xaiAnalyses = [];
 
-    const eyeName = eye === 'OD' ? 'right' : 'left';
-    const coverEye = eye === 'OD' ? 'left' : 'right';
-    
-    await this.config.conversation.speak(
-      `Let's test your ${eyeName} eye. Please cover your ${coverEye} eye with your hand and read the letters on line 1.`
-    );
+    // Server-side threshold search fed with each line read (and its latency)
+    const sessionId = this.config.getSessionId();
+    this.staircaseReady = sessionId
+      ? api.initStaircase(sessionId, eye, lineStepIndex(1)).then(
+          () => true,
+          (error) => {
+            console.warn('⚠️ Staircase init failed, trials will not be recorded:', error);
+            return false;
+          }
+        )
+      : null;
+
+    await this.config.conversation.speak(SpokenPrompts.startEye(eye));
   }
 
   /**
@@ -68,8 +65,14 @@ export class ConversationOrchestrator {
   async handleUserResponse(userText: string): Promise<void> {
     console.log(`🧠 Orchestrator: User said "${userText}", analyzing with xAI...`);
 
+    // Close the timed trial for the line on screen before any async work
+    const timing = stimulusTiming.respond();
+    const shownLine = this.currentLine;
+    const sessionId = this.config.getSessionId();
+    if (timing && sessionId) stimulusTiming.log(sessionId, 'sphere_timing', timing);
+
     // Get expected letters for current line
-    const expectedLetters = this.expectedLetters[this.currentLine];
+    const expectedLetters = lineLetters(this.currentLine).join(' ');
 
     try {
       // 🎯 CALL xAI TO ANALYZE
@@ -97,17 +100,18 @@ export class ConversationOrchestrator {
 
       // Notify parent
       this.config.onXAIAnalysis(result);
+      this.reportTrial(shownLine, Boolean(result.correct), timing);
 
       // 🎯 ACT ON xAI'S DECISION
       if (result.recommendation === 'advance') {
         // Advance to next line
-        if (this.currentLine < 11) {
-          this.currentLine++;
+        if (this.currentLine < CHART_LINE_COUNT) {
+          this.showLine(this.currentLine + 1);
           this.config.onLineAdvance(this.currentLine);
           
           const response = result.correct
-            ? `Correct! Now please read line ${this.currentLine}.`
-            : `Let's try the next line. Please read line ${this.currentLine}.`;
+            ? SpokenPrompts.correctNextLine(this.currentLine)
+            : SpokenPrompts.nextLine(this.currentLine);
           
           await this.config.conversation.speak(response);
         } else {
@@ -119,29 +123,42 @@ export class ConversationOrchestrator {
         await this.completeCurrentEye();
       } else {
         // Stay on current line (rare)
-        const response = `Let's try that again. Please read line ${this.currentLine}.`;
-        await this.config.conversation.speak(response);
+        await this.config.conversation.speak(SpokenPrompts.retryLine(this.currentLine));
       }
 
     } catch (error) {
       console.error('❌ xAI analysis error:', error);
-      await this.config.conversation.speak(
-        `I had trouble analyzing that. Please read line ${this.currentLine} again.`
-      );
+      await this.config.conversation.speak(SpokenPrompts.analysisFailed(this.currentLine));
     }
   }
 
+  /**
+   * Record a line read on the server-side staircase, with its measured latency
+   * Never blocks the conversation; a failed report only loses the trial row.
+   */
+  private reportTrial(line: number, correct: boolean, timing: TrialTiming | null): void {
+    const sessionId = this.config.getSessionId();
+    const ready = this.staircaseReady;
+    if (!sessionId || !ready) return;
+
+    const eye = this.currentEye;
+    ready
+      .then((initialized) =>
+        initialized ? api.nextStaircase(sessionId, eye, correct, timing?.latencyMs, lineStepIndex(line)) : undefined
+      )
+      .catch((error) => console.warn('⚠️ Staircase trial not recorded:', error));
+  }
+
   /**
    * Complete current eye test
    */
   private async completeCurrentEye(): Promise<void> {
     console.log(`✅ Completing ${this.currentEye} sphere test`);
+    this.config.conversation.expectLetters(null);
 
     if (this.currentEye === 'OD') {
       // Switch to left eye
-      await this.config.conversation.speak(
-        `Excellent work on the right eye! Now let's test your left eye.`
-      );
+      await this.config.conversation.speak(SpokenPrompts.rightEyeDone());
       
       this.config.onEyeSwitch('OS');
       
@@ -152,9 +169,7 @@ export class ConversationOrchestrator {
       
     } else {
       // Both eyes complete
-      await this.config.conversation.speak(
-        `Perfect! Both eyes tested. Now we'll check for astigmatism.`
-      );
+      await this.config.conversation.speak(SpokenPrompts.sphereDone());
       
       this.config.onTestComplete('sphere');
     }
@@ -176,7 +191,16 @@ export class ConversationOrchestrator {
    * Set current line (for UI sync)
    */
   setCurrentLine(line: number) {
+    this.showLine(line);
+  }
+
+  /**
+   * Make `line` the one being read; the speech capture finalizes once it
+   * has heard that line's letter count
+   */
+  private showLine(line: number) {
     this.currentLine = line;
+    this.config.conversation.expectLetters(lineLetters(line).length);
   }
 
   /**
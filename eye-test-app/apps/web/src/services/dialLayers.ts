@@ -0,0 +1,130 @@
+/**
+ * Cached raster layers for radial astigmatism dials
+ *
+ * A dial (JCC comparison, clock dial, fan) is drawn once per spec and
+ * device-pixel ratio into an offscreen canvas, per-line blur included, and
+ * kept. Showing it, or flipping JCC A/B, is then one drawImage of a cached
+ * layer instead of re-rendering a stack of filtered SVG lines.
+ */
+
+export interface DialLine {
+  angleDeg: number;
+  blurPx?: number; // CSS px
+}
+
+export interface DialSpec {
+  size: number; // CSS px, square
+  radius: number;
+  lines: DialLine[];
+  strokeWidth: number;
+  color: string;
+  lineCap?: CanvasLineCap;
+  hubRadius: number;
+  hubColor: string;
+  background: string;
+}
+
+type LayerCanvas = HTMLCanvasElement | OffscreenCanvas;
+
+// A JCC run visits a few dozen axes × 2 flips; clock/fan dials are static
+const MAX_LAYERS = 64;
+
+const layers = new Map<string, LayerCanvas>(); // Insertion order = LRU
+
+function createCanvas(width: number, height: number): LayerCanvas {
+  if (typeof OffscreenCanvas !== 'undefined') return new OffscreenCanvas(width, height);
+  const canvas = document.createElement('canvas');
+  canvas.width = width;
+  canvas.height = height;
+  return canvas;
+}
+
+/**
+ * Resolve var(--name) colors, which canvas fillStyle doesn't understand
+ */
+function resolveColor(color: string): string {
+  const match = /^var\((--[^)]+)\)$/.exec(color.trim());
+  if (!match) return color;
+  return getComputedStyle(document.documentElement).getPropertyValue(match[1]).trim() || '#3b82f6';
+}
+
+function renderDial(spec: DialSpec, dpr: number): LayerCanvas {
+  const pixels = Math.round(spec.size * dpr);
+  const canvas = createCanvas(pixels, pixels);
+  const ctx = canvas.getContext('2d') as CanvasRenderingContext2D | OffscreenCanvasRenderingContext2D;
+  const supportsFilter = typeof ctx.filter === 'string';
+
+  ctx.scale(dpr, dpr);
+  ctx.fillStyle = spec.background;
+  ctx.fillRect(0, 0, spec.size, spec.size);
+
+  ctx.translate(spec.size / 2, spec.size / 2);
+  ctx.strokeStyle = resolveColor(spec.color);
+  ctx.lineWidth = spec.strokeWidth;
+  ctx.lineCap = spec.lineCap ?? 'butt';
+
+  for (const { angleDeg, blurPx = 0 } of spec.lines) {
+    const rad = (angleDeg * Math.PI) / 180;
+    ctx.save();
+    if (blurPx > 0) {
+      if (supportsFilter) {
+        ctx.filter = `blur(${blurPx * dpr}px)`;
+      } else {
+        // No canvas filters (Safari): a same-colored shadow approximates the blur
+        ctx.shadowColor = ctx.strokeStyle as string;
+        ctx.shadowBlur = blurPx * 2 * dpr;
+      }
+    }
+    ctx.beginPath();
+    ctx.moveTo(0, 0);
+    ctx.lineTo(Math.cos(rad) * spec.radius, Math.sin(rad) * spec.radius);
+    ctx.stroke();
+    ctx.restore();
+  }
+
+  ctx.fillStyle = resolveColor(spec.hubColor);
+  ctx.beginPath();
+  ctx.arc(0, 0, spec.hubRadius, 0, 2 * Math.PI);
+  ctx.fill();
+
+  return canvas;
+}
+
+/**
+ * Cached layer for a dial at a device-pixel ratio, rendering it on first use
+ */
+export function dialLayer(spec: DialSpec, dpr: number): LayerCanvas {
+  const key = `${dpr}|${JSON.stringify(spec)}`;
+  let layer = layers.get(key);
+  if (layer) {
+    layers.delete(key);
+  } else {
+    layer = renderDial(spec, dpr);
+  }
+  layers.set(key, layer);
+
+  while (layers.size > MAX_LAYERS) {
+    layers.delete(layers.keys().next().value!);
+  }
+  return layer;
+}
+
+/**
+ * JCC comparison dial: six radial lines, rotated 45° for choice 2, each
+ * blurred by its angular distance from the axis under test
+ */
+export function jccDialSpec(axisDeg: number, showing: 1 | 2): DialSpec {
+  return {
+    size: 300,
+    radius: 100,
+    lines: [0, 30, 60, 90, 120, 150].map((angle) => ({
+      angleDeg: angle + (showing === 1 ? 0 : 45),
+      blurPx: Math.abs(Math.sin(((angle - axisDeg) * Math.PI) / 180)) * 3,
+    })),
+    strokeWidth: 2,
+    color: 'rgba(249, 250, 251, 0.8)',
+    hubRadius: 10,
+    hubColor: 'var(--color-primary)',
+    background: '#0a0a0b',
+  };
+}
@@ -0,0 +1,134 @@
+/**
+ * Cache of pre-rasterized Sloan letter atlases, keyed by device-pixel size
+ *
+ * Atlases are built off the main thread (glyphAtlasWorker) as ImageBitmaps,
+ * ideally for every LOGMAR_STEPS size up front, so presenting a line is a
+ * handful of 1:1 drawImage blits with no font or path rasterization.
+ * Falls back to rasterizing on the main thread where OffscreenCanvas
+ * workers aren't available.
+ */
+
+import { LOGMAR_STEPS, calculateLetterSize } from '@OptiX/core';
+import { atlasDimensions, rasterizeAtlas } from './sloanGlyphs';
+import type { AtlasReply, AtlasRequest } from './glyphAtlasWorker';
+
+export const LETTER_COLOR = '#f9fafb';
+
+// Enough for every step at a couple of DPRs / distances
+const MAX_ATLASES = 40;
+
+/**
+ * Letter height in device pixels for a CSS-pixel size
+ */
+export function deviceSize(sizePx: number, dpr: number): number {
+  return Math.max(1, Math.round(sizePx * dpr));
+}
+
+/**
+ * CSS-pixel letter heights of every logMAR step for the calibrated viewing
+ * setup (OptotypeCanvas prefetchSizesPx)
+ */
+export function stepSizesPx(viewingDistanceCm: number, pixelsPerCm: number): number[] {
+  return LOGMAR_STEPS.map((logMAR) => calculateLetterSize(logMAR, viewingDistanceCm, pixelsPerCm));
+}
+
+class GlyphAtlasCache {
+  private atlases = new Map<number, ImageBitmap>(); // Insertion order = LRU
+  private pending = new Map<number, Promise<void>>();
+  private waiters = new Map<number, { resolve: (reply: AtlasReply) => void; reject: (error: Error) => void }>();
+  private worker: Worker | null | undefined;
+  private nextId = 1;
+
+  /**
+   * Atlas for a device-pixel size if it's ready
+   */
+  get(size: number): ImageBitmap | undefined {
+    const atlas = this.atlases.get(size);
+    if (atlas) {
+      this.atlases.delete(size);
+      this.atlases.set(size, atlas);
+    }
+    return atlas;
+  }
+
+  /**
+   * Build any missing atlases; resolves once all of `sizes` are ready
+   */
+  prepare(sizes: number[]): Promise<void> {
+    const missing = Array.from(new Set(sizes)).filter((size) => !this.atlases.has(size) && !this.pending.has(size));
+
+    if (missing.length > 0) {
+      const batch = this.build(missing).then((atlases) => {
+        for (const { size, bitmap } of atlases) this.store(size, bitmap);
+      });
+      const settled = batch.finally(() => missing.forEach((size) => this.pending.delete(size)));
+      missing.forEach((size) => this.pending.set(size, settled));
+    }
+
+    return Promise.all(sizes.map((size) => this.pending.get(size))).then(() => undefined);
+  }
+
+  private store(size: number, bitmap: ImageBitmap) {
+    this.atlases.set(size, bitmap);
+    while (this.atlases.size > MAX_ATLASES) {
+      const [oldest, evicted] = this.atlases.entries().next().value!;
+      this.atlases.delete(oldest);
+      evicted.close();
+    }
+  }
+
+  private build(sizes: number[]): Promise<AtlasReply['atlases']> {
+    const worker = this.getWorker();
+    if (!worker) return rasterizeOnMainThread(sizes);
+
+    const request: AtlasRequest = { id: this.nextId++, sizes, color: LETTER_COLOR };
+    return new Promise<AtlasReply>((resolve, reject) => {
+      this.waiters.set(request.id, { resolve, reject });
+      worker.postMessage(request);
+    }).then(
+      (reply) => reply.atlases,
+      () => rasterizeOnMainThread(sizes)
+    );
+  }
+
+  private getWorker(): Worker | null {
+    if (this.worker !== undefined) return this.worker;
+
+    if (typeof Worker === 'undefined' || typeof OffscreenCanvas === 'undefined') {
+      this.worker = null;
+      return null;
+    }
+
+    const worker = new Worker(new URL('./glyphAtlasWorker.ts', import.meta.url), { type: 'module' });
+    worker.onmessage = (event: MessageEvent<AtlasReply>) => {
+      const waiter = this.waiters.get(event.data.id);
+      this.waiters.delete(event.data.id);
+      waiter?.resolve(event.data);
+    };
+    worker.onerror = (event) => {
+      console.warn('⚠️ Glyph atlas worker failed, rasterizing on the main thread:', event.message);
+      worker.terminate();
+      this.worker = null;
+      for (const waiter of this.waiters.values()) waiter.reject(new Error(event.message));
+      this.waiters.clear();
+    };
+
+    this.worker = worker;
+    return worker;
+  }
+}
+
+async function rasterizeOnMainThread(sizes: number[]): Promise<AtlasReply['atlases']> {
+  return Promise.all(
+    sizes.map(async (size) => {
+      const { width, height } = atlasDimensions(size);
+      const canvas = document.createElement('canvas');
+      canvas.width = width;
+      canvas.height = height;
+      rasterizeAtlas(canvas.getContext('2d')!, size, LETTER_COLOR);
+      return { size, bitmap: await createImageBitmap(canvas) };
+    })
+  );
+}
+
+export const glyphAtlas = new GlyphAtlasCache();
@@ -0,0 +1,34 @@
+/**
+ * Worker that rasterizes Sloan atlases on an OffscreenCanvas
+ *
+ * Request: { id, sizes: number[], color }. Reply: { id, atlases } with one
+ * transferred ImageBitmap per size, so no rasterization ever runs on the
+ * thread that presents stimuli.
+ */
+
+import { atlasDimensions, rasterizeAtlas } from './sloanGlyphs';
+
+export interface AtlasRequest {
+  id: number;
+  sizes: number[];
+  color: string;
+}
+
+export interface AtlasReply {
+  id: number;
+  atlases: Array<{ size: number; bitmap: ImageBitmap }>;
+}
+
+self.onmessage = (event: MessageEvent<AtlasRequest>) => {
+  const { id, sizes, color } = event.data;
+
+  const atlases = sizes.map((size) => {
+    const { width, height } = atlasDimensions(size);
+    const canvas = new OffscreenCanvas(width, height);
+    rasterizeAtlas(canvas.getContext('2d')!, size, color);
+    return { size, bitmap: canvas.transferToImageBitmap() };
+  });
+
+  const reply: AtlasReply = { id, atlases };
+  (self as unknown as Worker).postMessage(reply, atlases.map((atlas) => atlas.bitmap));
+};
@@ -0,0 +1,119 @@
+/**
+ * Streaming letter capture on top of Web Speech interim results
+ *
+ * Recognition runs continuous with interim results. Every result event is
+ * folded into one transcript and scanned with parseSpokenLetters; as soon as
+ * the line being read (its letter count comes with reset) has been heard the
+ * utterance is finalized, without waiting for the recognizer's end-of-speech
+ * silence (~1 s per trial).
+ * Anything that isn't a letter line (e.g. "repeat", "next") still finalizes
+ * on the recognizer's own final result.
+ */
+
+import { parseSpokenLetters } from '@OptiX/core';
+
+export interface LetterStreamResult {
+  transcript: string;
+  letters: string[];
+  confidence: number;
+  early: boolean; // Finalized on letter count rather than end of speech
+  speechOnsetMs: number | null; // performance.now() clock; first speech activity of the utterance
+  finalMs: number; // performance.now() clock
+}
+
+export interface LetterStreamCallbacks {
+  onInterim?: (transcript: string, letters: string[]) => void;
+  onFinal: (result: LetterStreamResult) => void;
+}
+
+/**
+ * Configure a recognizer for incremental results
+ */
+export function configureStreamingRecognition(recognition: any): void {
+  recognition.continuous = true;
+  recognition.interimResults = true;
+  recognition.lang = 'en-US';
+  recognition.maxAlternatives = 1;
+}
+
+export class LetterStream {
+  private finalized = false;
+  private speechOnsetMs: number | null = null;
+  private expected: number | null = null;
+
+  constructor(private readonly callbacks: LetterStreamCallbacks) {}
+
+  /**
+   * Start a new utterance (call on every recognition start)
+   * `expected` is the letter count of the line being read; null when no
+   * line is up, so only the recognizer's final result ends the utterance.
+   */
+  reset(expected: number | null = null): void {
+    this.finalized = false;
+    this.speechOnsetMs = null;
+    this.expected = expected;
+  }
+
+  /**
+   * Note speech activity (recognition speechstart, or any result); the
+   * earliest timestamp of the utterance is its speech onset
+   */
+  markSpeech(atMs: number): void {
+    if (this.speechOnsetMs === null || atMs < this.speechOnsetMs) {
+      this.speechOnsetMs = atMs;
+    }
+  }
+
+  /**
+   * Feed a SpeechRecognition result event; returns true once the utterance
+   * has been finalized, so the caller can stop the recognizer
+   */
+  handleResult(event: any): boolean {
+    if (this.finalized) return true;
+    this.markSpeech(event.timeStamp || performance.now());
+
+    let transcript = '';
+    let confidence = 1;
+    let anyFinal = false;
+    for (let i = 0; i < event.results.length; i++) {
+      const result = event.results[i];
+      transcript += result[0].transcript + ' ';
+      if (result.isFinal) {
+        anyFinal = true;
+        confidence = Math.min(confidence, result[0].confidence || 1);
+      }
+    }
+    transcript = transcript.trim();
+
+    const letters = parseSpokenLetters(transcript);
+    this.callbacks.onInterim?.(transcript, letters);
+
+    if (this.expected !== null && letters.length >= this.expected) {
+      // Interim results carry no confidence; only trust final ones
+      this.finish(transcript, letters.slice(0, this.expected), anyFinal ? confidence : 0.8, true);
+      return true;
+    }
+
+    // Continuous mode never ends on its own: a final segment ends the utterance
+    if (event.results[event.results.length - 1].isFinal) {
+      this.finish(transcript, letters, confidence, false);
+      return true;
+    }
+    return false;
+  }
+
+  private finish(transcript: string, letters: string[], confidence: number, early: boolean): void {
+    this.finalized = true;
+    if (early) {
+      console.log(`⚡ Early finalize after ${letters.length} letters: "${transcript}"`);
+    }
+    this.callbacks.onFinal({
+      transcript,
+      letters,
+      confidence,
+      early,
+      speechOnsetMs: this.speechOnsetMs,
+      finalMs: performance.now(),
+    });
+  }
+}
@@ -5,7 +5,10 @@
  * Clean, predictable, and actually works!
  */
 
+import { EXAM_VOICE_ID } from '@OptiX/voice/prompts';
 import { api } from '../api/client';
+import { LetterStream, configureStreamingRecognition } from './letterStream';
+import { stimulusTiming } from './stimulusTiming';
 
 interface ConversationCallbacks {
   onAgentSpeaking: (speaking: boolean) => void;
@@ -20,9 +23,22 @@ export class SimpleConversationFlow {
   private callbacks: ConversationCallbacks;
   private isAgentSpeaking = false;
   private isListening = false;
+  private letterStream: LetterStream;
+  private expectedLetters: number | null = null;
 
   constructor(callbacks: ConversationCallbacks) {
     this.callbacks = callbacks;
+    this.letterStream = new LetterStream({
+      onFinal: ({ transcript, confidence, speechOnsetMs }) => {
+        if (speechOnsetMs !== null) stimulusTiming.speechOnset(speechOnsetMs);
+        console.log(`✅ User said: "${transcript}" (${(confidence * 100).toFixed(0)}% confidence)`);
+
+        this.callbacks.onMessage({
+          type: 'user',
+          text: transcript
+        });
+      },
+    });
     this.initSpeechRecognition();
   }
 
@@ -37,26 +53,26 @@ export class SimpleConversationFlow {
     }
 
     this.recognition = new SpeechRecognition();
-    this.recognition.continuous = false;
-    this.recognition.interimResults = false;
-    this.recognition.lang = 'en-US';
+    // Interim results let a full letter line finalize before end-of-speech
+    configureStreamingRecognition(this.recognition);
+
+    this.recognition.onspeechstart = (event: any) => {
+      this.letterStream.markSpeech(event.timeStamp || performance.now());
+    };
 
     this.recognition.onresult = (event: any) => {
-      const last = event.results.length - 1;
-      const transcript = event.results[last][0].transcript;
-      const confidence = event.results[last][0].confidence;
-      
-      console.log(`✅ User said: "${transcript}" (${(confidence * 100).toFixed(0)}% confidence)`);
-      
-      this.callbacks.onMessage({
-        type: 'user',
-        text: transcript
-      });
-      
-      this.stopListening();
+      if (this.letterStream.handleResult(event)) {
+        // Discard the rest of the utterance rather than wait for its final result
+        this.recognition?.abort();
+        this.stopListening();
+      }
     };
 
     this.recognition.onerror = (event: any) => {
+      if (event.error === 'aborted') {
+        // Our own abort() after LetterStream finalized the utterance
+        return;
+      }
       console.error('❌ Speech recognition error:', event.error);
       this.callbacks.onError(event.error);
       this.stopListening();
@@ -91,7 +107,7 @@ export class SimpleConversationFlow {
         headers: { 'Content-Type': 'application/json' },
         body: JSON.stringify({ 
           text,
-          voiceId: 'EXAVITQu4vr4xnSDxMaL' // Default ElevenLabs voice
+          voiceId: EXAM_VOICE_ID, // The voice the API pre-renders prompts in
         }),
       });
 
@@ -140,6 +156,13 @@ export class SimpleConversationFlow {
     }
   }
 
+  /**
+   * Letter count of the chart line the patient reads next (null: none up)
+   */
+  expectLetters(count: number | null): void {
+    this.expectedLetters = count;
+  }
+
   /**
    * Listen for user speech
    */
@@ -151,6 +174,7 @@ export class SimpleConversationFlow {
     this.callbacks.onListening(true);
 
     try {
+      this.letterStream.reset(this.expectedLetters);
       this.recognition.start();
     } catch (error) {
       console.error('❌ Listen error:', error);
@@ -0,0 +1,137 @@
+/**
+ * Sloan letter geometry and atlas rasterization
+ *
+ * Letters are drawn from their 5×5 construction grid (stroke = 1 unit =
+ * 1/5 of letter height) rather than from a system font, so the rendered
+ * height is exactly the size calculateLetterSize() asked for. Works on any
+ * 2D context, so the same code rasterizes in the atlas worker and in the
+ * main-thread fallback.
+ */
+
+import { SLOAN_LETTERS } from '@OptiX/core';
+
+type Context2D = CanvasRenderingContext2D | OffscreenCanvasRenderingContext2D;
+
+// Transparent gutter between atlas cells so antialiased edges never bleed
+export const ATLAS_PADDING = 2;
+
+const GAP_HALF = 0.5; // C opening is one stroke tall
+const OUTER_GAP = Math.asin(GAP_HALF / 2.5);
+const INNER_GAP = Math.asin(GAP_HALF / 1.5);
+const Z_DIAGONAL = 1.53; // Horizontal width giving a 1-unit-thick diagonal
+
+/**
+ * Fill one letter into the unit grid [0, 5] × [0, 5] (caller scales)
+ */
+function drawGlyph(ctx: Context2D, letter: string): void {
+  const bar = (x: number, y: number, w: number, h: number) => ctx.fillRect(x, y, w, h);
+
+  switch (letter) {
+    case 'C':
+      ctx.beginPath();
+      ctx.arc(2.5, 2.5, 2.5, OUTER_GAP, 2 * Math.PI - OUTER_GAP);
+      ctx.arc(2.5, 2.5, 1.5, 2 * Math.PI - INNER_GAP, INNER_GAP, true);
+      ctx.closePath();
+      ctx.fill();
+      break;
+    case 'D':
+      ctx.beginPath();
+      ctx.moveTo(0, 0);
+      ctx.lineTo(2.5, 0);
+      ctx.arc(2.5, 2.5, 2.5, -Math.PI / 2, Math.PI / 2);
+      ctx.lineTo(0, 5);
+      ctx.closePath();
+      ctx.moveTo(1, 1);
+      ctx.lineTo(2.5, 1);
+      ctx.arc(2.5, 2.5, 1.5, -Math.PI / 2, Math.PI / 2);
+      ctx.lineTo(1, 4);
+      ctx.closePath();
+      ctx.fill('evenodd');
+      break;
+    case 'E':
+      bar(0, 0, 1, 5);
+      bar(1, 0, 4, 1);
+      bar(1, 2, 4, 1);
+      bar(1, 4, 4, 1);
+      break;
+    case 'F':
+      bar(0, 0, 1, 5);
+      bar(1, 0, 4, 1);
+      bar(1, 2, 3, 1);
+      break;
+    case 'L':
+      bar(0, 0, 1, 5);
+      bar(1, 4, 4, 1);
+      break;
+    case 'O':
+      ctx.beginPath();
+      ctx.arc(2.5, 2.5, 2.5, 0, 2 * Math.PI);
+      ctx.arc(2.5, 2.5, 1.5, 0, 2 * Math.PI);
+      ctx.fill('evenodd');
+      break;
+    case 'P':
+      bar(0, 0, 1, 5);
+      ctx.beginPath();
+      ctx.moveTo(1, 0);
+      ctx.lineTo(3.5, 0);
+      ctx.arc(3.5, 1.5, 1.5, -Math.PI / 2, Math.PI / 2);
+      ctx.lineTo(1, 3);
+      ctx.closePath();
+      ctx.moveTo(1, 1);
+      ctx.lineTo(3.5, 1);
+      ctx.arc(3.5, 1.5, 0.5, -Math.PI / 2, Math.PI / 2);
+      ctx.lineTo(1, 2);
+      ctx.closePath();
+      ctx.fill('evenodd');
+      break;
+    case 'T':
+      bar(0, 0, 5, 1);
+      bar(2, 1, 1, 4);
+      break;
+    case 'Z':
+      bar(0, 0, 5, 1);
+      bar(0, 4, 5, 1);
+      ctx.beginPath();
+      ctx.moveTo(5 - Z_DIAGONAL, 1);
+      ctx.lineTo(5, 1);
+      ctx.lineTo(Z_DIAGONAL, 4);
+      ctx.lineTo(0, 4);
+      ctx.closePath();
+      ctx.fill();
+      break;
+  }
+}
+
+/**
+ * Atlas size for letters `sizePx` device pixels tall, one cell per letter
+ */
+export function atlasDimensions(sizePx: number): { width: number; height: number } {
+  return {
+    width: SLOAN_LETTERS.length * (sizePx + ATLAS_PADDING) + ATLAS_PADDING,
+    height: sizePx + 2 * ATLAS_PADDING,
+  };
+}
+
+/**
+ * X offset of a letter's cell in its atlas, or null for non-Sloan letters
+ */
+export function glyphOffset(letter: string, sizePx: number): number | null {
+  const index = SLOAN_LETTERS.indexOf(letter);
+  return index < 0 ? null : ATLAS_PADDING + index * (sizePx + ATLAS_PADDING);
+}
+
+/**
+ * Rasterize every Sloan letter at `sizePx` into a context sized by atlasDimensions()
+ */
+export function rasterizeAtlas(ctx: Context2D, sizePx: number, color: string): void {
+  const scale = sizePx / 5;
+  ctx.fillStyle = color;
+
+  SLOAN_LETTERS.forEach((letter) => {
+    ctx.save();
+    ctx.translate(glyphOffset(letter, sizePx)!, ATLAS_PADDING);
+    ctx.scale(scale, scale);
+    drawGlyph(ctx, letter);
+    ctx.restore();
+  });
+}
@@ -0,0 +1,109 @@
+/**
+ * Stimulus-onset and response-latency timing
+ *
+ * Every timestamp is on the monotonic performance.now() clock (event
+ * timeStamps share it), so latencies never jump with wall-clock changes:
+ * - onset: the requestAnimationFrame timestamp of the frame that first
+ *   shows the stimulus (OptotypeCanvas reports its own frame)
+ * - speech onset: the first speech activity the STT stream saw for the
+ *   utterance (see LetterStream)
+ * - response: when the answer was finalized (final result, click)
+ * Response latency is speech onset − onset, falling back to response −
+ * onset when no speech onset is known (e.g. button presses).
+ */
+
+import { api } from '../api/client';
+
+export interface TrialTiming {
+  stimulus: string;
+  onsetMs: number;
+  speechOnsetMs: number | null;
+  responseMs: number;
+  latencyMs: number;
+}
+
+interface OpenTrial {
+  stimulus: string;
+  onsetMs: number | null; // null until the presenting frame runs
+  speechOnsetMs: number | null;
+}
+
+class StimulusTiming {
+  private trial: OpenTrial | null = null;
+  private frame = 0;
+
+  /**
+   * Start a trial for a stimulus just committed to the DOM; its onset is
+   * the next animation frame (call from a layout effect)
+   */
+  present(stimulus: string): void {
+    cancelAnimationFrame(this.frame);
+    const trial: OpenTrial = { stimulus, onsetMs: null, speechOnsetMs: null };
+    this.trial = trial;
+    this.frame = requestAnimationFrame((frameMs) => {
+      trial.onsetMs = frameMs;
+    });
+  }
+
+  /**
+   * Start a trial whose presenting frame is already known (OptotypeCanvas onPresented)
+   * Redrawing the stimulus already on screen (e.g. on resize) keeps its onset.
+   */
+  markPresented = (onsetMs: number, letters: string[]): void => {
+    const stimulus = letters.join('');
+    if (this.trial?.stimulus === stimulus && this.trial.onsetMs !== null) return;
+    cancelAnimationFrame(this.frame);
+    this.trial = { stimulus, onsetMs, speechOnsetMs: null };
+  };
+
+  /**
+   * First speech activity for the open trial; earlier reports win, and
+   * speech that began before onset is ignored
+   */
+  speechOnset(atMs: number): void {
+    const trial = this.trial;
+    if (!trial || trial.onsetMs === null || atMs < trial.onsetMs) return;
+    if (trial.speechOnsetMs === null || atMs < trial.speechOnsetMs) {
+      trial.speechOnsetMs = atMs;
+    }
+  }
+
+  /**
+   * Close the open trial; null if no stimulus has been presented yet
+   */
+  respond(atMs: number = performance.now()): TrialTiming | null {
+    const trial = this.trial;
+    this.trial = null;
+    if (!trial || trial.onsetMs === null) return null;
+
+    const answeredMs = trial.speechOnsetMs ?? atMs;
+    return {
+      stimulus: trial.stimulus,
+      onsetMs: trial.onsetMs,
+      speechOnsetMs: trial.speechOnsetMs,
+      responseMs: atMs,
+      latencyMs: Math.max(0, Math.round(answeredMs - trial.onsetMs)),
+    };
+  }
+
+  /**
+   * Log a trial's timing as deltas from onset
+   */
+  log(sessionId: string, step: string, timing: TrialTiming): void {
+    api.logEvent({
+      sessionId,
+      t: Math.round(performance.timeOrigin + timing.onsetMs),
+      step,
+      lettersShown: timing.stimulus,
+      latencyMs: timing.latencyMs,
+      params: {
+        timing: 'monotonic',
+        speechOnsetDeltaMs:
+          timing.speechOnsetMs === null ? null : Math.round(timing.speechOnsetMs - timing.onsetMs),
+        responseDeltaMs: Math.round(timing.responseMs - timing.onsetMs),
+      },
+    });
+  }
+}
+
+export const stimulusTiming = new StimulusTiming();
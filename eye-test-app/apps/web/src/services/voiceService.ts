@@ -12,6 +12,9 @@
  * - Loop continues automatically
  */
 
+import { LetterStream, configureStreamingRecognition } from './letterStream';
+import { stimulusTiming } from './stimulusTiming';
+
 interface VoiceServiceCallbacks {
   onUserSpeech?: (text: string, confidence: number) => void;
   onAgentSpeaking?: (speaking: boolean) => void;
@@ -19,6 +22,19 @@ interface VoiceServiceCallbacks {
   onError?: (error: any) => void;
 }
 
+/**
+ * Progressive playback needs MediaSource MP3 support and a chunked (not
+ * cache-hit) response; otherwise fall back to buffering the whole clip
+ */
+function canStreamAudio(response: Response): boolean {
+  return (
+    typeof MediaSource !== 'undefined' &&
+    MediaSource.isTypeSupported('audio/mpeg') &&
+    response.headers.get('X-TTS-Cache') === 'stream' &&
+    !!response.body
+  );
+}
+
 export class VoiceService {
   private recognition: any = null;
   private currentAudio: HTMLAudioElement | null = null;
@@ -26,9 +42,18 @@ export class VoiceService {
   private isSpeakingInternal = false;
   private callbacks: VoiceServiceCallbacks = {};
   private destroyed = false;
+  private letterStream: LetterStream;
+  private expectedLetters: number | null = null;
 
   constructor(callbacks: VoiceServiceCallbacks = {}) {
     this.callbacks = callbacks;
+    this.letterStream = new LetterStream({
+      onFinal: ({ transcript, confidence, speechOnsetMs }) => {
+        if (speechOnsetMs !== null) stimulusTiming.speechOnset(speechOnsetMs);
+        console.log(`✅ VoiceService: Captured speech: "${transcript}" (${(confidence * 100).toFixed(0)}% confidence)`);
+        this.callbacks.onUserSpeech?.(transcript, confidence);
+      },
+    });
     console.log('🎤 VoiceService: Initializing...');
     this.initializeSpeechRecognition();
   }
@@ -44,26 +69,32 @@ export class VoiceService {
     }
 
     this.recognition = new SpeechRecognition();
-    this.recognition.continuous = false; // One utterance at a time
-    this.recognition.interimResults = false; // Only final results
-    this.recognition.lang = 'en-US';
+    // Interim results so a full letter line finalizes before end-of-speech;
+    // LetterStream ends each utterance (continuous mode won't)
+    configureStreamingRecognition(this.recognition);
 
     this.recognition.onstart = () => {
       console.log('👂 VoiceService: Listening started');
+      this.letterStream.reset(this.expectedLetters);
       this.isListeningInternal = true;
       this.callbacks.onListening?.(true);
     };
 
+    this.recognition.onspeechstart = (event: any) => {
+      this.letterStream.markSpeech(event.timeStamp || performance.now());
+    };
+
     this.recognition.onresult = (event: any) => {
-      const last = event.results.length - 1;
-      const transcript = event.results[last][0].transcript.trim();
-      const confidence = event.results[last][0].confidence;
-      
-      console.log(`✅ VoiceService: Captured speech: "${transcript}" (${(confidence * 100).toFixed(0)}% confidence)`);
-      this.callbacks.onUserSpeech?.(transcript, confidence);
+      if (this.letterStream.handleResult(event)) {
+        this.recognition?.abort();
+      }
     };
 
     this.recognition.onerror = (event: any) => {
+      if (event.error === 'aborted') {
+        // Our own abort() after LetterStream finalized the utterance
+        return;
+      }
       if (event.error === 'no-speech') {
         console.log('⚠️ VoiceService: No speech detected, will retry...');
       } else {
@@ -81,6 +112,13 @@ export class VoiceService {
     console.log('✅ VoiceService: Speech recognition initialized');
   }
 
+  /**
+   * Letter count of the chart line the patient reads next (null: none up)
+   */
+  expectLetters(count: number | null) {
+    this.expectedLetters = count;
+  }
+
   /**
    * Start listening for user speech
    * Called automatically after agent finishes speaking
@@ -160,9 +198,9 @@ export class VoiceService {
       this.isSpeakingInternal = true;
       this.callbacks.onAgentSpeaking?.(true);
 
-      // Get audio from ElevenLabs TTS
+      // Get audio from ElevenLabs TTS (chunked stream from the backend)
       console.log('📡 VoiceService: Fetching TTS audio from backend...');
-      const response = await fetch('/api/voice/tts', {
+      const response = await fetch('/api/voice/tts/stream', {
         method: 'POST',
         headers: { 'Content-Type': 'application/json' },
         body: JSON.stringify({ 
@@ -176,14 +214,22 @@ export class VoiceService {
         throw new Error(`TTS API failed (${response.status}): ${errorText}`);
       }
 
-      const audioBlob = await response.blob();
-      console.log(`✅ VoiceService: Got audio blob: ${audioBlob.size} bytes, type: ${audioBlob.type}`);
-      
-      if (audioBlob.size < 1000) {
-        console.warn('⚠️ VoiceService: Audio blob suspiciously small, might be mock audio');
+      let audioUrl: string;
+      let audioType = 'audio/mpeg';
+      if (canStreamAudio(response)) {
+        // Play progressively: chunks are appended to a MediaSource as they arrive
+        audioUrl = this.attachMediaSource(response);
+      } else {
+        const audioBlob = await response.blob();
+        audioType = audioBlob.type;
+        console.log(`✅ VoiceService: Got audio blob: ${audioBlob.size} bytes, type: ${audioBlob.type}`);
+
+        if (audioBlob.size < 1000) {
+          console.warn('⚠️ VoiceService: Audio blob suspiciously small, might be mock audio');
+        }
+        audioUrl = URL.createObjectURL(audioBlob);
       }
 
-      const audioUrl = URL.createObjectURL(audioBlob);
       this.currentAudio = new Audio(audioUrl);
       
       // Set up event handlers BEFORE playing
@@ -205,7 +251,7 @@ export class VoiceService {
       this.currentAudio.onerror = (e) => {
         console.error('❌ VoiceService: Audio playback error:', e);
         console.error('   Audio URL:', audioUrl);
-        console.error('   Audio type:', audioBlob.type);
+        console.error('   Audio type:', audioType);
         this.isSpeakingInternal = false;
         this.callbacks.onAgentSpeaking?.(false);
         URL.revokeObjectURL(audioUrl);
@@ -245,6 +291,39 @@ export class VoiceService {
     }
   }
 
+  /**
+   * Feed a streamed MP3 response into a MediaSource and return its object URL
+   */
+  private attachMediaSource(response: Response): string {
+    const mediaSource = new MediaSource();
+    const reader = response.body!.getReader();
+
+    mediaSource.addEventListener('sourceopen', async () => {
+      const sourceBuffer = mediaSource.addSourceBuffer('audio/mpeg');
+      const appended = () =>
+        new Promise<void>((resolve) => sourceBuffer.addEventListener('updateend', () => resolve(), { once: true }));
+
+      try {
+        for (;;) {
+          const { done, value } = await reader.read();
+          if (done || this.destroyed) break;
+          sourceBuffer.appendBuffer(value);
+          await appended();
+        }
+        if (mediaSource.readyState === 'open') {
+          mediaSource.endOfStream();
+        }
+      } catch (error) {
+        console.error('❌ VoiceService: Audio stream error:', error);
+        if (mediaSource.readyState === 'open') {
+          mediaSource.endOfStream('network');
+        }
+      }
+    }, { once: true });
+
+    return URL.createObjectURL(mediaSource);
+  }
+
   /**
    * Stop current speech
    */
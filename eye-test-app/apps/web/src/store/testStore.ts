@@ -1,8 +1,14 @@
 /**
  * Global test state management using Zustand
+ *
+ * Exam state only; voice/conversation state lives in useVoiceStore.
+ * Subscribe with a selector (or useShallow for several fields) so a
+ * component re-renders only for the fields it reads.
  */
 
 import { create } from 'zustand';
+import { useShallow } from 'zustand/react/shallow';
+import { useVoiceStore } from './voiceStore';
 
 export type Eye = 'OD' | 'OS';
 export type Stage = 'idle' | 'calibration' | 'sphere_od' | 'sphere_os' | 'jcc_od' | 'jcc_os' | 'complete';
@@ -13,27 +19,6 @@ interface CalibrationData {
   pixelsPerArcmin: number;
 }
 
-interface PatientTranscription {
-  timestamp: number;
-  text: string;
-  eye: Eye;
-  line: number;
-  stage: string;
-}
-
-interface XAIAnalysis {
-  timestamp: number;
-  patientSpeech: string;
-  expectedLetters: string;
-  correct: boolean;
-  confidence: number;
-  suggestedDiopter: number;
-  recommendation: string;
-  reasoning: string;
-  eye: Eye;
-  line: number;
-}
-
 interface TestState {
   // Session
   sessionId: string | null;
@@ -52,15 +37,6 @@ interface TestState {
   jccState: Record<Eye, any>;
   jccResults: Record<Eye, { axis: number; cyl: number; confidence: number } | null>;
 
-  // Voice
-  isListening: boolean;
-  lastTranscript: string;
-
-  // Patient transcriptions and AI analysis
-  patientTranscriptions: PatientTranscription[];
-  xaiAnalyses: XAIAnalysis[];
-  currentAnalysis: XAIAnalysis | null;
-
   // UI state
   showGrokHint: boolean;
   grokMessage: string;
@@ -76,11 +52,6 @@ interface TestState {
   setSphereResult: (eye: Eye, result: any) => void;
   setJccState: (eye: Eye, state: any) => void;
   setJccResult: (eye: Eye, result: any) => void;
-  setListening: (listening: boolean) => void;
-  setTranscript: (text: string) => void;
-  addPatientTranscription: (transcription: PatientTranscription) => void;
-  addXAIAnalysis: (analysis: XAIAnalysis) => void;
-  setCurrentAnalysis: (analysis: XAIAnalysis | null) => void;
   showGrok: (message: string) => void;
   hideGrok: () => void;
   setElevenLabsReady: (ready: boolean) => void;
@@ -98,11 +69,6 @@ const initialState = {
   sphereResults: { OD: null, OS: null },
   jccState: { OD: null, OS: null },
   jccResults: { OD: null, OS: null },
-  isListening: false,
-  lastTranscript: '',
-  patientTranscriptions: [] as PatientTranscription[],
-  xaiAnalyses: [] as XAIAnalysis[],
-  currentAnalysis: null as XAIAnalysis | null,
   showGrokHint: false,
   grokMessage: '',
   elevenLabsReady: false,
@@ -142,28 +108,29 @@ export const useTestStore = create<TestState>((set) => ({
       jccResults: { ...prev.jccResults, [eye]: result } 
     })),
 
-  setListening: (listening) => set({ isListening: listening }),
-  setTranscript: (text) => set({ lastTranscript: text }),
-
-  addPatientTranscription: (transcription) =>
-    set((prev) => ({
-      patientTranscriptions: [...prev.patientTranscriptions, transcription],
-    })),
-
-  addXAIAnalysis: (analysis) =>
-    set((prev) => ({
-      xaiAnalyses: [...prev.xaiAnalyses, analysis],
-      currentAnalysis: analysis,
-    })),
-
-  setCurrentAnalysis: (analysis) => set({ currentAnalysis: analysis }),
-
   showGrok: (message) => set({ showGrokHint: true, grokMessage: message }),
   hideGrok: () => set({ showGrokHint: false, grokMessage: '' }),
 
   setElevenLabsReady: (ready) => set({ elevenLabsReady: ready }),
   setCurrentTestLine: (line) => set({ currentTestLine: line }),
 
-  reset: () => set(initialState),
+  reset: () => {
+    set(initialState);
+    useVoiceStore.getState().reset();
+  },
 }));
 
+
+/**
+ * Subscribe to a slice of the store, compared shallowly: re-renders only
+ * when one of `keys` changes (e.g. useTestSlice('stage', 'setStage'))
+ */
+export function useTestSlice<K extends keyof TestState>(...keys: K[]): Pick<TestState, K> {
+  return useTestStore(
+    useShallow((state) => {
+      const slice = {} as Pick<TestState, K>;
+      for (const key of keys) slice[key] = state[key];
+      return slice;
+    })
+  );
+}
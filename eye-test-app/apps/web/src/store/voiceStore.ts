@@ -0,0 +1,99 @@
+/**
+ * High-frequency conversation and voice state
+ *
+ * Kept out of useTestStore on purpose: transcripts, chat messages and
+ * listening/speaking flags change several times a second during an exam,
+ * and only the conversation UI should re-render for them. Exam pages read
+ * the one thing they need (e.g. the latest transcription) with a selector.
+ */
+
+import { create } from 'zustand';
+import type { Eye } from './testStore';
+
+export interface PatientTranscription {
+  timestamp: number;
+  text: string;
+  eye: Eye;
+  line: number;
+  stage: string;
+}
+
+export interface XAIAnalysis {
+  timestamp: number;
+  patientSpeech: string;
+  expectedLetters: string;
+  correct: boolean;
+  confidence: number;
+  suggestedDiopter: number;
+  recommendation: string;
+  reasoning: string;
+  eye: Eye;
+  line: number;
+}
+
+export interface ConversationMessage {
+  id: string;
+  type: 'user' | 'agent';
+  text: string;
+  timestamp: number;
+}
+
+interface VoiceState {
+  isListening: boolean;
+  isAgentSpeaking: boolean;
+  lastTranscript: string;
+  messages: ConversationMessage[];
+
+  // Patient transcriptions and AI analysis
+  patientTranscriptions: PatientTranscription[];
+  xaiAnalyses: XAIAnalysis[];
+  currentAnalysis: XAIAnalysis | null;
+
+  // Actions
+  setListening: (listening: boolean) => void;
+  setAgentSpeaking: (speaking: boolean) => void;
+  setTranscript: (text: string) => void;
+  addMessage: (message: ConversationMessage) => void;
+  addPatientTranscription: (transcription: PatientTranscription) => void;
+  addXAIAnalysis: (analysis: XAIAnalysis) => void;
+  setCurrentAnalysis: (analysis: XAIAnalysis | null) => void;
+  reset: () => void;
+}
+
+const initialState = {
+  isListening: false,
+  isAgentSpeaking: false,
+  lastTranscript: '',
+  messages: [] as ConversationMessage[],
+  patientTranscriptions: [] as PatientTranscription[],
+  xaiAnalyses: [] as XAIAnalysis[],
+  currentAnalysis: null as XAIAnalysis | null,
+};
+
+export const useVoiceStore = create<VoiceState>((set) => ({
+  ...initialState,
+
+  setListening: (listening) => set({ isListening: listening }),
+  setAgentSpeaking: (speaking) => set({ isAgentSpeaking: speaking }),
+  setTranscript: (text) => set({ lastTranscript: text }),
+
+  addMessage: (message) =>
+    set((prev) => ({
+      messages: [...prev.messages, message],
+    })),
+
+  addPatientTranscription: (transcription) =>
+    set((prev) => ({
+      patientTranscriptions: [...prev.patientTranscriptions, transcription],
+    })),
+
+  addXAIAnalysis: (analysis) =>
+    set((prev) => ({
+      xaiAnalyses: [...prev.xaiAnalyses, analysis],
+      currentAnalysis: analysis,
+    })),
+
+  setCurrentAnalysis: (analysis) => set({ currentAnalysis: analysis }),
+
+  reset: () => set(initialState),
+}));
@@ -1,8 +1,21 @@
+import { fileURLToPath } from 'node:url'
 import { defineConfig } from 'vite'
 import react from '@vitejs/plugin-react'
 
+const workspaceSource = (path: string) => fileURLToPath(new URL(`../../packages/${path}`, import.meta.url))
+
 export default defineConfig({
   plugins: [react()],
+  resolve: {
+    // Workspace packages build to CommonJS for the API; the browser bundle
+    // (workers included) compiles their TypeScript source instead, so it
+    // needs no prebuilt dist and keeps named ESM imports
+    alias: {
+      '@OptiX/core': workspaceSource('core/src/index.ts'),
+      // Only the dependency-free prompts entry; the rest of @OptiX/voice is server-side
+      '@OptiX/voice/prompts': workspaceSource('voice/src/prompts.ts'),
+    },
+  },
   server: {
     port: 5173,
     proxy: {
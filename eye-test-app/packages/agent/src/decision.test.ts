@@ -0,0 +1,108 @@
+/**
+ * Exam prompts through the local transition table
+ */
+
+import { describe, expect, it } from "vitest";
+import { decideLocally } from "./decision";
+
+// [stage, examiner message, expected tool calls]; messages are the ones the
+// exam actually speaks or sends (sources noted per group)
+const CASES: Array<[string, string, string[]]> = [
+  // apps/api/src/routes/elevenlabs.ts agent script
+  ["calibration", "Hello! Let's test your right eye. Cover your left eye and read line 1.", ["complete_calibration"]],
+  ["sphere_od", "Hello! Let's test your right eye. Cover your left eye and read line 1.", []],
+  ["sphere_od", "Correct! Please read line 2.", []],
+  ["sphere_od", "Great job! Now cover your right eye and test the left.", ["complete_sphere_test"]],
+  ["sphere_os", "Both eyes tested! Moving to astigmatism check.", ["complete_sphere_test"]],
+
+  // apps/web/src/utils/elevenLabsMessenger.ts
+  ["sphere_od", "The patient is ready to test their right eye. Ask them to cover their left eye and read line 1 (the letter E).", []],
+  ["sphere_od", 'Perfect! The patient correctly read line 3. Now ask them to read line 4: "L P E D"', []],
+  [
+    "sphere_od",
+    'The patient said "F" but line 2 shows "F P". Be encouraging and ask them to try again, or if they\'re struggling, we may have found their limit.',
+    [],
+  ],
+  [
+    "sphere_od",
+    "Great work on the right eye! Now ask the patient to cover their right eye and test the left eye. Start with line 1 again.",
+    ["complete_sphere_test"],
+  ],
+  [
+    "sphere_od",
+    "Excellent work! The right eye test is complete. The patient read up to line 8. Now we will test the left eye.",
+    ["record_sphere_result", "complete_sphere_test"],
+  ],
+  ["sphere_os", "The patient is ready to test their right eye. Ask them to cover their left eye and read line 1 (the letter E).", []],
+  [
+    "sphere_os",
+    "Excellent work! The left eye test is complete. The patient read up to line 7. Both eyes are tested. Moving to astigmatism test.",
+    ["record_sphere_result", "complete_sphere_test"],
+  ],
+  ["jcc_od", 'Now we\'re testing for astigmatism in the right eye. Ask the patient: "Which image looks clearer: one, or two?"', []],
+  ["jcc_od", "Got it, the patient chose option 2. I'm processing that now.", []],
+  ["jcc_od", "Okay, here's the next comparison. Ask again: Which is clearer, one or two?", []],
+  ["jcc_os", "Tell me when you're done comparing.", []],
+  [
+    "jcc_os",
+    "Perfect! The left eye astigmatism test is complete. Cylinder: -0.75D at 90 degrees. All tests complete! Great job!",
+    ["complete_astigmatism_test"],
+  ],
+
+  // packages/voice/src/prompts.ts (SpokenPrompts)
+  ["sphere_od", "Let's test your right eye. Please cover your left eye with your hand and read the letters on line 1.", []],
+  ["sphere_od", "Correct! Now please read line 5.", []],
+  ["sphere_od", "Let's try the next line. Please read line 6.", []],
+  ["sphere_od", "Let's try that again. Please read line 6.", []],
+  ["sphere_od", "I had trouble analyzing that. Please read line 6 again.", []],
+  ["sphere_od", "Excellent work on the right eye! Now let's test your left eye.", ["complete_sphere_test"]],
+  ["sphere_os", "Let's test your left eye. Please cover your right eye with your hand and read the letters on line 1.", []],
+  ["sphere_os", "Correct! Now please read line 5.", []],
+  ["sphere_os", "Perfect! Both eyes tested. Now we'll check for astigmatism.", ["complete_sphere_test"]],
+
+  // apps/web/src/services/conversationManager.ts
+  [
+    "calibration",
+    'Great! When you\'ve adjusted the card size and distance, click the "Continue to Test" button to proceed.',
+    [],
+  ],
+  ["calibration", "Perfect! Take your time with the calibration. Let me know when you're ready to continue.", []],
+  [
+    "sphere_od",
+    "Let's test your right eye. Please cover your left eye and look at the chart. Read the letters you see on each line.",
+    [],
+  ],
+  [
+    "sphere_od",
+    "Great! Now let's test your left eye. Please cover your right eye and read the letters on the chart.",
+    ["complete_sphere_test"],
+  ],
+  [
+    "sphere_os",
+    "Now we'll check for astigmatism in your right eye. I'll show you two images. Tell me which looks clearer - one or two.",
+    ["complete_sphere_test"],
+  ],
+  ["jcc_os", "Now checking astigmatism in your left eye. Which image looks clearer - one or two?", []],
+];
+
+describe("decideLocally", () => {
+  it.each(CASES)("%s: %s", (stage, message, expected) => {
+    const decision = decideLocally(message, { stage });
+    expect(decision.toolCalls.map((call) => call.name)).toEqual(expected);
+  });
+
+  it("records a reached line with the completion", () => {
+    const decision = decideLocally(
+      "Excellent work! The right eye test is complete. The patient read up to line 8. Now we will test the left eye.",
+      { stage: "sphere_od", currentEye: "OD" }
+    );
+    expect(decision.toolCalls[0]).toEqual({ name: "record_sphere_result", parameters: { eye: "OD", bestLine: 8 } });
+    expect(decision.nextStage).toBe("sphere_os");
+  });
+
+  it("waits on a negated completion instead of advancing", () => {
+    const decision = decideLocally("The right eye test isn't complete yet.", { stage: "sphere_od" });
+    expect(decision.toolCalls).toEqual([]);
+    expect(decision.ambiguous).toBe(true);
+  });
+});
@@ -0,0 +1,259 @@
+/**
+ * Local exam-progression decisions for AI-examiner messages
+ *
+ * Replaces an LLM tool-calling round trip per utterance with a transition
+ * table compiled once at load: per stage, conjunctive regex rules map a
+ * message to the app tools that move the exam forward, and each rule's
+ * resulting stage comes from the Dedalus state machine (getNextStage).
+ * Every group pairs a completion or move verb with its target, because the
+ * examiner's own instructions ("cover your left eye and read line 1") are
+ * fed through here too. Values such as "read up to line 8" or
+ * "60 centimeters" are extracted locally.
+ * Messages that hint at progress but match no rule, or that negate one in
+ * the clause it matched, are flagged ambiguous so the caller can opt into
+ * an LLM fallback.
+ */
+
+import { Tool, ToolContext, getNextStage } from "./dedalus";
+
+type Stage = ToolContext["stage"];
+
+export interface AppToolCall {
+  name: string;
+  parameters: Record<string, unknown>;
+}
+
+export interface ExamState {
+  stage: string;
+  currentEye?: "OD" | "OS";
+}
+
+export interface LocalDecision {
+  toolCalls: AppToolCall[];
+  rule: string | null; // Name of the matched rule
+  nextStage: string;
+  ambiguous: boolean; // Needs judgment the table can't provide
+}
+
+interface Rule {
+  name: string;
+  anyOf: RegExp[][]; // Matches when every regex of any one group matches
+  tool?: Tool; // Dedalus tool the transition corresponds to
+  nextStage?: Stage; // For UI steps with no Dedalus tool
+  calls: (values: ExtractedValues, state: ExamState) => AppToolCall[];
+}
+
+interface CompiledRule extends Rule {
+  nextStage: Stage;
+}
+
+interface ExtractedValues {
+  line?: number;
+  distanceCm?: number;
+  cardWidthPx?: number;
+}
+
+// Card width when only a distance is given (typical credit card at ~96 ppi)
+const DEFAULT_CARD_WIDTH_PX = 320;
+
+const all = (...sources: string[]) => sources.map((source) => new RegExp(source, "i"));
+
+const DONE = "\\b(complete|done|finished)\\b";
+const MOVE = "(move|moving|proceed|proceeding|switch|switching)";
+
+const START_RULES: Rule[] = [
+  {
+    name: "start_calibration",
+    nextStage: "calibration",
+    anyOf: [all("\\bstart(ing)?\\b"), all("\\bbegin"), all("\\bcalibrat")],
+    calls: () => [{ name: "navigate_to_stage", parameters: { stage: "calibration" } }],
+  },
+];
+
+const CALIBRATION_RULES: Rule[] = [
+  {
+    name: "calibration_complete",
+    tool: "calibrate",
+    anyOf: [
+      all("calibration", DONE),
+      all(`\\b${MOVE} (on )?to (the |your )?(vision |eye |sphere )?(test|chart)\\b`),
+      all("\\btest(ing)? (your |the |their )?(right|first) eye\\b"),
+    ],
+    calls: () => [{ name: "complete_calibration", parameters: {} }],
+  },
+];
+
+const sphereComplete = (name: string, eye: "OD" | "OS", anyOf: RegExp[][]): Rule => ({
+  name,
+  tool: "staircase.next",
+  anyOf,
+  calls: ({ line }) => [
+    ...(line !== undefined ? [{ name: "record_sphere_result", parameters: { eye, bestLine: line } }] : []),
+    { name: "complete_sphere_test", parameters: {} },
+  ],
+});
+
+const SPHERE_OD_RULES: Rule[] = [
+  sphereComplete("sphere_od_complete", "OD", [
+    all("right eye", DONE),
+    all("\\bnow\\b", "\\btest(ing)? (the |your |their )?(left|other)\\b"),
+    all("\\bnow\\b", "\\bcover (the |your |their )?right eye"),
+    all("\\btest(ing)? (the |your |their )?left eye", "\\bcover (the |your |their )?right eye"),
+    all(`\\b${MOVE} (on )?to (the |your )?(left|other) eye`),
+  ]),
+];
+
+const SPHERE_OS_RULES: Rule[] = [
+  sphereComplete("sphere_os_complete", "OS", [
+    all("left eye", DONE),
+    all("both eyes", `${DONE}|\\btested\\b`),
+    all(`\\b${MOVE} (on )?to (the |an )?(astigmatism|next (test|phase))`),
+    all("\\bnow\\b", "\\b(test|check)(ing)? (for )?astigmatism"),
+  ]),
+];
+
+const JCC_RULES: Rule[] = [
+  {
+    name: "astigmatism_complete",
+    tool: "jcc.next",
+    anyOf: [
+      all("astigmatism", DONE),
+      all("\\ball (the )?tests\\b", DONE),
+      all("\\bshow", "\\bresults?\\b"),
+    ],
+    calls: () => [{ name: "complete_astigmatism_test", parameters: {} }],
+  },
+];
+
+function compile(stage: Stage, rules: Rule[]): CompiledRule[] {
+  return rules.map((rule) => ({
+    ...rule,
+    nextStage: rule.nextStage ?? (rule.tool ? getNextStage(stage, rule.tool) : stage),
+  }));
+}
+
+const TRANSITIONS: Partial<Record<Stage, CompiledRule[]>> = {
+  idle: compile("idle", START_RULES),
+  calibration: compile("calibration", CALIBRATION_RULES),
+  sphere_od: compile("sphere_od", SPHERE_OD_RULES),
+  sphere_os: compile("sphere_os", SPHERE_OS_RULES),
+  jcc_od: compile("jcc_od", JCC_RULES),
+  jcc_os: compile("jcc_os", JCC_RULES),
+};
+
+const NEGATION = /\b(not|almost|yet|before|until)\b|n't\b/i;
+// Negation only counts in the clause a rule matched: "Don't worry, now
+// let's test your left eye" still advances
+const CLAUSE_BOUNDARY = /[.!?;,]+|\b(?:but|then)\b/gi;
+const PROGRESS_HINT = /\b(complete|done|finish(ed)?|move on|next|proceed|continue)\b/i;
+
+const UNITS: Record<string, number> = {
+  one: 1, two: 2, three: 3, four: 4, five: 5, six: 6, seven: 7, eight: 8, nine: 9,
+  ten: 10, eleven: 11, twelve: 12,
+};
+const TENS: Record<string, number> = {
+  twenty: 20, thirty: 30, forty: 40, fifty: 50, sixty: 60, seventy: 70, eighty: 80, ninety: 90,
+};
+
+const NUMBER = `(\\d+|(?:${Object.keys(TENS).join("|")})(?:[\\s-](?:${Object.keys(UNITS).slice(0, 9).join("|")}))?|${Object.keys(UNITS).join("|")})`;
+// Only a line the patient reached: "read line 2" is an instruction, not a result
+const LINE_PATTERN = new RegExp(
+  `\\b(?:(?:up|down|got|made it) to|through|reached|best)\\s+line\\s+(?:number\\s+)?${NUMBER}\\b`,
+  "i"
+);
+const DISTANCE_PATTERN = new RegExp(`\\b${NUMBER}\\s*(?:cm|centimet(?:er|re)s?)\\b`, "i");
+const CARD_PATTERN = new RegExp(`\\b${NUMBER}\\s*(?:px|pixels?)\\b`, "i");
+
+function parseNumber(token: string): number {
+  if (/^\d+$/.test(token)) return Number(token);
+  const [tens, units] = token.toLowerCase().split(/[\s-]/);
+  return (TENS[tens] ?? UNITS[tens] ?? 0) + (units ? UNITS[units] ?? 0 : 0);
+}
+
+function extract(pattern: RegExp, message: string, min: number, max: number): number | undefined {
+  const match = pattern.exec(message);
+  if (!match) return undefined;
+  const value = parseNumber(match[1]);
+  return value >= min && value <= max ? value : undefined;
+}
+
+/**
+ * [start, end) offsets of each clause in a message
+ */
+function clauseSpans(message: string): Array<[number, number]> {
+  const spans: Array<[number, number]> = [];
+  let start = 0;
+  for (const boundary of message.matchAll(CLAUSE_BOUNDARY)) {
+    spans.push([start, boundary.index!]);
+    start = boundary.index! + boundary[0].length;
+  }
+  spans.push([start, message.length]);
+  return spans;
+}
+
+/**
+ * Whether any clause holding one of the group's matches is negated
+ */
+function negatedInClause(message: string, group: RegExp[]): boolean {
+  const spans = clauseSpans(message);
+  return group.some((pattern) => {
+    const match = pattern.exec(message);
+    if (!match) return false;
+    const span = spans.find(([start, end]) => match.index >= start && match.index < end);
+    return span !== undefined && NEGATION.test(message.slice(span[0], span[1]));
+  });
+}
+
+/**
+ * Decide which app tools a message calls for in the current stage
+ */
+export function decideLocally(message: string, state: ExamState): LocalDecision {
+  const values: ExtractedValues = {
+    line: extract(LINE_PATTERN, message, 1, 11),
+    distanceCm: extract(DISTANCE_PATTERN, message, 20, 200),
+    cardWidthPx: extract(CARD_PATTERN, message, 100, 2000),
+  };
+
+  const rules = TRANSITIONS[state.stage as Stage] ?? [];
+  let rule: CompiledRule | undefined;
+  let matchedGroup: RegExp[] | undefined;
+  for (const candidate of rules) {
+    matchedGroup = candidate.anyOf.find((group) => group.every((pattern) => pattern.test(message)));
+    if (matchedGroup) {
+      rule = candidate;
+      break;
+    }
+  }
+
+  const toolCalls: AppToolCall[] = [];
+  if (state.stage === "calibration" && values.distanceCm !== undefined) {
+    toolCalls.push({
+      name: "set_calibration",
+      parameters: {
+        cardWidthPx: values.cardWidthPx ?? DEFAULT_CARD_WIDTH_PX,
+        viewingDistanceCm: values.distanceCm,
+      },
+    });
+  }
+
+  if (rule && matchedGroup && negatedInClause(message, matchedGroup)) {
+    // "not done yet", "before we move to the left eye": don't advance on a guess
+    return { toolCalls, rule: null, nextStage: state.stage, ambiguous: true };
+  }
+
+  if (rule) {
+    toolCalls.push(...rule.calls(values, state));
+  } else if (state.stage.startsWith("sphere") && values.line !== undefined) {
+    toolCalls.push({
+      name: "record_sphere_result",
+      parameters: { eye: state.currentEye ?? (state.stage === "sphere_os" ? "OS" : "OD"), bestLine: values.line },
+    });
+  }
+
+  return {
+    toolCalls,
+    rule: rule?.name ?? null,
+    nextStage: rule?.nextStage ?? state.stage,
+    ambiguous: !rule && toolCalls.length === 0 && PROGRESS_HINT.test(message),
+  };
+}
@@ -3,6 +3,8 @@
  * Decides which tool/action to invoke next
  */
 
+import { packageLog } from "@OptiX/upstream";
+
 export type Tool =
   | "tts"
   | "stt"
@@ -48,7 +50,7 @@ export interface ToolDecision {
  * Main Dedalus router - decides next tool to invoke
  */
 export function dedalusDecide(context: ToolContext): ToolDecision {
-  console.log(`🎯 Dedalus routing: stage=${context.stage}, calibrated=${context.calibrated}`);
+  packageLog.debug(`🎯 Dedalus routing: stage=${context.stage}, calibrated=${context.calibrated}`);
 
   // 1. Calibration phase
   if (!context.calibrated) {
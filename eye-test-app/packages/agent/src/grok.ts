@@ -2,7 +2,10 @@
  * xAI Grok integration for realtime policy adjustment
  */
 
-import fetch from "node-fetch";
+import { packageLog, upstreamJson } from "@OptiX/upstream";
+
+// Overridable so load tests can point at a mock upstream
+const XAI_API_URL = process.env.XAI_API_URL || "https://api.x.ai/v1/chat/completions";
 
 export interface LiveSignals {
   misses: number;
@@ -24,27 +27,51 @@ export interface GrokHint {
   };
 }
 
+export interface GrokHintOptions {
+  signal?: AbortSignal; // Abort the upstream call (e.g. on a deadline)
+}
+
+export interface GrokHintResult {
+  hint: GrokHint;
+  source: "grok" | "fallback"; // Which path actually produced the hint
+}
+
 /**
  * Call xAI Grok for realtime test optimization hints
+ * Falls back to rule-based hints on any error, including an aborted signal
  */
-export async function grokHint(signals: LiveSignals): Promise<GrokHint> {
+export async function grokHint(
+  signals: LiveSignals,
+  options: GrokHintOptions = {}
+): Promise<GrokHint> {
+  return (await grokHintWithSource(signals, options)).hint;
+}
+
+/**
+ * grokHint, also reporting whether Grok answered or the fallback did
+ */
+export async function grokHintWithSource(
+  signals: LiveSignals,
+  options: GrokHintOptions = {}
+): Promise<GrokHintResult> {
   const apiKey = process.env.XAI_GROK_API_KEY;
 
   if (!apiKey) {
-    console.warn("⚠️  XAI_GROK_API_KEY not set, using rule-based fallback");
-    return grokFallback(signals);
+    packageLog.sampled("warn", "⚠️  XAI_GROK_API_KEY not set, using rule-based fallback");
+    return { hint: grokFallback(signals), source: "fallback" };
   }
 
   try {
-    console.log(`🤖 Grok analyzing live signals: conf=${signals.confidence.toFixed(2)}, misses=${signals.misses}`);
+    packageLog.debug(`🤖 Grok analyzing live signals: conf=${signals.confidence.toFixed(2)}, misses=${signals.misses}`);
 
-    const response = await fetch("https://api.x.ai/v1/chat/completions", {
-      method: "POST",
+    // Identical signals in flight (e.g. both eyes stalled alike) share one call
+    const data: any = await upstreamJson(XAI_API_URL, {
       headers: {
-        "Content-Type": "application/json",
         Authorization: `Bearer ${apiKey}`,
       },
-      body: JSON.stringify({
+      signal: options.signal,
+      coalesce: true,
+      json: {
         model: "grok-beta",
         messages: [
           {
@@ -68,25 +95,20 @@ Recommend ONE specific adjustment. Be concise.`,
         ],
         temperature: 0.7,
         max_tokens: 150,
-      }),
+      },
     });
 
-    if (!response.ok) {
-      throw new Error(`Grok API error: ${response.statusText}`);
-    }
-
-    const data: any = await response.json();
     const content = data.choices?.[0]?.message?.content || "";
 
     // Parse response
     const hint = parseGrokResponse(content, signals);
     
-    console.log(`🤖 Grok suggestion: ${hint.suggestion} (${hint.reason})`);
+    packageLog.sampled("info", `🤖 Grok suggestion: ${hint.suggestion} (${hint.reason})`);
 
-    return hint;
+    return { hint, source: "grok" };
   } catch (error) {
-    console.error("Grok API error:", error);
-    return grokFallback(signals);
+    packageLog.error("Grok API error", { error });
+    return { hint: grokFallback(signals), source: "fallback" };
   }
 }
 
@@ -130,7 +152,7 @@ function parseGrokResponse(content: string, signals: LiveSignals): GrokHint {
 /**
  * Rule-based fallback when Grok API unavailable
  */
-function grokFallback(signals: LiveSignals): GrokHint {
+export function grokFallback(signals: LiveSignals): GrokHint {
   const { confidence, misses, latencyMs, stage, reversals } = signals;
 
   // High misses or low confidence
@@ -5,6 +5,7 @@
 export * from "./grok";
 export * from "./photon";
 export * from "./dedalus";
+export * from "./decision";
 
 
 
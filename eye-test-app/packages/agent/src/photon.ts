@@ -3,6 +3,8 @@
  * Dynamically adjusts test difficulty based on performance
  */
 
+import { packageLog } from "@OptiX/upstream";
+
 export type RouteMode = "normal" | "easier" | "harder" | "abort";
 
 export interface RoutingContext {
@@ -37,7 +39,7 @@ export function photonRoute(context: RoutingContext): RoutingDecision {
     consecutiveCorrect,
   } = context;
 
-  console.log(`⚡ Photon routing: conf=${confidence.toFixed(2)}, latency=${latencyMs}ms, misses=${consecutiveMisses}`);
+  packageLog.debug(`⚡ Photon routing: conf=${confidence.toFixed(2)}, latency=${latencyMs}ms, misses=${consecutiveMisses}`);
 
   // ABORT conditions
   if (!fixationStable && consecutiveMisses >= 3) {
@@ -62,7 +64,7 @@ export function photonRoute(context: RoutingContext): RoutingDecision {
 
   // EASIER conditions
   if (consecutiveMisses >= 3) {
-    console.log("⚡ Photon: Switching to EASIER mode (3+ consecutive misses)");
+    packageLog.sampled("info", "⚡ Photon: Switching to EASIER mode (3+ consecutive misses)");
     return {
       mode: "easier",
       reason: "Three consecutive misses - reducing difficulty",
@@ -74,7 +76,7 @@ export function photonRoute(context: RoutingContext): RoutingDecision {
   }
 
   if (confidence < 0.4 && latencyMs > 4000) {
-    console.log("⚡ Photon: Switching to EASIER mode (low conf + high latency)");
+    packageLog.sampled("info", "⚡ Photon: Switching to EASIER mode (low conf + high latency)");
     return {
       mode: "easier",
       reason: "Low confidence with slow responses",
@@ -97,7 +99,7 @@ export function photonRoute(context: RoutingContext): RoutingDecision {
 
   // HARDER conditions
   if (consecutiveCorrect >= 5 && confidence > 0.9) {
-    console.log("⚡ Photon: Switching to HARDER mode (5+ consecutive correct)");
+    packageLog.sampled("info", "⚡ Photon: Switching to HARDER mode (5+ consecutive correct)");
     return {
       mode: "harder",
       reason: "Excellent performance - increasing challenge",
@@ -108,7 +110,7 @@ export function photonRoute(context: RoutingContext): RoutingDecision {
   }
 
   // NORMAL
-  console.log("⚡ Photon: Maintaining NORMAL mode");
+  packageLog.sampled("info", "⚡ Photon: Maintaining NORMAL mode");
   return {
     mode: "normal",
     reason: "Performance within expected range",
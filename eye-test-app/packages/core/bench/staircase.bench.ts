@@ -0,0 +1,64 @@
+/**
+ * Per-trial staircase cost as history grows
+ * Run with `pnpm --filter @OptiX/core bench`. Each case pre-fills a run of N
+ * trials, then times one next + threshold + confidence step. The copying
+ * variant reproduces the previous spread/slice implementation for reference.
+ */
+
+import { bench, describe } from "vitest";
+import {
+  initStaircase,
+  nextStairState,
+  calculateThreshold,
+  calculateConfidence,
+  StairState,
+} from "../src/staircase";
+
+const HISTORY_LENGTHS = [10, 100, 1000, 10000];
+
+// Deterministic responses that keep the staircase reversing
+function response(i: number): boolean {
+  return i % 3 !== 2;
+}
+
+function filled(n: number): StairState {
+  const state = initStaircase("OD");
+  for (let i = 0; i < n; i++) {
+    nextStairState(state, response(i));
+  }
+  return state;
+}
+
+// Previous O(n) step: copy history, then rescan it for threshold/confidence
+function copyingStep(history: Array<{ idx: number; correct: boolean }>, correct: boolean) {
+  const next = [...history, { idx: 6, correct }];
+  next.slice(-2);
+  let reversals = 0;
+  let prevDir = next[0].correct ? -1 : 1;
+  for (let i = 1; i < next.length; i++) {
+    const lastTwo = next.slice(Math.max(0, i - 1), i + 1);
+    const dir = !next[i].correct ? 1 : lastTwo.every((e) => e.correct) ? -1 : prevDir;
+    if (dir !== prevDir) reversals++;
+    prevDir = dir;
+  }
+  next.slice(-6).filter((h) => h.correct);
+  return reversals;
+}
+
+for (const n of HISTORY_LENGTHS) {
+  describe(`history length ${n}`, () => {
+    const state = filled(n);
+    const history = state.history.slice();
+    let i = n;
+
+    bench("incremental", () => {
+      nextStairState(state, response(i++));
+      calculateThreshold(state);
+      calculateConfidence(state);
+    });
+
+    bench("copying (previous)", () => {
+      copyingStep(history, response(i++));
+    });
+  });
+}
@@ -0,0 +1,90 @@
+/**
+ * Virtual patients for simulated exams
+ * Each patient has a true Rx and answers through a psychometric function
+ * with configurable slope, guess rate and lapse rate.
+ */
+
+import { Eye, JccState, LOGMAR_STEPS } from "../src";
+
+export interface PatientOptions {
+  trueLogMAR?: number;        // fixed acuity threshold, else drawn uniformly
+  trueCyl?: number;           // fixed cylinder (< 0 D), else drawn from -0.25…-2.00
+  trueAxis?: number;          // fixed axis (0-180°), else drawn
+  guessRate?: number;         // chance of a correct letter when unresolvable
+  lapseRate?: number;         // chance of a blunder at any size
+  slope?: number;             // logistic slope per logMAR
+}
+
+export interface VirtualPatient {
+  eye: Eye;
+  trueLogMAR: number;
+  trueCyl: number;
+  trueAxis: number;
+  guessRate: number;
+  lapseRate: number;
+  slope: number;
+}
+
+export type Rng = () => number;
+
+/**
+ * Small seeded PRNG (mulberry32) so runs are reproducible per worker
+ */
+export function createRng(seed: number): Rng {
+  let a = seed >>> 0;
+  return () => {
+    a = (a + 0x6d2b79f5) >>> 0;
+    let t = a;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+/**
+ * Draw a patient; unspecified Rx components are sampled from clinical ranges
+ */
+export function createPatient(options: PatientOptions, rng: Rng, eye: Eye = "OD"): VirtualPatient {
+  return {
+    eye,
+    trueLogMAR: options.trueLogMAR ?? -0.1 + rng() * 1.0,
+    trueCyl: options.trueCyl ?? -(1 + Math.floor(rng() * 8)) * 0.25,
+    trueAxis: options.trueAxis ?? Math.floor(rng() * 180),
+    guessRate: options.guessRate ?? 0.1,
+    lapseRate: options.lapseRate ?? 0.02,
+    slope: options.slope ?? 15,
+  };
+}
+
+function logistic(x: number): number {
+  return 1 / (1 + Math.exp(-x));
+}
+
+/**
+ * Read a letter at LOGMAR_STEPS[sizeIndex]; true when answered correctly
+ */
+export function respondAcuity(patient: VirtualPatient, sizeIndex: number, rng: Rng): boolean {
+  const f = logistic(patient.slope * (LOGMAR_STEPS[sizeIndex] - patient.trueLogMAR));
+  const p = patient.guessRate + (1 - patient.guessRate - patient.lapseRate) * f;
+  return rng() < p;
+}
+
+/**
+ * Pick the clearer JCC presentation (1 or 2) for the current probe
+ * Axis stage: 2 rotates positive, so prefer it when the true axis lies that way.
+ * Power stage: 1 is stronger, so prefer it when the true cylinder is stronger.
+ */
+export function respondJcc(patient: VirtualPatient, state: JccState, rng: Rng): 1 | 2 {
+  let pTwo: number;
+
+  if (state.stage === "axis") {
+    const delta = ((patient.trueAxis - state.axisDeg + 270) % 180) - 90; // [-90, 90)
+    pTwo = logistic(delta / 5);
+  } else {
+    pTwo = logistic((patient.trueCyl - state.cyl) / 0.1);
+  }
+
+  // Lapses are coin flips in a two-alternative choice
+  pTwo = patient.lapseRate / 2 + (1 - patient.lapseRate) * pTwo;
+  return rng() < pTwo ? 2 : 1;
+}
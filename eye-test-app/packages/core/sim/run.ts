@@ -0,0 +1,179 @@
+/**
+ * Simulation harness entry point
+ *
+ *   pnpm --filter @OptiX/core sim -- --exams=1000000 --workers=8
+ *   pnpm --filter @OptiX/core sim -- --write-baseline
+ *   pnpm --filter @OptiX/core sim -- --check
+ *
+ * Exams are split across worker_threads; each worker runs every suite with
+ * its own seed and the main thread merges the results. --check compares the
+ * run against sim/baseline.json and exits non-zero on a regression.
+ */
+
+import fs from "fs";
+import os from "os";
+import path from "path";
+import v8 from "v8";
+import vm from "vm";
+import { Worker, isMainThread, parentPort, workerData } from "worker_threads";
+import { PatientOptions } from "./observer";
+import {
+  SUITES,
+  SuiteName,
+  SuiteAccumulator,
+  SuiteReport,
+  runSuite,
+  mergeAccumulators,
+  toReport,
+} from "./simulate";
+
+interface WorkerJob {
+  suites: SuiteName[];
+  exams: number;
+  seed: number;
+  patient: PatientOptions;
+}
+
+interface Baseline {
+  createdAt: string;
+  node: string;
+  cpu: string;
+  reports: SuiteReport[];
+}
+
+// Allowed drift before --check fails
+const TOLERANCE = {
+  meanTrials: 0.05,       // relative increase
+  rmse: 0.1,              // relative increase
+  opsPerSec: 0.25,        // relative decrease (machine noise is large)
+  bytesPerTrial: 0.25,    // relative increase, plus 64 bytes of slack
+};
+
+const DEFAULT_BASELINE = path.join(__dirname, "baseline.json");
+
+function parseArgs(argv: string[]): Record<string, string> {
+  const args: Record<string, string> = {};
+  for (const arg of argv) {
+    const match = /^--([^=]+)(?:=(.*))?$/.exec(arg);
+    if (match) args[match[1]] = match[2] ?? "true";
+  }
+  return args;
+}
+
+function optionalNumber(value: string | undefined): number | undefined {
+  return value === undefined ? undefined : Number(value);
+}
+
+function runWorker(job: WorkerJob): Promise<SuiteAccumulator[]> {
+  return new Promise((resolve, reject) => {
+    // Inherit execArgv so the tsx loader is registered in the worker too
+    const worker = new Worker(__filename, { workerData: job, execArgv: process.execArgv });
+    worker.once("message", resolve);
+    worker.once("error", reject);
+    worker.once("exit", (code) => {
+      if (code !== 0) reject(new Error(`Simulation worker exited with code ${code}`));
+    });
+  });
+}
+
+function findRegressions(current: SuiteReport[], baseline: SuiteReport[]): string[] {
+  const problems: string[] = [];
+
+  for (const base of baseline) {
+    const now = current.find((report) => report.suite === base.suite);
+    if (!now) continue;
+
+    if (now.meanTrials > base.meanTrials * (1 + TOLERANCE.meanTrials)) {
+      problems.push(`${base.suite}: meanTrials ${base.meanTrials} → ${now.meanTrials}`);
+    }
+    if (now.rmse > base.rmse * (1 + TOLERANCE.rmse) + 0.005) {
+      problems.push(`${base.suite}: rmse ${base.rmse} → ${now.rmse}`);
+    }
+    if (now.opsPerSec < base.opsPerSec * (1 - TOLERANCE.opsPerSec)) {
+      problems.push(`${base.suite}: opsPerSec ${base.opsPerSec} → ${now.opsPerSec}`);
+    }
+    if (now.bytesPerTrial > base.bytesPerTrial * (1 + TOLERANCE.bytesPerTrial) + 64) {
+      problems.push(`${base.suite}: bytesPerTrial ${base.bytesPerTrial} → ${now.bytesPerTrial}`);
+    }
+  }
+
+  return problems;
+}
+
+async function main() {
+  const args = parseArgs(process.argv.slice(2));
+  const exams = Number(args.exams) || 200000;
+  const workers = Math.max(1, Number(args.workers) || os.cpus().length);
+  const seed = Number(args.seed) || 1;
+  const suites = (args.suites ? args.suites.split(",") : SUITES) as SuiteName[];
+  const baselinePath = args.baseline ? path.resolve(args.baseline) : DEFAULT_BASELINE;
+
+  const unknown = suites.filter((suite) => !SUITES.includes(suite));
+  if (unknown.length > 0) {
+    throw new Error(`Unknown suite(s): ${unknown.join(", ")}`);
+  }
+
+  const patient: PatientOptions = {
+    trueLogMAR: optionalNumber(args.logmar),
+    trueCyl: optionalNumber(args.cyl),
+    trueAxis: optionalNumber(args.axis),
+    guessRate: optionalNumber(args.guess),
+    lapseRate: optionalNumber(args.lapse),
+    slope: optionalNumber(args.slope),
+  };
+
+  console.log(`🧪 Simulating ${exams} exams per suite on ${workers} workers…`);
+
+  const perWorker = Math.ceil(exams / workers);
+  const jobs = Array.from({ length: workers }, (_, i) => Math.min(perWorker, exams - i * perWorker))
+    .filter((count) => count > 0)
+    .map((count, i) => runWorker({ suites, exams: count, seed: seed * 100003 + i, patient }));
+  const results = (await Promise.all(jobs)).flat();
+
+  const reports = suites.map((suite) =>
+    toReport(mergeAccumulators(results.filter((acc) => acc.suite === suite)))
+  );
+  console.table(reports);
+
+  if (args.json) {
+    console.log(JSON.stringify(reports));
+  }
+
+  if (args["write-baseline"]) {
+    const baseline: Baseline = {
+      createdAt: new Date().toISOString(),
+      node: process.version,
+      cpu: os.cpus()[0]?.model ?? "unknown",
+      reports,
+    };
+    fs.writeFileSync(baselinePath, JSON.stringify(baseline, null, 2) + "\n");
+    console.log(`✅ Baseline written to ${baselinePath}`);
+  }
+
+  if (args.check) {
+    const baseline: Baseline = JSON.parse(fs.readFileSync(baselinePath, "utf8"));
+    const problems = findRegressions(reports, baseline.reports);
+    if (problems.length > 0) {
+      console.error("❌ Regressions against baseline:");
+      problems.forEach((problem) => console.error(`  - ${problem}`));
+      process.exit(1);
+    }
+    console.log("✅ No regressions against baseline");
+  }
+}
+
+if (isMainThread) {
+  main().catch((error) => {
+    console.error("❌ Simulation failed:", error);
+    process.exit(1);
+  });
+} else {
+  const job = workerData as WorkerJob;
+
+  // Expose gc() inside the worker so the allocation probe starts from a clean heap
+  v8.setFlagsFromString("--expose-gc");
+  const gc = vm.runInNewContext("gc") as () => void;
+
+  const results = job.suites.map((suite) => runSuite(suite, job.exams, job.seed, job.patient, gc));
+  parentPort!.postMessage(results);
+}
@@ -0,0 +1,214 @@
+/**
+ * Simulated exams against the core algorithms
+ * A suite runs N exams (one virtual patient each) through an engine and
+ * accumulates mergeable statistics, so worker results can be summed.
+ */
+
+import {
+  THRESHOLD_ENGINES,
+  ThresholdEngineName,
+  initJcc,
+  nextJcc,
+  isJccComplete,
+} from "../src";
+import { PatientOptions, createPatient, createRng, respondAcuity, respondJcc } from "./observer";
+
+export type SuiteName = ThresholdEngineName | "jcc";
+export const SUITES: SuiteName[] = ["staircase", "quest", "jcc"];
+
+// Safety cap; an engine that hits it is reported through p95/maxTrials
+const MAX_TRIALS_PER_EXAM = 255;
+
+/**
+ * Raw sums for one suite (plain numbers/arrays so they cross worker boundaries)
+ */
+export interface SuiteAccumulator {
+  suite: SuiteName;
+  exams: number;
+  trials: number;
+  trialHistogram: number[];   // exams by trial count, 0…MAX_TRIALS_PER_EXAM
+  errorSum: number;           // logMAR error (acuity) or axis error in degrees (jcc)
+  errorSqSum: number;
+  cylErrorSum: number;        // jcc only, diopters
+  cylErrorSqSum: number;
+  elapsedMs: number;
+  allocatedBytes: number;     // heap growth over the allocation probe
+  probeTrials: number;
+}
+
+export interface SuiteReport {
+  suite: SuiteName;
+  exams: number;
+  meanTrials: number;
+  p95Trials: number;
+  maxTrials: number;
+  bias: number;
+  rmse: number;
+  cylBias?: number;
+  cylRmse?: number;
+  opsPerSec: number;          // trials per second per worker-core
+  examsPerSec: number;
+  bytesPerTrial: number;
+}
+
+export function emptyAccumulator(suite: SuiteName): SuiteAccumulator {
+  return {
+    suite,
+    exams: 0,
+    trials: 0,
+    trialHistogram: new Array(MAX_TRIALS_PER_EXAM + 1).fill(0),
+    errorSum: 0,
+    errorSqSum: 0,
+    cylErrorSum: 0,
+    cylErrorSqSum: 0,
+    elapsedMs: 0,
+    allocatedBytes: 0,
+    probeTrials: 0,
+  };
+}
+
+function runAcuityExam(
+  name: ThresholdEngineName,
+  options: PatientOptions,
+  rng: () => number,
+  acc: SuiteAccumulator
+) {
+  const engine = THRESHOLD_ENGINES[name];
+  const patient = createPatient(options, rng);
+  let state = engine.init(patient.eye);
+  let trials = 0;
+
+  while (!engine.isComplete(state) && trials < MAX_TRIALS_PER_EXAM) {
+    state = engine.next(state, respondAcuity(patient, engine.sizeIndex(state), rng));
+    trials++;
+  }
+
+  const error = engine.threshold(state) - patient.trueLogMAR;
+  acc.exams++;
+  acc.trials += trials;
+  acc.trialHistogram[trials]++;
+  acc.errorSum += error;
+  acc.errorSqSum += error * error;
+}
+
+function runJccExam(options: PatientOptions, rng: () => number, acc: SuiteAccumulator) {
+  const patient = createPatient(options, rng);
+  let state = initJcc(patient.eye);
+  let trials = 0;
+
+  while (!isJccComplete(state) && trials < MAX_TRIALS_PER_EXAM) {
+    state = nextJcc(state, respondJcc(patient, state, rng));
+    trials++;
+  }
+
+  const axisError = ((state.axisDeg - patient.trueAxis + 270) % 180) - 90;
+  const cylError = state.cyl - patient.trueCyl;
+  acc.exams++;
+  acc.trials += trials;
+  acc.trialHistogram[trials]++;
+  acc.errorSum += axisError;
+  acc.errorSqSum += axisError * axisError;
+  acc.cylErrorSum += cylError;
+  acc.cylErrorSqSum += cylError * cylError;
+}
+
+function runExams(
+  suite: SuiteName,
+  exams: number,
+  options: PatientOptions,
+  rng: () => number,
+  acc: SuiteAccumulator
+) {
+  for (let i = 0; i < exams; i++) {
+    if (suite === "jcc") runJccExam(options, rng, acc);
+    else runAcuityExam(suite, options, rng, acc);
+  }
+}
+
+/**
+ * Run one suite: a short allocation probe, then the timed run
+ * `gc` (when available) is called before the probe so heap growth during it
+ * approximates bytes allocated.
+ */
+export function runSuite(
+  suite: SuiteName,
+  exams: number,
+  seed: number,
+  options: PatientOptions,
+  gc?: () => void
+): SuiteAccumulator {
+  const acc = emptyAccumulator(suite);
+
+  const probe = emptyAccumulator(suite);
+  const probeExams = Math.min(exams, 100);
+  gc?.();
+  const heapBefore = process.memoryUsage().heapUsed;
+  runExams(suite, probeExams, options, createRng(seed ^ 0x9e3779b9), probe);
+  acc.allocatedBytes = Math.max(0, process.memoryUsage().heapUsed - heapBefore);
+  acc.probeTrials = probe.trials;
+
+  const start = process.hrtime.bigint();
+  runExams(suite, exams, options, createRng(seed), acc);
+  acc.elapsedMs = Number(process.hrtime.bigint() - start) / 1e6;
+
+  return acc;
+}
+
+/**
+ * Sum worker accumulators for the same suite
+ * Elapsed time is summed too, so opsPerSec stays a per-core figure.
+ */
+export function mergeAccumulators(parts: SuiteAccumulator[]): SuiteAccumulator {
+  const total = emptyAccumulator(parts[0].suite);
+  for (const part of parts) {
+    total.exams += part.exams;
+    total.trials += part.trials;
+    total.errorSum += part.errorSum;
+    total.errorSqSum += part.errorSqSum;
+    total.cylErrorSum += part.cylErrorSum;
+    total.cylErrorSqSum += part.cylErrorSqSum;
+    total.elapsedMs += part.elapsedMs;
+    total.allocatedBytes += part.allocatedBytes;
+    total.probeTrials += part.probeTrials;
+    part.trialHistogram.forEach((count, trials) => {
+      total.trialHistogram[trials] += count;
+    });
+  }
+  return total;
+}
+
+function percentile(histogram: number[], total: number, q: number): number {
+  let seen = 0;
+  for (let trials = 0; trials < histogram.length; trials++) {
+    seen += histogram[trials];
+    if (seen >= q * total) return trials;
+  }
+  return histogram.length - 1;
+}
+
+export function toReport(acc: SuiteAccumulator): SuiteReport {
+  const round = (value: number, digits: number) => Number(value.toFixed(digits));
+  const n = Math.max(1, acc.exams);
+  const seconds = Math.max(acc.elapsedMs, 1e-3) / 1000;
+  const bias = acc.errorSum / n;
+
+  const report: SuiteReport = {
+    suite: acc.suite,
+    exams: acc.exams,
+    meanTrials: round(acc.trials / n, 3),
+    p95Trials: percentile(acc.trialHistogram, acc.exams, 0.95),
+    maxTrials: acc.trialHistogram.reduce((max, count, trials) => (count ? trials : max), 0),
+    bias: round(bias, 4),
+    rmse: round(Math.sqrt(acc.errorSqSum / n), 4),
+    opsPerSec: Math.round(acc.trials / seconds),
+    examsPerSec: Math.round(acc.exams / seconds),
+    bytesPerTrial: Math.round(acc.allocatedBytes / Math.max(1, acc.probeTrials)),
+  };
+
+  if (acc.suite === "jcc") {
+    report.cylBias = round(acc.cylErrorSum / n, 4);
+    report.cylRmse = round(Math.sqrt(acc.cylErrorSqSum / n), 4);
+  }
+
+  return report;
+}
@@ -4,6 +4,8 @@
 
 export * from "./types";
 export * from "./staircase";
+export * from "./quest";
+export * from "./threshold";
 export * from "./jcc";
 export * from "./optotypes";
 
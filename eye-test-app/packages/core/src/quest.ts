@@ -0,0 +1,196 @@
+/**
+ * QUEST+ style Bayesian threshold estimation for visual acuity
+ *
+ * Keeps a posterior over the logMAR threshold on a fixed grid and, each trial,
+ * presents the LOGMAR_STEPS size that minimizes the expected posterior
+ * entropy. Stops once the posterior entropy falls below a target.
+ * The likelihood table is computed once at module load, and every update
+ * happens in place on the state's Float64Array, so a trial allocates nothing.
+ */
+
+import { Eye } from "./types";
+import { LOGMAR_STEPS } from "./staircase";
+
+export interface QuestState {
+  eye: Eye;
+  sizeIndex: number;          // next stimulus, index into LOGMAR_STEPS
+  posterior: Float64Array;    // normalized, one bin per THRESHOLD_GRID entry
+  trialCount: number;
+  misses: number;
+}
+
+// Threshold hypotheses: -0.3 … 1.3 logMAR in 0.02 steps
+const GRID_MIN = -0.3;
+const GRID_STEP = 0.02;
+const GRID_SIZE = 81;
+
+// Psychometric function (logistic in logMAR, larger letters are easier)
+const GUESS_RATE = 0.1;       // ~1 in 10 Sloan letters by chance
+const LAPSE_RATE = 0.02;
+const SLOPE = 15;             // per logMAR; ~0.15 logMAR from 25% to 75% correct
+
+// Stopping rule
+const ENTROPY_STOP_BITS = 3.4; // ≈ posterior SD of 0.05 logMAR on this grid
+const MIN_TRIALS = 5;
+const MAX_TRIALS = 30;
+const PRIOR_SD = 0.5;
+
+export const THRESHOLD_GRID = new Float64Array(GRID_SIZE);
+for (let j = 0; j < GRID_SIZE; j++) {
+  THRESHOLD_GRID[j] = GRID_MIN + j * GRID_STEP;
+}
+
+/**
+ * P(correct | stimulus i, threshold j), row-major by stimulus
+ */
+const P_CORRECT = new Float64Array(LOGMAR_STEPS.length * GRID_SIZE);
+
+for (let i = 0; i < LOGMAR_STEPS.length; i++) {
+  for (let j = 0; j < GRID_SIZE; j++) {
+    const f = 1 / (1 + Math.exp(-SLOPE * (LOGMAR_STEPS[i] - THRESHOLD_GRID[j])));
+    P_CORRECT[i * GRID_SIZE + j] = GUESS_RATE + (1 - GUESS_RATE - LAPSE_RATE) * f;
+  }
+}
+
+function xlogx(x: number): number {
+  return x > 0 ? x * Math.log(x) : 0;
+}
+
+/**
+ * Index of the stimulus with the lowest expected posterior entropy
+ */
+function selectStimulus(posterior: Float64Array): number {
+  let best = 0;
+  let bestEntropy = Infinity;
+
+  for (let i = 0; i < LOGMAR_STEPS.length; i++) {
+    const row = i * GRID_SIZE;
+    let pCorrect = 0;
+    let sumCorrect = 0;
+    let sumWrong = 0;
+
+    for (let j = 0; j < GRID_SIZE; j++) {
+      const likelihood = P_CORRECT[row + j];
+      const a = posterior[j] * likelihood;
+      const b = posterior[j] - a;
+      pCorrect += a;
+      sumCorrect += xlogx(a);
+      sumWrong += xlogx(b);
+    }
+
+    // H(post·L / p) = ln p − Σ a ln a / p, weighted by outcome probability
+    const pWrong = 1 - pCorrect;
+    const expected =
+      (pCorrect > 0 ? pCorrect * Math.log(pCorrect) - sumCorrect : 0) +
+      (pWrong > 0 ? pWrong * Math.log(pWrong) - sumWrong : 0);
+
+    if (expected < bestEntropy) {
+      bestEntropy = expected;
+      best = i;
+    }
+  }
+
+  return best;
+}
+
+/**
+ * Posterior entropy in bits
+ */
+export function questEntropy(state: QuestState): number {
+  let h = 0;
+  for (let j = 0; j < GRID_SIZE; j++) {
+    h -= xlogx(state.posterior[j]);
+  }
+  return h / Math.LN2;
+}
+
+/**
+ * Initialize a QUEST+ search for one eye
+ * The prior is a broad Gaussian centered on the start size.
+ */
+export function initQuest(eye: Eye, startIndex: number = 6): QuestState {
+  const center = LOGMAR_STEPS[startIndex] ?? LOGMAR_STEPS[6];
+  const posterior = new Float64Array(GRID_SIZE);
+  let total = 0;
+
+  for (let j = 0; j < GRID_SIZE; j++) {
+    const z = (THRESHOLD_GRID[j] - center) / PRIOR_SD;
+    posterior[j] = Math.exp(-0.5 * z * z);
+    total += posterior[j];
+  }
+  for (let j = 0; j < GRID_SIZE; j++) {
+    posterior[j] /= total;
+  }
+
+  return {
+    eye,
+    sizeIndex: selectStimulus(posterior),
+    posterior,
+    trialCount: 0,
+    misses: 0,
+  };
+}
+
+/**
+ * Fold one response into the posterior and pick the next stimulus
+ * Updates the state in place and returns it.
+ */
+export function nextQuestState(state: QuestState, wasCorrect: boolean): QuestState {
+  const row = state.sizeIndex * GRID_SIZE;
+  const posterior = state.posterior;
+  let total = 0;
+
+  for (let j = 0; j < GRID_SIZE; j++) {
+    const likelihood = P_CORRECT[row + j];
+    posterior[j] *= wasCorrect ? likelihood : 1 - likelihood;
+    total += posterior[j];
+  }
+  for (let j = 0; j < GRID_SIZE; j++) {
+    posterior[j] /= total;
+  }
+
+  state.trialCount++;
+  if (!wasCorrect) state.misses++;
+  state.sizeIndex = selectStimulus(posterior);
+  return state;
+}
+
+/**
+ * Check the entropy stopping rule (bounded by min/max trial counts)
+ */
+export function isQuestComplete(state: QuestState): boolean {
+  if (state.trialCount < MIN_TRIALS) return false;
+  if (state.trialCount >= MAX_TRIALS) return true;
+  return questEntropy(state) <= ENTROPY_STOP_BITS;
+}
+
+/**
+ * Posterior mean and standard deviation of the threshold (logMAR)
+ */
+export function questEstimate(state: QuestState): { mean: number; sd: number } {
+  let mean = 0;
+  for (let j = 0; j < GRID_SIZE; j++) {
+    mean += state.posterior[j] * THRESHOLD_GRID[j];
+  }
+  let variance = 0;
+  for (let j = 0; j < GRID_SIZE; j++) {
+    const d = THRESHOLD_GRID[j] - mean;
+    variance += state.posterior[j] * d * d;
+  }
+  return { mean, sd: Math.sqrt(variance) };
+}
+
+/**
+ * Threshold rounded to 0.01 logMAR (posterior mean, i.e. ZEST estimate)
+ */
+export function calculateQuestThreshold(state: QuestState): number {
+  return Math.round(questEstimate(state).mean * 100) / 100;
+}
+
+/**
+ * Confidence from posterior spread: SD 0.05 → 0.9, SD 0.2 → 0.6
+ */
+export function calculateQuestConfidence(state: QuestState): number {
+  const { sd } = questEstimate(state);
+  return Math.max(0.5, Math.min(0.95, 1 - 2 * sd));
+}
@@ -9,7 +9,12 @@ export interface StairState {
   sizeIndex: number;          // index into logMAR steps
   reversals: number;
   direction: -1 | 1;          // -1 smaller (harder), +1 larger (easier)
-  history: Array<{ idx: number; correct: boolean }>;
+  history: Array<{ idx: number; correct: boolean }>;  // append-only
+  // Running counters so next/threshold/confidence never rescan history
+  trialCount: number;
+  misses: number;
+  recentCorrect: number;      // bitmask of the last RECENT_WINDOW outcomes (bit 0 = latest)
+  reversalIdx: number[];      // ring of the last REVERSAL_WINDOW reversal indices
 }
 
 // Standard logMAR steps (1.0 = 20/200, 0.0 = 20/20, -0.1 = 20/16)
@@ -17,6 +22,10 @@ export const LOGMAR_STEPS = [
   1.0, 0.9, 0.8, 0.7, 0.6, 0.5, 0.4, 0.3, 0.2, 0.1, 0.0, -0.1, -0.2
 ];
 
+const REVERSAL_WINDOW = 4;
+const RECENT_WINDOW = 6;
+const RECENT_MASK = (1 << RECENT_WINDOW) - 1;
+
 /**
  * Initialize a new staircase for one eye
  */
@@ -27,51 +36,53 @@ export function initStaircase(eye: Eye, startIndex: number = 6): StairState {
     reversals: 0,
     direction: -1, // Start by making it harder
     history: [],
+    trialCount: 0,
+    misses: 0,
+    recentCorrect: 0,
+    reversalIdx: new Array(REVERSAL_WINDOW).fill(0),
   };
 }
 
 /**
  * Advance staircase based on user response
  * 1-up/2-down: Two consecutive correct → smaller; one incorrect → larger
+ * Updates the state in place and returns it.
  */
 export function nextStairState(
   state: StairState,
   wasCorrect: boolean
 ): StairState {
-  const history = [...state.history, { idx: state.sizeIndex, correct: wasCorrect }];
+  const previousCorrect = state.trialCount > 0 && (state.recentCorrect & 1) === 1;
   let dir = state.direction;
 
   // Determine new direction
-  const lastTwo = history.slice(-2);
   if (!wasCorrect) {
     // One miss → go larger (easier)
     dir = 1;
-  } else if (
-    lastTwo.length === 2 &&
-    lastTwo[0].correct &&
-    lastTwo[1].correct
-  ) {
+  } else if (previousCorrect) {
     // Two consecutive correct → go smaller (harder)
     dir = -1;
   }
 
-  // Calculate reversal
-  const hadReversal = dir !== state.direction && state.history.length > 0;
-  const reversals = hadReversal ? state.reversals + 1 : state.reversals;
+  // Record reversal at the size where the direction flipped
+  if (dir !== state.direction && state.trialCount > 0) {
+    state.reversalIdx[state.reversals % REVERSAL_WINDOW] = state.sizeIndex;
+    state.reversals++;
+  }
+
+  state.history.push({ idx: state.sizeIndex, correct: wasCorrect });
+  state.trialCount++;
+  if (!wasCorrect) state.misses++;
+  state.recentCorrect = ((state.recentCorrect << 1) | (wasCorrect ? 1 : 0)) & RECENT_MASK;
 
   // Calculate next index
-  const nextIdx = Math.max(
+  state.sizeIndex = Math.max(
     0,
     Math.min(LOGMAR_STEPS.length - 1, state.sizeIndex + dir)
   );
+  state.direction = dir;
 
-  return {
-    ...state,
-    sizeIndex: nextIdx,
-    direction: dir,
-    reversals,
-    history,
-  };
+  return state;
 }
 
 /**
@@ -85,35 +96,16 @@ export function isStaircaseComplete(state: StairState): boolean {
  * Calculate threshold from reversal points (last 4 reversals)
  */
 export function calculateThreshold(state: StairState): number {
-  if (state.reversals < 4) {
+  if (state.reversals < REVERSAL_WINDOW) {
     return LOGMAR_STEPS[state.sizeIndex];
   }
 
-  // Find last 4 reversal indices
-  const reversalIndices: number[] = [];
-  let prevDir = state.history[0]?.correct ? -1 : 1;
-
-  for (let i = 1; i < state.history.length; i++) {
-    const entry = state.history[i];
-    const lastTwo = state.history.slice(Math.max(0, i - 1), i + 1);
-
-    let dir = prevDir;
-    if (!entry.correct) {
-      dir = 1;
-    } else if (lastTwo.length === 2 && lastTwo.every((e) => e.correct)) {
-      dir = -1;
-    }
-
-    if (dir !== prevDir) {
-      reversalIndices.push(entry.idx);
-    }
-    prevDir = dir;
-  }
-
   // Average last 4 reversals
-  const last4 = reversalIndices.slice(-4);
-  const avgIdx = last4.reduce((sum, idx) => sum + idx, 0) / last4.length;
-  const roundedIdx = Math.round(avgIdx);
+  let sum = 0;
+  for (let i = 0; i < REVERSAL_WINDOW; i++) {
+    sum += state.reversalIdx[i];
+  }
+  const roundedIdx = Math.round(sum / REVERSAL_WINDOW);
 
   return LOGMAR_STEPS[roundedIdx] ?? LOGMAR_STEPS[state.sizeIndex];
 }
@@ -144,17 +136,17 @@ export function logmarToSphere(logmar: number): number {
  * Calculate confidence based on consistency of responses
  */
 export function calculateConfidence(state: StairState): number {
-  if (state.history.length < 6) return 0.5;
+  if (state.trialCount < RECENT_WINDOW) return 0.5;
+
+  // Count correct responses in the last 6 trials
+  let correctCount = 0;
+  for (let bits = state.recentCorrect; bits; bits &= bits - 1) {
+    correctCount++;
+  }
 
-  // Look at last 6 trials
-  const recent = state.history.slice(-6);
-  
-  // Count correct responses
-  const correctCount = recent.filter((h) => h.correct).length;
-  
   // Expected pattern: some correct, some wrong (convergence)
   // High confidence if we have 4-5 correct out of 6
-  const ratio = correctCount / recent.length;
+  const ratio = correctCount / RECENT_WINDOW;
   
   // Map to confidence: best around 0.67-0.83 correct
   if (ratio >= 0.67 && ratio <= 0.83) {
@@ -167,6 +159,3 @@ export function calculateConfidence(state: StairState): number {
     return 0.6; // Struggling
   }
 }
-
-
-
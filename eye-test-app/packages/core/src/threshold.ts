@@ -0,0 +1,122 @@
+/**
+ * Pluggable acuity threshold engines
+ * The 1-up/2-down staircase and QUEST+ share one interface so routes and
+ * simulations can switch between them by name.
+ */
+
+import { Eye } from "./types";
+import {
+  StairState,
+  LOGMAR_STEPS,
+  initStaircase,
+  nextStairState,
+  isStaircaseComplete,
+  calculateThreshold,
+  calculateConfidence,
+} from "./staircase";
+import {
+  QuestState,
+  initQuest,
+  nextQuestState,
+  isQuestComplete,
+  calculateQuestThreshold,
+  calculateQuestConfidence,
+  questEntropy,
+  questEstimate,
+} from "./quest";
+
+export type ThresholdEngineName = "staircase" | "quest";
+
+/**
+ * Client-facing progress of a threshold search
+ */
+export interface ThresholdProgress {
+  eye: Eye;
+  sizeIndex: number;          // next stimulus, index into LOGMAR_STEPS
+  logMAR: number;
+  trialCount: number;
+  misses: number;
+  reversals: number;
+  direction?: -1 | 1;         // staircase only
+  entropyBits?: number;       // quest only
+  sdLogMAR?: number;          // quest only
+}
+
+/**
+ * A threshold search over LOGMAR_STEPS
+ * `next` may update the state in place; always use the returned state.
+ */
+export interface ThresholdEngine<S = any> {
+  readonly name: ThresholdEngineName;
+  init(eye: Eye, startIndex?: number): S;
+  next(state: S, wasCorrect: boolean): S;
+  sizeIndex(state: S): number;  // stimulus to present next
+  presented(state: S, sizeIndex: number): S; // the client showed another size instead
+  isComplete(state: S): boolean;
+  threshold(state: S): number;
+  confidence(state: S): number;
+  progress(state: S): ThresholdProgress;
+}
+
+export const staircaseEngine: ThresholdEngine<StairState> = {
+  name: "staircase",
+  init: initStaircase,
+  next: nextStairState,
+  sizeIndex: (state) => state.sizeIndex,
+  presented: (state, sizeIndex) => {
+    state.sizeIndex = sizeIndex;
+    return state;
+  },
+  isComplete: isStaircaseComplete,
+  threshold: calculateThreshold,
+  confidence: calculateConfidence,
+  progress: (state) => ({
+    eye: state.eye,
+    sizeIndex: state.sizeIndex,
+    logMAR: LOGMAR_STEPS[state.sizeIndex],
+    trialCount: state.trialCount,
+    misses: state.misses,
+    reversals: state.reversals,
+    direction: state.direction,
+  }),
+};
+
+export const questEngine: ThresholdEngine<QuestState> = {
+  name: "quest",
+  init: initQuest,
+  next: nextQuestState,
+  sizeIndex: (state) => state.sizeIndex,
+  // The posterior update reads sizeIndex, so it folds in the size actually shown
+  presented: (state, sizeIndex) => {
+    state.sizeIndex = sizeIndex;
+    return state;
+  },
+  isComplete: isQuestComplete,
+  threshold: calculateQuestThreshold,
+  confidence: calculateQuestConfidence,
+  progress: (state) => ({
+    eye: state.eye,
+    sizeIndex: state.sizeIndex,
+    logMAR: LOGMAR_STEPS[state.sizeIndex],
+    trialCount: state.trialCount,
+    misses: state.misses,
+    reversals: 0,
+    entropyBits: questEntropy(state),
+    sdLogMAR: questEstimate(state).sd,
+  }),
+};
+
+export const THRESHOLD_ENGINES: Record<ThresholdEngineName, ThresholdEngine> = {
+  staircase: staircaseEngine,
+  quest: questEngine,
+};
+
+// A Map, so names like "constructor" or "__proto__" can't reach Object.prototype
+const ENGINES_BY_NAME = new Map<string, ThresholdEngine>(Object.entries(THRESHOLD_ENGINES));
+
+/**
+ * Look up an engine by name (null for unknown names)
+ */
+export function getThresholdEngine(name: string): ThresholdEngine | null {
+  return ENGINES_BY_NAME.get(name) ?? null;
+}
@@ -0,0 +1,50 @@
+/**
+ * Pooled keep-alive agents, one per upstream origin
+ *
+ * Every client shares these, so repeated calls to api.x.ai or
+ * api.elevenlabs.io reuse warm TCP+TLS connections instead of handshaking per
+ * request. LIFO scheduling keeps the hottest sockets busy and lets idle ones
+ * time out.
+ */
+
+import http from "http";
+import https from "https";
+
+const MAX_SOCKETS_PER_HOST = Number(process.env.UPSTREAM_MAX_SOCKETS) || 16;
+const MAX_FREE_SOCKETS = Number(process.env.UPSTREAM_MAX_FREE_SOCKETS) || 4;
+const SOCKET_IDLE_MS = Number(process.env.UPSTREAM_SOCKET_IDLE_MS) || 30000;
+
+const agents = new Map<string, http.Agent>();
+
+/**
+ * Keep-alive agent for a URL's origin (created on first use)
+ */
+export function agentFor(url: string | URL): http.Agent {
+  const { protocol, host } = typeof url === "string" ? new URL(url) : url;
+  const key = `${protocol}//${host}`;
+
+  let agent = agents.get(key);
+  if (!agent) {
+    const options: https.AgentOptions = {
+      keepAlive: true,
+      keepAliveMsecs: 1000,
+      maxSockets: MAX_SOCKETS_PER_HOST,
+      maxFreeSockets: MAX_FREE_SOCKETS,
+      timeout: SOCKET_IDLE_MS,
+      scheduling: "lifo",
+    };
+    agent = protocol === "https:" ? new https.Agent(options) : new http.Agent(options);
+    agents.set(key, agent);
+  }
+  return agent;
+}
+
+/**
+ * Close pooled sockets (e.g. on shutdown)
+ */
+export function destroyAgents(): void {
+  for (const agent of agents.values()) {
+    agent.destroy();
+  }
+  agents.clear();
+}
@@ -0,0 +1,82 @@
+/**
+ * Per-host circuit breaker
+ *
+ * After FAILURE_THRESHOLD consecutive failures the circuit opens and calls
+ * fail fast with CircuitOpenError, so callers drop straight into their
+ * fallbacks (grokFallback, createMockAudio) instead of waiting on a dead
+ * upstream. After the cooldown one probe is let through (half-open); its
+ * result closes or re-opens the circuit.
+ */
+
+import { packageLog } from "./log";
+
+const FAILURE_THRESHOLD = Number(process.env.UPSTREAM_BREAKER_FAILURES) || 5;
+const COOLDOWN_MS = Number(process.env.UPSTREAM_BREAKER_COOLDOWN_MS) || 10000;
+
+export type CircuitState = "closed" | "open" | "half-open";
+
+export class CircuitOpenError extends Error {
+  constructor(readonly host: string, readonly retryAt: number) {
+    super(`Circuit open for ${host}`);
+    this.name = "CircuitOpenError";
+  }
+}
+
+export class CircuitBreaker {
+  private failures = 0;
+  private openedAt = 0;
+  private probing = false;
+  state: CircuitState = "closed";
+
+  constructor(
+    readonly host: string,
+    private readonly threshold = FAILURE_THRESHOLD,
+    private readonly cooldownMs = COOLDOWN_MS
+  ) {}
+
+  /**
+   * Throw if calls are currently being shed
+   */
+  check(now = Date.now()): void {
+    if (this.state === "open") {
+      if (now - this.openedAt < this.cooldownMs) {
+        throw new CircuitOpenError(this.host, this.openedAt + this.cooldownMs);
+      }
+      this.state = "half-open";
+    }
+    if (this.state === "half-open") {
+      if (this.probing) {
+        throw new CircuitOpenError(this.host, now + this.cooldownMs);
+      }
+      this.probing = true;
+    }
+  }
+
+  success(): void {
+    if (this.state !== "closed") {
+      packageLog.info(`🟢 Upstream ${this.host} recovered, closing circuit`);
+    }
+    this.failures = 0;
+    this.probing = false;
+    this.state = "closed";
+  }
+
+  /**
+   * A call ended without a verdict (caller aborted); free the half-open probe
+   */
+  cancel(): void {
+    this.probing = false;
+  }
+
+  failure(now = Date.now()): void {
+    this.failures++;
+    this.probing = false;
+    if (this.state === "half-open" || this.failures >= this.threshold) {
+      if (this.state !== "open") {
+        packageLog.warn(`🔴 Upstream ${this.host} failing (${this.failures} in a row), opening circuit`);
+      }
+      this.state = "open";
+      this.openedAt = now;
+    }
+  }
+}
@@ -0,0 +1,267 @@
+/**
+ * Upstream fetch: keep-alive pooling, per-host concurrency limits,
+ * single-flight coalescing, deadlines and circuit breaking in one call path
+ *
+ * Failures surface as thrown errors (CircuitOpenError when the breaker is
+ * shedding load), so existing try/catch fallbacks keep working unchanged.
+ */
+
+import fetch, { Headers, RequestInit, Response } from "node-fetch";
+import { agentFor } from "./agents";
+import { CircuitBreaker } from "./breaker";
+import { Semaphore, abortError } from "./semaphore";
+
+const DEFAULT_DEADLINE_MS = Number(process.env.UPSTREAM_DEADLINE_MS) || 15000;
+const MAX_CONCURRENCY_PER_HOST = Number(process.env.UPSTREAM_MAX_CONCURRENCY) || 8;
+
+export interface UpstreamRequestInit extends Omit<RequestInit, "signal" | "agent"> {
+  signal?: AbortSignal;      // Caller cancellation
+  deadlineMs?: number;       // Budget from now (queueing included)
+  deadline?: number;         // Absolute epoch ms, e.g. propagated from a caller's own budget
+  streaming?: boolean;       // Deadline covers the headers only, not a long-lived body
+  coalesce?: boolean | string; // Share one in-flight request between identical calls (or a custom key)
+}
+
+export class UpstreamError extends Error {
+  constructor(readonly status: number, readonly data: unknown, message: string) {
+    super(message);
+    this.name = "UpstreamError";
+  }
+}
+
+export class DeadlineExceededError extends Error {
+  constructor(readonly url: string) {
+    super(`Upstream deadline exceeded: ${url}`);
+    this.name = "AbortError";
+  }
+}
+
+interface HostState {
+  semaphore: Semaphore;
+  breaker: CircuitBreaker;
+}
+
+const hosts = new Map<string, HostState>();
+
+function hostState(host: string): HostState {
+  let state = hosts.get(host);
+  if (!state) {
+    state = { semaphore: new Semaphore(MAX_CONCURRENCY_PER_HOST), breaker: new CircuitBreaker(host) };
+    hosts.set(host, state);
+  }
+  return state;
+}
+
+/**
+ * Breaker state and queue depth per host (for logging / metrics)
+ */
+export function upstreamStats(): Record<string, { circuit: string; queued: number }> {
+  const stats: Record<string, { circuit: string; queued: number }> = {};
+  for (const [host, state] of hosts) {
+    stats[host] = { circuit: state.breaker.state, queued: state.semaphore.pending };
+  }
+  return stats;
+}
+
+/**
+ * Abort signal that fires at the deadline or when the parent signal aborts
+ */
+function deadlineScope(url: string, deadline: number, parent?: AbortSignal) {
+  const controller = new AbortController();
+  const onParentAbort = () => controller.abort(parent!.reason);
+  const timer = setTimeout(
+    () => controller.abort(new DeadlineExceededError(url)),
+    Math.max(0, deadline - Date.now())
+  );
+  timer.unref();
+
+  if (parent?.aborted) onParentAbort();
+  else parent?.addEventListener("abort", onParentAbort, { once: true });
+
+  return {
+    signal: controller.signal,
+    // The deadline stops applying once the call is over (or its headers are in)
+    dispose: () => {
+      clearTimeout(timer);
+      parent?.removeEventListener("abort", onParentAbort);
+    },
+  };
+}
+
+async function execute(url: string, init: UpstreamRequestInit): Promise<Response> {
+  const { signal, deadlineMs, deadline, streaming, coalesce: _coalesce, ...rest } = init;
+  const { host } = new URL(url);
+  const state = hostState(host);
+
+  state.breaker.check();
+
+  const scope = deadlineScope(url, deadline ?? Date.now() + (deadlineMs ?? DEFAULT_DEADLINE_MS), signal);
+  let release: (() => void) | null = null;
+  const finish = () => {
+    release?.();
+    release = null;
+    scope.dispose();
+  };
+
+  try {
+    release = await state.semaphore.acquire(scope.signal);
+    const response = await fetch(url, { ...rest, agent: agentFor(url), signal: scope.signal as any });
+
+    // 5xx and rate limiting mean the upstream is unhealthy; other 4xx are ours
+    if (response.status >= 500 || response.status === 429) {
+      state.breaker.failure();
+    } else {
+      state.breaker.success();
+    }
+
+    // Hold the concurrency slot (and, unless streaming, the deadline) until
+    // the body has been read
+    if (streaming) scope.dispose();
+    if (!response.body) finish();
+    else response.body.once("end", finish).once("error", finish).once("close", finish);
+    return response;
+  } catch (error) {
+    if (signal?.aborted) {
+      // The caller gave up; says nothing about upstream health
+      state.breaker.cancel();
+    } else {
+      state.breaker.failure();
+    }
+    finish();
+    throw error;
+  }
+}
+
+interface BufferedResponse {
+  status: number;
+  statusText: string;
+  headers: Headers;
+  body: Buffer;
+}
+
+interface Flight {
+  response: Promise<BufferedResponse>;
+  controller: AbortController; // Aborts the shared call once nobody is waiting on it
+  waiters: number;
+}
+
+const inflight = new Map<string, Flight>();
+
+function coalesceKey(url: string, init: UpstreamRequestInit): string {
+  if (typeof init.coalesce === "string") return init.coalesce;
+  const body = typeof init.body === "string" ? init.body : "";
+  return `${init.method || "GET"} ${url} ${body}`;
+}
+
+/**
+ * Wait for a shared flight, giving up early if this caller's signal aborts
+ */
+function awaitFlight(flight: Flight, signal?: AbortSignal): Promise<BufferedResponse> {
+  if (!signal) return flight.response;
+  if (signal.aborted) return Promise.reject(abortError(signal));
+
+  return new Promise((resolve, reject) => {
+    const onAbort = () => reject(abortError(signal));
+    signal.addEventListener("abort", onAbort, { once: true });
+    flight.response.then(
+      (buffered) => {
+        signal.removeEventListener("abort", onAbort);
+        resolve(buffered);
+      },
+      (error) => {
+        signal.removeEventListener("abort", onAbort);
+        reject(error);
+      }
+    );
+  });
+}
+
+/**
+ * Fetch through the shared upstream layer
+ * With `coalesce`, identical calls already in flight share one upstream
+ * request; each caller gets its own Response over the buffered body.
+ * A caller's signal releases that caller only; the shared request is
+ * aborted once every caller waiting on it has aborted.
+ */
+export async function upstreamFetch(url: string, init: UpstreamRequestInit = {}): Promise<Response> {
+  if (!init.coalesce || init.streaming) {
+    return execute(url, init);
+  }
+
+  const key = coalesceKey(url, init);
+  let flight = inflight.get(key);
+  if (!flight) {
+    // The shared call follows the first caller's deadline; cancellation is
+    // by waiter count (below), not by any one caller's signal
+    const { signal: _signal, ...sharedInit } = init;
+    const controller = new AbortController();
+    const created: Flight = {
+      controller,
+      waiters: 0,
+      response: execute(url, { ...sharedInit, signal: controller.signal })
+        .then(async (response) => ({
+          status: response.status,
+          statusText: response.statusText,
+          headers: response.headers,
+          body: await response.buffer(),
+        }))
+        .finally(() => {
+          if (inflight.get(key) === created) inflight.delete(key);
+        }),
+    };
+    // Abandoned flights reject with nobody listening
+    created.response.catch(() => undefined);
+    inflight.set(key, created);
+    flight = created;
+  }
+
+  const joined = flight;
+  joined.waiters++;
+  let buffered: BufferedResponse;
+  try {
+    buffered = await awaitFlight(joined, init.signal);
+  } catch (error) {
+    if (init.signal?.aborted && --joined.waiters === 0) {
+      // Later identical calls start afresh instead of joining an aborted flight
+      if (inflight.get(key) === joined) inflight.delete(key);
+      joined.controller.abort(init.signal.reason);
+    }
+    throw error;
+  }
+  joined.waiters--;
+
+  return new Response(buffered.body, {
+    status: buffered.status,
+    statusText: buffered.statusText,
+    headers: new Headers(buffered.headers),
+  });
+}
+
+/**
+ * POST/GET JSON through the upstream layer; throws UpstreamError on non-2xx
+ */
+export async function upstreamJson<T = any>(
+  url: string,
+  init: UpstreamRequestInit & { json?: unknown } = {}
+): Promise<T> {
+  const { json, ...rest } = init;
+  const response = await upstreamFetch(url, {
+    ...rest,
+    method: rest.method || (json !== undefined ? "POST" : "GET"),
+    headers: { "Content-Type": "application/json", ...(rest.headers as Record<string, string>) },
+    body: json !== undefined ? JSON.stringify(json) : rest.body,
+  });
+
+  const text = await response.text();
+  let data: unknown = text;
+  try {
+    data = text ? JSON.parse(text) : null;
+  } catch {
+    // Non-JSON error bodies are passed through as text
+  }
+
+  if (!response.ok) {
+    throw new UpstreamError(response.status, data, `Upstream ${response.status} ${response.statusText} from ${url}`);
+  }
+  return data as T;
+}
@@ -0,0 +1,9 @@
+/**
+ * @OptiX/upstream - Shared client for upstream AI APIs (xAI, ElevenLabs)
+ */
+
+export * from "./agents";
+export * from "./semaphore";
+export * from "./breaker";
+export * from "./client";
+export * from "./log";
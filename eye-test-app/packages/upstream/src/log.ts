@@ -0,0 +1,54 @@
+/**
+ * Log hook for the workspace packages
+ *
+ * Upstream clients log on per-trial paths (every hint, every TTS request),
+ * where a synchronous console write stalls the event loop. The host process
+ * installs its own leveled logger with setPackageLogger; until then lines go
+ * to the console, so the packages still log when used on their own.
+ */
+
+export type PackageLogLevel = "debug" | "info" | "warn" | "error";
+
+export type PackageLogFields = Record<string, unknown> | (() => Record<string, unknown>);
+
+export interface PackageLogger {
+  log(level: PackageLogLevel, message: string, fields?: PackageLogFields): void;
+  sampled(level: PackageLogLevel, message: string, fields?: PackageLogFields): void;
+}
+
+const CONSOLE_METHODS: Record<PackageLogLevel, "debug" | "log" | "warn" | "error"> = {
+  debug: "debug",
+  info: "log",
+  warn: "warn",
+  error: "error",
+};
+
+const consoleLogger: PackageLogger = {
+  log(level, message, fields) {
+    const method = CONSOLE_METHODS[level];
+    if (fields === undefined) console[method](message);
+    else console[method](message, typeof fields === "function" ? fields() : fields);
+  },
+  sampled(level, message, fields) {
+    this.log(level, message, fields);
+  },
+};
+
+let sink: PackageLogger = consoleLogger;
+
+/**
+ * Route package logging through the host's logger
+ */
+export function setPackageLogger(logger: PackageLogger): void {
+  sink = logger;
+}
+
+export const packageLog = {
+  debug: (message: string, fields?: PackageLogFields) => sink.log("debug", message, fields),
+  info: (message: string, fields?: PackageLogFields) => sink.log("info", message, fields),
+  warn: (message: string, fields?: PackageLogFields) => sink.log("warn", message, fields),
+  error: (message: string, fields?: PackageLogFields) => sink.log("error", message, fields),
+  // Per-trial lines: only a fraction is kept when the host samples
+  sampled: (level: PackageLogLevel, message: string, fields?: PackageLogFields) =>
+    sink.sampled(level, message, fields),
+};
@@ -3,7 +3,7 @@
  * Handles bidirectional voice conversation for sphere testing
  */
 
-import fetch from "node-fetch";
+import { packageLog, upstreamFetch } from "@OptiX/upstream";
 
 export interface ConversationConfig {
   agentId?: string;
@@ -24,16 +24,16 @@ export async function startConversation(
 ): Promise<string> {
   const apiKey = process.env.ELEVENLABS_API_KEY;
   if (!apiKey) {
-    console.warn("⚠️  ELEVENLABS_API_KEY not set, using mock conversation");
+    packageLog.sampled("warn", "⚠️  ELEVENLABS_API_KEY not set, using mock conversation");
     return "mock-conversation-id";
   }
 
   try {
     const agentId = config.agentId || "default-agent";
     
-    console.log("🎤 Starting ElevenLabs Conversational AI session...");
+    packageLog.debug("🎤 Starting ElevenLabs Conversational AI session...");
 
-    const response = await fetch(
+    const response = await upstreamFetch(
       `https://api.elevenlabs.io/v1/convai/conversation`,
       {
         method: "POST",
@@ -55,11 +55,11 @@ export async function startConversation(
     const data: any = await response.json();
     const conversationId = data.conversation_id;
 
-    console.log(`🎤 ElevenLabs Conversation started: ${conversationId}`);
+    packageLog.info(`🎤 ElevenLabs Conversation started: ${conversationId}`);
 
     return conversationId;
   } catch (error) {
-    console.error("ElevenLabs ConvAI error:", error);
+    packageLog.error("ElevenLabs ConvAI error", { error });
     return "mock-conversation-id";
   }
 }
@@ -78,7 +78,7 @@ export async function sendAudioToConversation(
   const apiKey = process.env.ELEVENLABS_API_KEY;
   
   if (!apiKey || conversationId === "mock-conversation-id") {
-    console.log("🎤 Mock conversation: User said letters");
+    packageLog.debug("🎤 Mock conversation: User said letters");
     return {
       text: "C D Z O P",
       audioResponse: new ArrayBuffer(0),
@@ -87,12 +87,12 @@ export async function sendAudioToConversation(
   }
 
   try {
-    console.log("🎤 Sending audio to ElevenLabs Conversational AI...");
+    packageLog.debug("🎤 Sending audio to ElevenLabs Conversational AI...");
 
     const formData = new FormData();
     formData.append("audio", audioBlob);
 
-    const response = await fetch(
+    const response = await upstreamFetch(
       `https://api.elevenlabs.io/v1/convai/conversation/${conversationId}/audio`,
       {
         method: "POST",
@@ -109,12 +109,12 @@ export async function sendAudioToConversation(
 
     const data: any = await response.json();
     
-    console.log(`🎤 ElevenLabs understood: "${data.user_message}"`);
+    packageLog.sampled("info", `🎤 ElevenLabs understood: "${data.user_message}"`);
 
     // Get audio response
     let audioResponse = new ArrayBuffer(0);
     if (data.audio_response_url) {
-      const audioRes = await fetch(data.audio_response_url);
+      const audioRes = await upstreamFetch(data.audio_response_url);
       audioResponse = await audioRes.arrayBuffer();
     }
 
@@ -124,7 +124,7 @@ export async function sendAudioToConversation(
       understood: true,
     };
   } catch (error) {
-    console.error("ElevenLabs conversation error:", error);
+    packageLog.error("ElevenLabs conversation error", { error });
     return {
       text: "C D Z O P",
       audioResponse: new ArrayBuffer(0),
@@ -146,7 +146,7 @@ export async function sendTextToConversation(
   const apiKey = process.env.ELEVENLABS_API_KEY;
   
   if (!apiKey || conversationId === "mock-conversation-id") {
-    console.log(`🎤 Mock: AI responds to "${text}"`);
+    packageLog.debug(`🎤 Mock: AI responds to "${text}"`);
     return {
       responseText: "Great! Read the next line.",
       audioResponse: undefined,
@@ -154,7 +154,7 @@ export async function sendTextToConversation(
   }
 
   try {
-    const response = await fetch(
+    const response = await upstreamFetch(
       `https://api.elevenlabs.io/v1/convai/conversation/${conversationId}/message`,
       {
         method: "POST",
@@ -174,16 +174,16 @@ export async function sendTextToConversation(
 
     const data: any = await response.json();
 
-    console.log(`🎤 ElevenLabs AI: "${data.assistant_message}"`);
+    packageLog.sampled("info", `🎤 ElevenLabs AI: "${data.assistant_message}"`);
 
     return {
       responseText: data.assistant_message || "Continue.",
       audioResponse: data.audio_url
-        ? await (await fetch(data.audio_url)).arrayBuffer()
+        ? await (await upstreamFetch(data.audio_url)).arrayBuffer()
         : undefined,
     };
   } catch (error) {
-    console.error("ElevenLabs text conversation error:", error);
+    packageLog.error("ElevenLabs text conversation error", { error });
     return {
       responseText: "Continue.",
     };
@@ -197,12 +197,12 @@ export async function endConversation(conversationId: string): Promise<void> {
   const apiKey = process.env.ELEVENLABS_API_KEY;
   
   if (!apiKey || conversationId === "mock-conversation-id") {
-    console.log("🎤 Mock conversation ended");
+    packageLog.debug("🎤 Mock conversation ended");
     return;
   }
 
   try {
-    await fetch(
+    await upstreamFetch(
       `https://api.elevenlabs.io/v1/convai/conversation/${conversationId}`,
       {
         method: "DELETE",
@@ -212,9 +212,9 @@ export async function endConversation(conversationId: string): Promise<void> {
       }
     );
 
-    console.log(`🎤 ElevenLabs Conversation ended: ${conversationId}`);
+    packageLog.info(`🎤 ElevenLabs Conversation ended: ${conversationId}`);
   } catch (error) {
-    console.error("Error ending conversation:", error);
+    packageLog.error("Error ending conversation", { error });
   }
 }
 
@@ -2,7 +2,7 @@
  * ElevenLabs TTS client
  */
 
-import fetch from "node-fetch";
+import { packageLog, upstreamFetch } from "@OptiX/upstream";
 
 export interface TTSOptions {
   voiceId?: string;
@@ -11,8 +11,20 @@ export interface TTSOptions {
   modelId?: string;
 }
 
-const DEFAULT_VOICE_ID = "21m00Tcm4TlvDq8ikWAM"; // Rachel voice
-const DEFAULT_MODEL = "eleven_monolingual_v1";
+export const DEFAULT_VOICE_ID = "21m00Tcm4TlvDq8ikWAM"; // Rachel voice
+export const DEFAULT_MODEL = "eleven_monolingual_v1";
+
+/**
+ * Fill in TTS defaults so every caller (and the cache key) agrees on them
+ */
+export function resolveTtsOptions(options: TTSOptions = {}): Required<TTSOptions> {
+  return {
+    voiceId: options.voiceId || DEFAULT_VOICE_ID,
+    stability: options.stability ?? 0.5,
+    similarityBoost: options.similarityBoost ?? 0.75,
+    modelId: options.modelId || DEFAULT_MODEL,
+  };
+}
 
 /**
  * Convert text to speech using ElevenLabs
@@ -21,53 +33,62 @@ export async function ttsSpeak(
   text: string,
   options: TTSOptions = {}
 ): Promise<ArrayBuffer> {
-  const {
-    voiceId = DEFAULT_VOICE_ID,
-    stability = 0.5,
-    similarityBoost = 0.75,
-    modelId = DEFAULT_MODEL,
-  } = options;
+  if (!process.env.ELEVENLABS_API_KEY) {
+    packageLog.sampled("warn", "⚠️  ELEVENLABS_API_KEY not set, using mock TTS");
+    return createMockAudio(text);
+  }
 
+  try {
+    const buffer = await requestTts(text, resolveTtsOptions(options));
+    return buffer.buffer.slice(buffer.byteOffset, buffer.byteOffset + buffer.byteLength) as ArrayBuffer;
+  } catch (error) {
+    packageLog.error("ElevenLabs TTS error", { error });
+    // Fallback to mock
+    return createMockAudio(text);
+  }
+}
+
+/**
+ * Single ElevenLabs TTS request; throws on any failure (no mock fallback)
+ */
+export async function requestTts(
+  text: string,
+  options: Required<TTSOptions>
+): Promise<Buffer> {
   const apiKey = process.env.ELEVENLABS_API_KEY;
   if (!apiKey) {
-    console.warn("⚠️  ELEVENLABS_API_KEY not set, using mock TTS");
-    return createMockAudio(text);
+    throw new Error("ELEVENLABS_API_KEY not set");
   }
 
-  console.log(`🔊 Using ElevenLabs for prompt: "${text}"`);
+  packageLog.debug(`🔊 Using ElevenLabs for prompt: "${text}"`);
 
-  try {
-    const response = await fetch(
-      `https://api.elevenlabs.io/v1/text-to-speech/${voiceId}`,
-      {
-        method: "POST",
-        headers: {
-          "xi-api-key": apiKey,
-          "Content-Type": "application/json",
-          Accept: "audio/mpeg",
+  // Concurrent requests for the same prompt share one synthesis
+  const response = await upstreamFetch(
+    `https://api.elevenlabs.io/v1/text-to-speech/${options.voiceId}`,
+    {
+      method: "POST",
+      coalesce: true,
+      headers: {
+        "xi-api-key": apiKey,
+        "Content-Type": "application/json",
+        Accept: "audio/mpeg",
+      },
+      body: JSON.stringify({
+        text,
+        model_id: options.modelId,
+        voice_settings: {
+          stability: options.stability,
+          similarity_boost: options.similarityBoost,
         },
-        body: JSON.stringify({
-          text,
-          model_id: modelId,
-          voice_settings: {
-            stability,
-            similarity_boost: similarityBoost,
-          },
-        }),
-      }
-    );
-
-    if (!response.ok) {
-      throw new Error(`ElevenLabs TTS failed: ${response.statusText}`);
+      }),
     }
+  );
 
-    const buffer = await response.buffer();
-    return buffer.buffer as ArrayBuffer;
-  } catch (error) {
-    console.error("ElevenLabs TTS error:", error);
-    // Fallback to mock
-    return createMockAudio(text);
+  if (!response.ok) {
+    throw new Error(`ElevenLabs TTS failed: ${response.statusText}`);
   }
+
+  return response.buffer();
 }
 
 /**
@@ -80,7 +101,8 @@ export async function getVoices(): Promise<any[]> {
   }
 
   try {
-    const response = await fetch("https://api.elevenlabs.io/v1/voices", {
+    const response = await upstreamFetch("https://api.elevenlabs.io/v1/voices", {
+      coalesce: true,
       headers: {
         "xi-api-key": apiKey,
       },
@@ -93,7 +115,7 @@ export async function getVoices(): Promise<any[]> {
     const data = await response.json();
     return data.voices || [];
   } catch (error) {
-    console.error("Error fetching voices:", error);
+    packageLog.error("Error fetching voices", { error });
     return [];
   }
 }
@@ -101,7 +123,7 @@ export async function getVoices(): Promise<any[]> {
 /**
  * Create mock audio buffer for demo/testing
  */
-function createMockAudio(text: string): ArrayBuffer {
+export function createMockAudio(text: string): ArrayBuffer {
   // Create a minimal valid MP3 header + silent audio
   // This is just for demo purposes when API key is not available
   const mockData = new Uint8Array(1024);
@@ -112,11 +134,59 @@ function createMockAudio(text: string): ArrayBuffer {
   mockData[1] = 0x44; // 'D'
   mockData[2] = 0x33; // '3'
   
-  console.log(`🔇 Mock TTS: "${text}"`);
+  packageLog.debug(`🔇 Mock TTS: "${text}"`);
   
   return mockData.buffer;
 }
 
+/**
+ * Open an ElevenLabs streaming TTS request and return the raw MP3 body
+ * Chunks arrive as they are synthesized; throws on any failure.
+ */
+export async function openTtsStream(
+  text: string,
+  options: TTSOptions = {}
+): Promise<NodeJS.ReadableStream> {
+  const { voiceId, stability, similarityBoost, modelId } = resolveTtsOptions(options);
+
+  const apiKey = process.env.ELEVENLABS_API_KEY;
+  if (!apiKey) {
+    throw new Error("ELEVENLABS_API_KEY not set");
+  }
+
+  // Deadline covers time to first byte; the audio itself streams for as long as it takes
+  const response = await upstreamFetch(
+    `https://api.elevenlabs.io/v1/text-to-speech/${voiceId}/stream`,
+    {
+      method: "POST",
+      streaming: true,
+      headers: {
+        "xi-api-key": apiKey,
+        "Content-Type": "application/json",
+        Accept: "audio/mpeg",
+      },
+      body: JSON.stringify({
+        text,
+        model_id: modelId,
+        voice_settings: {
+          stability,
+          similarity_boost: similarityBoost,
+        },
+      }),
+    }
+  );
+
+  if (!response.ok) {
+    throw new Error(`ElevenLabs TTS stream failed: ${response.statusText}`);
+  }
+
+  if (!response.body) {
+    throw new Error("No response body");
+  }
+
+  return response.body;
+}
+
 /**
  * Stream TTS for longer texts (chunks)
  */
@@ -125,58 +195,21 @@ export async function ttsStream(
   onChunk: (chunk: ArrayBuffer) => void,
   options: TTSOptions = {}
 ): Promise<void> {
-  const {
-    voiceId = DEFAULT_VOICE_ID,
-    stability = 0.5,
-    similarityBoost = 0.75,
-    modelId = DEFAULT_MODEL,
-  } = options;
-
-  const apiKey = process.env.ELEVENLABS_API_KEY;
-  if (!apiKey) {
-    console.warn("⚠️  ELEVENLABS_API_KEY not set, using mock TTS");
+  if (!process.env.ELEVENLABS_API_KEY) {
+    packageLog.sampled("warn", "⚠️  ELEVENLABS_API_KEY not set, using mock TTS");
     onChunk(createMockAudio(text));
     return;
   }
 
   try {
-    const response = await fetch(
-      `https://api.elevenlabs.io/v1/text-to-speech/${voiceId}/stream`,
-      {
-        method: "POST",
-        headers: {
-          "xi-api-key": apiKey,
-          "Content-Type": "application/json",
-          Accept: "audio/mpeg",
-        },
-        body: JSON.stringify({
-          text,
-          model_id: modelId,
-          voice_settings: {
-            stability,
-            similarity_boost: similarityBoost,
-          },
-        }),
-      }
-    );
-
-    if (!response.ok) {
-      throw new Error(`ElevenLabs TTS stream failed: ${response.statusText}`);
-    }
+    const body = await openTtsStream(text, options);
 
-    // Stream chunks
-    const reader = response.body;
-    if (!reader) {
-      throw new Error("No response body");
-    }
-
-    for await (const chunk of reader) {
-      const buffer = Buffer.isBuffer(chunk) ? chunk.buffer as ArrayBuffer : chunk as any;
-      onChunk(buffer);
+    for await (const chunk of body) {
+      const buffer = chunk as Buffer;
+      onChunk(buffer.buffer.slice(buffer.byteOffset, buffer.byteOffset + buffer.byteLength) as ArrayBuffer);
     }
   } catch (error) {
-    console.error("ElevenLabs TTS stream error:", error);
+    packageLog.error("ElevenLabs TTS stream error", { error });
     onChunk(createMockAudio(text));
   }
 }
-
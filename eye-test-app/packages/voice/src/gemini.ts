@@ -3,6 +3,8 @@
  */
 
 import { GoogleGenerativeAI } from "@google/generative-ai";
+import { packageLog } from "@OptiX/upstream";
+import { ExamIntentType, GRAMMAR_CONFIDENCE_THRESHOLD, matchUtterance } from "./grammar";
 
 let genAI: GoogleGenerativeAI | null = null;
 
@@ -40,20 +42,20 @@ export async function sttGemini(audioBase64: string): Promise<{
 
     // For now, we'll use a simplified approach
     // Real implementation would use Gemini's audio input
-    console.log("🎤 Gemini STT processing audio...");
+    packageLog.debug("🎤 Gemini STT processing audio...");
 
     // Mock for demo (in production, send actual audio)
     const result = await model.generateContent(prompt);
     const text = result.response.text().trim().toUpperCase();
 
-    console.log(`🎤 Gemini parsed: "${text}" (mock confidence: 0.85)`);
+    packageLog.sampled("info", `🎤 Gemini parsed: "${text}" (mock confidence: 0.85)`);
 
     return {
       text,
       confidence: 0.85,
     };
   } catch (error) {
-    console.error("Gemini STT error:", error);
+    packageLog.error("Gemini STT error", { error });
     // Return mock result for demo
     return {
       text: "C D Z O P",
@@ -108,7 +110,7 @@ Respond in JSON format:
 }
     `;
 
-    console.log("🧠 Gemini policy evaluating state...");
+    packageLog.debug("🧠 Gemini policy evaluating state...");
 
     const result = await model.generateContent(prompt);
     const text = result.response.text();
@@ -117,7 +119,7 @@ Respond in JSON format:
     const jsonMatch = text.match(/\{[\s\S]*\}/);
     if (jsonMatch) {
       const policy = JSON.parse(jsonMatch[0]);
-      console.log(`🧠 Gemini policy: ${policy.action} (${policy.reasoning})`);
+      packageLog.sampled("info", `🧠 Gemini policy: ${policy.action} (${policy.reasoning})`);
       return policy;
     }
 
@@ -129,7 +131,7 @@ Respond in JSON format:
       reasoning: "Continuing with current protocol",
     };
   } catch (error) {
-    console.error("Gemini policy error:", error);
+    packageLog.error("Gemini policy error", { error });
     
     // Fallback logic
     if (context.confidence < 0.5 || context.recentMisses > 2) {
@@ -151,9 +153,14 @@ Respond in JSON format:
 }
 
 /**
- * Parse spoken letters using Gemini's NLU
+ * Parse spoken letters: local grammar first, Gemini's NLU when it isn't sure
  */
 export async function parseLetters(spokenText: string): Promise<string[]> {
+  const match = matchUtterance(spokenText, "letters");
+  if (match.type === "letters" && match.confidence >= GRAMMAR_CONFIDENCE_THRESHOLD) {
+    return match.value;
+  }
+
   try {
     const client = getClient();
     const model = client.getGenerativeModel({ model: "gemini-pro" });
@@ -172,11 +179,11 @@ If no valid letters, return empty string.
 
     const letters = text.split(/\s+/).filter((l) => l.length === 1);
 
-    console.log(`🔤 Gemini parsed letters: ${letters.join(" ")}`);
+    packageLog.sampled("info", `🔤 Gemini parsed letters: ${letters.join(" ")}`);
 
     return letters;
   } catch (error) {
-    console.error("Gemini letter parsing error:", error);
+    packageLog.error("Gemini letter parsing error", { error });
     // Fallback: simple regex extraction
     const letters = spokenText
       .toUpperCase()
@@ -185,43 +192,73 @@ If no valid letters, return empty string.
   }
 }
 
+/**
+ * Classify an utterance the grammar wasn't sure about with Gemini
+ * Null when Gemini is unavailable or its answer doesn't parse.
+ */
+async function classifyIntentGemini(
+  spokenText: string
+): Promise<{ type: ExamIntentType; value: any } | null> {
+  try {
+    const client = getClient();
+    const model = client.getGenerativeModel({ model: "gemini-pro" });
+
+    const prompt = `
+A patient taking an eye exam said: "${spokenText}"
+
+Classify it as exactly one of:
+- {"type": "choice", "value": 1 or 2} - picking lens option one or two
+- {"type": "command", "value": "next" | "repeat" | "stop"}
+- {"type": "letters", "value": ["C", "D", ...]} - reading letters (valid: C, D, E, F, L, O, P, T, Z)
+
+Respond with the JSON object only.
+    `;
+
+    const result = await model.generateContent(prompt);
+    const jsonMatch = result.response.text().match(/\{[\s\S]*\}/);
+    if (!jsonMatch) return null;
+
+    const intent = JSON.parse(jsonMatch[0]);
+    if (intent.type === "choice" && (intent.value === 1 || intent.value === 2)) return intent;
+    if (intent.type === "command" && ["next", "repeat", "stop"].includes(intent.value)) return intent;
+    if (intent.type === "letters" && Array.isArray(intent.value)) {
+      return {
+        type: "letters",
+        value: intent.value.map((letter: unknown) => String(letter).toUpperCase()).filter((letter: string) => /^[CDEFLOPTZ]$/.test(letter)),
+      };
+    }
+    return null;
+  } catch (error) {
+    packageLog.error("Gemini intent error", { error });
+    return null;
+  }
+}
+
 /**
  * Detect user intent (choice, command, letters)
+ * The local grammar answers most replies; low-confidence ones escalate to
+ * Gemini. `expect` is the answer the current step asks for, if known.
  */
-export async function detectIntent(spokenText: string): Promise<{
-  type: "choice" | "letters" | "command";
+export async function detectIntent(spokenText: string, expect?: ExamIntentType): Promise<{
+  type: ExamIntentType;
   value: any;
   confidence: number;
+  source: "grammar" | "gemini";
 }> {
-  const text = spokenText.toLowerCase().trim();
-
-  // Check for choices
-  if (text.includes("one") || text === "1") {
-    return { type: "choice", value: 1, confidence: 0.95 };
-  }
-  if (text.includes("two") || text === "2") {
-    return { type: "choice", value: 2, confidence: 0.95 };
+  const match = matchUtterance(spokenText, expect);
+  if (match.confidence >= GRAMMAR_CONFIDENCE_THRESHOLD) {
+    return { type: match.type, value: match.value, confidence: match.confidence, source: "grammar" };
   }
 
-  // Check for commands
-  if (text.includes("next") || text.includes("skip")) {
-    return { type: "command", value: "next", confidence: 0.9 };
-  }
-  if (text.includes("repeat") || text.includes("again")) {
-    return { type: "command", value: "repeat", confidence: 0.9 };
-  }
-  if (text.includes("stop") || text.includes("quit")) {
-    return { type: "command", value: "stop", confidence: 0.9 };
+  packageLog.debug(
+    `🔤 Grammar unsure (${match.confidence.toFixed(2)}, unmatched: ${match.unmatched.join(" ") || "-"}), asking Gemini`
+  );
+
+  const intent = await classifyIntentGemini(spokenText);
+  if (intent) {
+    return { ...intent, confidence: 0.8, source: "gemini" };
   }
 
-  // Otherwise, assume letters
-  const letters = await parseLetters(spokenText);
-  return {
-    type: "letters",
-    value: letters,
-    confidence: letters.length > 0 ? 0.8 : 0.3,
-  };
+  // Gemini unavailable: the grammar's guess, flagged by its low confidence
+  return { type: match.type, value: match.value, confidence: match.confidence, source: "grammar" };
 }
-
-
-
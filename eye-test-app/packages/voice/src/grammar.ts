@@ -0,0 +1,166 @@
+/**
+ * Local grammar matcher for exam responses
+ *
+ * Exam replies come from a closed vocabulary (9 Sloan letters, "one"/"two",
+ * next/repeat/stop), so they are matched against a phonetic lookup table
+ * compiled once at load instead of going to an LLM. Every match carries a
+ * confidence; callers escalate to Gemini only when it is low.
+ */
+
+export type ExamIntentType = "choice" | "letters" | "command";
+
+export interface GrammarMatch {
+  type: ExamIntentType;
+  value: any;
+  confidence: number;
+  unmatched: string[]; // Content tokens the grammar couldn't place
+}
+
+export const GRAMMAR_CONFIDENCE_THRESHOLD = Number(process.env.GRAMMAR_CONFIDENCE_THRESHOLD) || 0.75;
+
+type Entry =
+  | { kind: "letter"; value: string; score: number }
+  | { kind: "choice"; value: 1 | 2; score: number }
+  | { kind: "command"; value: "next" | "repeat" | "stop"; score: number }
+  | { kind: "filler" };
+
+// Spoken forms per Sloan letter: exact (1.0), NATO (0.95), homophones (0.9)
+const LETTER_FORMS: Record<string, { nato: string[]; sounds: string[] }> = {
+  C: { nato: ["charlie"], sounds: ["see", "sea", "cee", "si", "she"] },
+  D: { nato: ["delta"], sounds: ["dee", "de", "di"] },
+  E: { nato: ["echo"], sounds: ["ee", "eee", "he"] },
+  F: { nato: ["foxtrot"], sounds: ["ef", "eff", "if"] },
+  L: { nato: ["lima"], sounds: ["el", "ell", "elle", "al"] },
+  O: { nato: ["oscar"], sounds: ["oh", "owe", "ow", "zero"] },
+  P: { nato: ["papa"], sounds: ["pee", "pea", "pe", "pie"] },
+  T: { nato: ["tango"], sounds: ["tee", "tea", "ti"] },
+  Z: { nato: ["zulu"], sounds: ["zee", "zed", "zet", "said"] },
+};
+
+// No "to"/"too": they are far more often carrier words ("I want to go with one")
+const CHOICE_FORMS: Array<[string, 1 | 2, number]> = [
+  ["1", 1, 1], ["one", 1, 1], ["first", 1, 0.95], ["won", 1, 0.85], ["number one", 1, 1],
+  ["2", 2, 1], ["two", 2, 1], ["second", 2, 0.95], ["number two", 2, 1],
+];
+
+const COMMAND_FORMS: Array<[string, "next" | "repeat" | "stop", number]> = [
+  ["next", "next", 1], ["skip", "next", 0.95], ["pass", "next", 0.85],
+  ["repeat", "repeat", 1], ["again", "repeat", 0.95], ["say again", "repeat", 1], ["what", "repeat", 0.7],
+  ["stop", "stop", 1], ["quit", "stop", 0.95], ["cancel", "stop", 0.9],
+];
+
+// Carrier phrases that would otherwise read as letters ("I see C D" ≠ C C D)
+const FILLER_PHRASES = ["i see", "i can see", "can see", "it's a", "i think"];
+
+// Carrier words patients wrap answers in; ignored rather than counted as misses
+const FILLERS = new Set([
+  "um", "uh", "er", "erm", "hmm", "i", "it", "its", "it's", "is", "the", "a", "an", "and",
+  "then", "letter", "letters", "number", "think", "maybe", "like", "okay", "ok", "so",
+  "please", "that", "says", "say", "reads", "read", "to", "with", "go", "want", "pick",
+  "choose", "guess", "would",
+]);
+
+// Common words spelled only with Sloan letters, never read as a glued run
+const SLOAN_SPELLED_WORDS = new Set([
+  "do", "to", "of", "off", "too", "toe", "top", "pot", "dot", "lot", "cot", "cop", "pod", "odd",
+  "let", "led", "fed", "pet", "elf", "eel", "zoo", "doc", "left", "felt", "feel", "feet", "feed",
+  "deep", "peel", "flee", "fell", "tell", "cell", "doll", "toll", "poll", "cold", "fold", "told",
+  "code", "cool", "pool", "tool", "food", "foot", "loop", "pole", "dole", "flop", "coffee", "cleft",
+  "fleet",
+]);
+
+/**
+ * Phrase → entry table, compiled once at module load
+ */
+const LEXICON: Map<string, Entry> = (() => {
+  const lexicon = new Map<string, Entry>();
+  for (const [letter, forms] of Object.entries(LETTER_FORMS)) {
+    lexicon.set(letter.toLowerCase(), { kind: "letter", value: letter, score: 1 });
+    for (const word of forms.nato) lexicon.set(word, { kind: "letter", value: letter, score: 0.95 });
+    for (const word of forms.sounds) lexicon.set(word, { kind: "letter", value: letter, score: 0.9 });
+  }
+  for (const [phrase, value, score] of CHOICE_FORMS) lexicon.set(phrase, { kind: "choice", value, score });
+  for (const [phrase, value, score] of COMMAND_FORMS) lexicon.set(phrase, { kind: "command", value, score });
+  for (const phrase of FILLER_PHRASES) lexicon.set(phrase, { kind: "filler" });
+  return lexicon;
+})();
+
+const MAX_PHRASE_WORDS = 3;
+const SLOAN_RUN = /^[cdefloptz]{2,}$/;
+
+function tokenize(text: string): string[] {
+  return text
+    .toLowerCase()
+    .replace(/[^a-z0-9' ]+/g, " ")
+    .split(/\s+/)
+    .filter(Boolean);
+}
+
+/**
+ * Match an utterance against the exam grammar
+ * Pure and synchronous; confidence is the mean entry score scaled by the
+ * share of content tokens that matched the winning intent. Glued letter
+ * runs ("cdzop") are only read in a letters context: `expect` is
+ * "letters", or the utterance already names a letter.
+ */
+export function matchUtterance(text: string, expect?: ExamIntentType): GrammarMatch {
+  const tokens = tokenize(text);
+  const lettersContext = expect === "letters" || tokens.some((token) => LEXICON.get(token)?.kind === "letter");
+  const letters: Array<{ value: string; score: number }> = [];
+  const choices: Array<{ value: 1 | 2; score: number }> = [];
+  const commands: Array<{ value: string; score: number }> = [];
+  const unmatched: string[] = [];
+
+  for (let i = 0; i < tokens.length; ) {
+    // Longest phrase first ("say again" before "say", "i see" before "see")
+    let entry: Entry | undefined;
+    let width = 0;
+    for (let w = Math.min(MAX_PHRASE_WORDS, tokens.length - i); w >= 1 && !entry; w--) {
+      entry = LEXICON.get(tokens.slice(i, i + w).join(" "));
+      if (entry) width = w;
+    }
+
+    if (entry) {
+      if (entry.kind === "letter") letters.push(entry);
+      else if (entry.kind === "choice") choices.push(entry);
+      else if (entry.kind === "command") commands.push(entry);
+      i += width;
+      continue;
+    }
+
+    const token = tokens[i];
+    if (lettersContext && SLOAN_RUN.test(token) && !SLOAN_SPELLED_WORDS.has(token)) {
+      // Recognizer glued the letters together ("cdzop")
+      for (const ch of token) letters.push({ value: ch.toUpperCase(), score: 0.7 });
+    } else if (!FILLERS.has(token)) {
+      unmatched.push(token);
+    }
+    i++;
+  }
+
+  const score = (items: Array<{ score: number }>, others: number) => {
+    if (items.length === 0) return 0;
+    const mean = items.reduce((sum, item) => sum + item.score, 0) / items.length;
+    return mean * (items.length / (items.length + others + unmatched.length));
+  };
+
+  // Commands and choices are single answers; letters are a sequence
+  const commandScore = score(commands, letters.length + choices.length);
+  const choiceScore = score(choices, letters.length + commands.length);
+  const letterScore = score(letters, choices.length + commands.length);
+
+  if (commandScore > 0 && commandScore >= Math.max(choiceScore, letterScore)) {
+    return { type: "command", value: commands[0].value, confidence: commandScore, unmatched };
+  }
+  if (choiceScore > 0 && choiceScore >= letterScore) {
+    // The clearest form wins, and the last one on a tie ("one... no, two" → 2)
+    const best = choices.reduce((top, choice) => (choice.score >= top.score ? choice : top));
+    return { type: "choice", value: best.value, confidence: choiceScore, unmatched };
+  }
+  return {
+    type: "letters",
+    value: letters.map((letter) => letter.value),
+    confidence: letterScore,
+    unmatched,
+  };
+}
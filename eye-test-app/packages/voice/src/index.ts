@@ -3,6 +3,9 @@
  */
 
 export * from "./elevenlabs";
+export * from "./ttsCache";
+export * from "./prompts";
 export * from "./elevenlabs-convai";
 export * from "./gemini";
+export * from "./grammar";
 
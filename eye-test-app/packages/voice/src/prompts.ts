@@ -0,0 +1,46 @@
+/**
+ * Fixed exam prompts spoken through TTS
+ *
+ * The web conversation flow speaks these exact strings (imported from
+ * "@OptiX/voice/prompts", which has no Node dependencies), and the API
+ * pre-renders every expansion into the TTS cache at startup (see
+ * warmTtsCache), so warm-up keys match what the exam actually requests.
+ */
+
+export type PromptEye = "OD" | "OS";
+
+// Voice the conversation flow requests
+export const EXAM_VOICE_ID = "EXAVITQu4vr4xnSDxMaL";
+
+export const EXAM_CHART_LINES = 11;
+
+const eyeName = (eye: PromptEye) => (eye === "OD" ? "right" : "left");
+const otherEyeName = (eye: PromptEye) => (eye === "OD" ? "left" : "right");
+
+export const SpokenPrompts = {
+  startEye: (eye: PromptEye) =>
+    `Let's test your ${eyeName(eye)} eye. Please cover your ${otherEyeName(eye)} eye with your hand and read the letters on line 1.`,
+  correctNextLine: (line: number) => `Correct! Now please read line ${line}.`,
+  nextLine: (line: number) => `Let's try the next line. Please read line ${line}.`,
+  retryLine: (line: number) => `Let's try that again. Please read line ${line}.`,
+  analysisFailed: (line: number) => `I had trouble analyzing that. Please read line ${line} again.`,
+  rightEyeDone: () => "Excellent work on the right eye! Now let's test your left eye.",
+  sphereDone: () => "Perfect! Both eyes tested. Now we'll check for astigmatism.",
+};
+
+const lines = (from: number) =>
+  Array.from({ length: EXAM_CHART_LINES - from + 1 }, (_, i) => from + i);
+
+/**
+ * Every string SpokenPrompts can produce during an exam
+ */
+export const EXAM_PROMPTS: readonly string[] = [
+  SpokenPrompts.startEye("OD"),
+  SpokenPrompts.startEye("OS"),
+  ...lines(2).map(SpokenPrompts.correctNextLine),
+  ...lines(2).map(SpokenPrompts.nextLine),
+  ...lines(1).map(SpokenPrompts.retryLine),
+  ...lines(1).map(SpokenPrompts.analysisFailed),
+  SpokenPrompts.rightEyeDone(),
+  SpokenPrompts.sphereDone(),
+];
@@ -0,0 +1,198 @@
+/**
+ * Content-addressed TTS audio cache
+ *
+ * Audio is keyed by sha256(text, voiceId, modelId, stability, similarityBoost)
+ * and looked up in an in-process LRU first, then an on-disk blob store, and
+ * only then synthesized by ElevenLabs. Keys are stable, so responses can be
+ * served with the key as ETag and an immutable Cache-Control.
+ */
+
+import crypto from "crypto";
+import fs from "fs";
+import path from "path";
+import { packageLog } from "@OptiX/upstream";
+import {
+  TTSOptions,
+  resolveTtsOptions,
+  requestTts,
+  createMockAudio,
+} from "./elevenlabs";
+
+export type TtsCacheTier = "memory" | "disk" | "origin" | "mock";
+
+export interface CachedAudio {
+  key: string;
+  audio: Buffer;
+  tier: TtsCacheTier;
+}
+
+const MEMORY_LIMIT_BYTES = Number(process.env.TTS_CACHE_MEMORY_BYTES) || 64 * 1024 * 1024;
+const CACHE_DIR = path.resolve(process.env.TTS_CACHE_DIR || ".tts-cache");
+
+/**
+ * Byte-bounded LRU (Map iteration order doubles as recency order)
+ */
+class ByteLru {
+  private entries = new Map<string, Buffer>();
+  private bytes = 0;
+  private maxBytes: number;
+
+  constructor(maxBytes: number) {
+    this.maxBytes = maxBytes;
+  }
+
+  get(key: string): Buffer | undefined {
+    const value = this.entries.get(key);
+    if (value) {
+      this.entries.delete(key);
+      this.entries.set(key, value);
+    }
+    return value;
+  }
+
+  set(key: string, value: Buffer): void {
+    if (value.byteLength > this.maxBytes) return;
+
+    const existing = this.entries.get(key);
+    if (existing) {
+      this.bytes -= existing.byteLength;
+      this.entries.delete(key);
+    }
+
+    this.entries.set(key, value);
+    this.bytes += value.byteLength;
+
+    for (const [oldKey, oldValue] of this.entries) {
+      if (this.bytes <= this.maxBytes) break;
+      this.entries.delete(oldKey);
+      this.bytes -= oldValue.byteLength;
+    }
+  }
+}
+
+const memory = new ByteLru(MEMORY_LIMIT_BYTES);
+const pending = new Map<string, Promise<CachedAudio>>();
+
+/**
+ * Cache key for a prompt + voice settings
+ */
+export function ttsCacheKey(text: string, options: TTSOptions = {}): string {
+  const { voiceId, modelId, stability, similarityBoost } = resolveTtsOptions(options);
+  return crypto
+    .createHash("sha256")
+    .update(JSON.stringify([text, voiceId, modelId, stability, similarityBoost]))
+    .digest("hex");
+}
+
+function blobPath(key: string): string {
+  return path.join(CACHE_DIR, key.slice(0, 2), `${key}.mp3`);
+}
+
+async function readBlob(key: string): Promise<Buffer | null> {
+  try {
+    return await fs.promises.readFile(blobPath(key));
+  } catch {
+    return null;
+  }
+}
+
+async function writeBlob(key: string, audio: Buffer): Promise<void> {
+  const file = blobPath(key);
+  const tmp = `${file}.${process.pid}.tmp`;
+  try {
+    await fs.promises.mkdir(path.dirname(file), { recursive: true });
+    await fs.promises.writeFile(tmp, audio);
+    await fs.promises.rename(tmp, file);
+  } catch (error) {
+    packageLog.error("❌ Failed to persist TTS blob", { error });
+    fs.promises.unlink(tmp).catch(() => {});
+  }
+}
+
+/**
+ * Look up audio by key in the memory and disk tiers (no synthesis)
+ */
+export async function getCachedTts(key: string): Promise<CachedAudio | null> {
+  if (!/^[0-9a-f]{64}$/.test(key)) return null;
+
+  const hot = memory.get(key);
+  if (hot) return { key, audio: hot, tier: "memory" };
+
+  const cold = await readBlob(key);
+  if (cold) {
+    memory.set(key, cold);
+    return { key, audio: cold, tier: "disk" };
+  }
+
+  return null;
+}
+
+/**
+ * Store synthesized audio in both tiers
+ */
+export async function putCachedTts(key: string, audio: Buffer): Promise<void> {
+  memory.set(key, audio);
+  await writeBlob(key, audio);
+}
+
+/**
+ * Text-to-speech through the cache
+ * Concurrent misses for the same key share one ElevenLabs request. Mock audio
+ * (no API key or upstream failure) is returned but never cached.
+ */
+export async function ttsSpeakCached(
+  text: string,
+  options: TTSOptions = {}
+): Promise<CachedAudio> {
+  const key = ttsCacheKey(text, options);
+
+  const cached = await getCachedTts(key);
+  if (cached) return cached;
+
+  const inflight = pending.get(key);
+  if (inflight) return inflight;
+
+  const work = (async (): Promise<CachedAudio> => {
+    if (!process.env.ELEVENLABS_API_KEY) {
+      return { key, audio: Buffer.from(createMockAudio(text)), tier: "mock" };
+    }
+    try {
+      const audio = await requestTts(text, resolveTtsOptions(options));
+      await putCachedTts(key, audio);
+      return { key, audio, tier: "origin" };
+    } catch (error) {
+      packageLog.error("ElevenLabs TTS error", { error });
+      return { key, audio: Buffer.from(createMockAudio(text)), tier: "mock" };
+    }
+  })();
+
+  pending.set(key, work);
+  try {
+    return await work;
+  } finally {
+    pending.delete(key);
+  }
+}
+
+/**
+ * Pre-render a prompt catalog so fixed exam instructions never hit ElevenLabs
+ * on the request path. Runs sequentially to stay inside upstream rate limits.
+ */
+export async function warmTtsCache(
+  prompts: readonly string[],
+  voiceIds: readonly (string | undefined)[] = [undefined]
+): Promise<{ rendered: number; cached: number; failed: number }> {
+  const stats = { rendered: 0, cached: 0, failed: 0 };
+  if (!process.env.ELEVENLABS_API_KEY) return stats;
+
+  for (const voiceId of voiceIds) {
+    for (const text of prompts) {
+      const result = await ttsSpeakCached(text, { voiceId });
+      if (result.tier === "origin") stats.rendered++;
+      else if (result.tier === "mock") stats.failed++;
+      else stats.cached++;
+    }
+  }
+
+  return stats;
+}
@@ -1,5 +1,6 @@
 import React, { useEffect, useState } from 'react'
 import Glass from './Glass'
+import PreCorrectionCanvas from './PreCorrectionCanvas'
 
 // Import calc functions if available
 const calculateBlurRadius = (sphere, distanceMeters, pupilDiameter = 4) => {
@@ -22,6 +23,7 @@ const calculateSphericalEquivalent = (sphere, cylinder) => {
 
 export default function Overlay({ sphere, cylinder, axis, distance }) {
   const [calculations, setCalculations] = useState(null)
+  const [gpuActive, setGpuActive] = useState(false)
 
   useEffect(() => {
     // Calculate all optical parameters
@@ -54,6 +56,8 @@ export default function Overlay({ sphere, cylinder, axis, distance }) {
   // Higher spherical equivalent (more myopic) -> cooler/bluer tint
   // Higher blur -> more opacity
   const getBackgroundStyle = () => {
+    // The GPU path shows the corrected screen itself, so no tint on top
+    if (gpuActive) return 'transparent';
     if (!calculations) return 'rgba(50, 50, 50, 0.5)';
     
     const { sphericalEquivalent, blurRadius } = calculations;
@@ -85,6 +89,13 @@ export default function Overlay({ sphere, cylinder, axis, distance }) {
       pointerEvents: 'none',
       position: 'relative'
     }}>
+      <PreCorrectionCanvas
+        sphere={sphere}
+        cylinder={cylinder}
+        axis={axis}
+        distance={distance}
+        onStatusChange={setGpuActive}
+      />
       {/* <Glass></Glass> */}
       {/* Top-left display */}
       <div style={{ 
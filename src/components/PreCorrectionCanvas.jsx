@@ -0,0 +1,112 @@
+import { useEffect, useMemo, useRef, useState } from 'react';
+import { PreCorrectionRenderer, buildPreCorrectionPasses } from '../render/preCorrectionRenderer';
+
+/**
+ * Full-screen GPU pre-correction of the captured screen
+ * Captures the display (getDisplayMedia, answered by the Electron main process),
+ * renders each new video frame through PreCorrectionRenderer, and reports
+ * whether it is active so Overlay can fall back to the tint.
+ */
+export default function PreCorrectionCanvas({ sphere, cylinder, axis, distance, onStatusChange }) {
+  const canvasRef = useRef(null);
+  const rendererRef = useRef(null);
+  const [active, setActive] = useState(false);
+
+  // Kernel weights only change with the Rx, not per frame
+  const settings = useMemo(
+    () => buildPreCorrectionPasses(sphere, cylinder, axis, distance),
+    [sphere, cylinder, axis, distance]
+  );
+
+  useEffect(() => {
+    rendererRef.current?.setSettings(settings);
+    // Warm the kernels one slider step away so the next drag step is a cache hit
+    window.MyopiaCorrection?.precomputeNeighborKernels({ sphere, cylinder, axis, distanceCm: distance });
+  }, [settings, sphere, cylinder, axis, distance]);
+
+  useEffect(() => {
+    onStatusChange?.(active);
+  }, [active, onStatusChange]);
+
+  useEffect(() => {
+    if (!window.electronAPI || !navigator.mediaDevices?.getDisplayMedia) return;
+
+    let cancelled = false;
+    let stream = null;
+    let frameHandle = null;
+    const video = document.createElement('video');
+    video.muted = true;
+    video.playsInline = true;
+
+    // Prefer per-video-frame callbacks: no work when the screen is static
+    const scheduleFrame = () => {
+      if (video.requestVideoFrameCallback) {
+        frameHandle = video.requestVideoFrameCallback(drawFrame);
+      } else {
+        frameHandle = requestAnimationFrame(drawFrame);
+      }
+    };
+
+    const drawFrame = () => {
+      if (cancelled) return;
+      rendererRef.current?.render(video);
+      scheduleFrame();
+    };
+
+    const start = async () => {
+      try {
+        rendererRef.current = new PreCorrectionRenderer(canvasRef.current);
+        rendererRef.current.setSettings(settings);
+
+        stream = await navigator.mediaDevices.getDisplayMedia({
+          video: { frameRate: { ideal: 60 } },
+          audio: false,
+        });
+        if (cancelled) {
+          // Unmounted while the capture was pending (e.g. StrictMode's first mount)
+          stream.getTracks().forEach((track) => track.stop());
+          return;
+        }
+
+        video.srcObject = stream;
+        await video.play();
+        setActive(true);
+        scheduleFrame();
+        window.electronAPI.log('🖥️ GPU pre-correction active');
+      } catch (error) {
+        console.warn('GPU pre-correction unavailable, using tint fallback:', error);
+        setActive(false);
+      }
+    };
+
+    start();
+
+    return () => {
+      cancelled = true;
+      if (frameHandle !== null) {
+        if (video.cancelVideoFrameCallback) video.cancelVideoFrameCallback(frameHandle);
+        else cancelAnimationFrame(frameHandle);
+      }
+      stream?.getTracks().forEach((track) => track.stop());
+      rendererRef.current?.dispose();
+      rendererRef.current = null;
+    };
+    // The capture and GL context live for the component's lifetime; settings
+    // updates go through setSettings above
+    // eslint-disable-next-line react-hooks/exhaustive-deps
+  }, []);
+
+  return (
+    <canvas
+      ref={canvasRef}
+      style={{
+        position: 'fixed',
+        inset: 0,
+        width: '100%',
+        height: '100%',
+        pointerEvents: 'none',
+        visibility: active ? 'visible' : 'hidden',
+      }}
+    />
+  );
+}
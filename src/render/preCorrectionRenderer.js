@@ -0,0 +1,309 @@
+/**
+ * WebGL2 pre-correction renderer
+ *
+ * Applies the calc.js pre-correction to a video source (the captured screen)
+ * on the GPU as three full-screen passes:
+ *   1. 1D Gaussian blur along the first principal meridian   source → A
+ *   2. 1D Gaussian blur along the second principal meridian  A → B
+ *   3. Unsharp combine: source + amount · (source − B)        → canvas
+ * A rotated anisotropic Gaussian is separable along its own axes, so two
+ * directional passes give O(k) work per pixel at any axis. Tap weights are
+ * uniforms; programs are compiled once per tap count and cached.
+ */
+
+import '../../calc.js';
+
+// Longest blur we run at full resolution (taps per side before pair merging)
+const MAX_RADIUS = 48;
+
+const VERTEX_SHADER = `#version 300 es
+out vec2 vUv;
+void main() {
+  // Full-screen triangle from gl_VertexID, no vertex buffers
+  vec2 p = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+  vUv = p;
+  gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}`;
+
+function blurShader(fetches) {
+  return `#version 300 es
+precision highp float;
+uniform sampler2D uSource;
+uniform vec2 uStep;
+uniform float uWeights[${fetches}];
+uniform float uOffsets[${fetches}];
+in vec2 vUv;
+out vec4 outColor;
+void main() {
+  vec4 sum = vec4(0.0);
+  for (int i = 0; i < ${fetches}; i++) {
+    sum += texture(uSource, vUv + uStep * uOffsets[i]) * uWeights[i];
+  }
+  outColor = sum;
+}`;
+}
+
+const COMBINE_SHADER = `#version 300 es
+precision highp float;
+uniform sampler2D uSource;
+uniform sampler2D uBlurred;
+uniform float uAmount;
+in vec2 vUv;
+out vec4 outColor;
+void main() {
+  vec3 source = texture(uSource, vUv).rgb;
+  vec3 blurred = texture(uBlurred, vUv).rgb;
+  outColor = vec4(clamp(source + uAmount * (source - blurred), 0.0, 1.0), 1.0);
+}`;
+
+/**
+ * Fold symmetric 1D taps into bilinear fetches: adjacent taps (i, i+1) become
+ * one sample between them, roughly halving texture reads
+ *
+ * @param {Float32Array} taps - Odd-length normalized taps
+ * @returns {{weights: Float32Array, offsets: Float32Array}} Fetch weights/offsets in texels
+ */
+export function mergeTapsForLinearSampling(taps) {
+  const radius = Math.floor(taps.length / 2);
+  const pairs = Math.ceil(radius / 2);
+  const weights = new Float32Array(1 + 2 * pairs);
+  const offsets = new Float32Array(1 + 2 * pairs);
+
+  weights[0] = taps[radius];
+  for (let p = 0; p < pairs; p++) {
+    const i = 1 + 2 * p;
+    const w1 = taps[radius + i];
+    const w2 = i + 1 <= radius ? taps[radius + i + 1] : 0;
+    const weight = w1 + w2;
+    const offset = weight > 0 ? (i * w1 + (i + 1) * w2) / weight : i;
+
+    weights[1 + 2 * p] = weight;
+    offsets[1 + 2 * p] = offset;
+    weights[2 + 2 * p] = weight;
+    offsets[2 + 2 * p] = -offset;
+  }
+
+  return { weights, offsets };
+}
+
+/**
+ * Pre-correction pass parameters from the Rx, via calc.js
+ * Only depends on sphere/cylinder/axis/distance, so callers memoize on those;
+ * the kernels behind it come from calc.js's quantized kernel cache.
+ */
+export function buildPreCorrectionPasses(sphere, cylinder, axis, distance) {
+  const calc = window.MyopiaCorrection;
+  const pre = calc.getPreCorrection(sphere, cylinder, distance, axis);
+
+  const tapsFor = (sigma) => {
+    const radius = Math.min(MAX_RADIUS, Math.ceil(sigma * 3));
+    return mergeTapsForLinearSampling(calc.gaussian1D(sigma, radius * 2 + 1));
+  };
+
+  // Same principal axes as generateAnisotropicKernel: σH along (cos, −sin), σV along (sin, cos)
+  const angle = (pre.axis * Math.PI) / 180;
+  const kernel = pre.preCorrectionKernel;
+  const amount = (kernel.data[4] - 1) / 4; // centre tap is 1 + 4·strength
+
+  return {
+    amount,
+    passes: [
+      { direction: [Math.cos(angle), -Math.sin(angle)], ...tapsFor(pre.sigmaH) },
+      { direction: [Math.sin(angle), Math.cos(angle)], ...tapsFor(pre.sigmaV) },
+    ],
+  };
+}
+
+function compile(gl, type, source) {
+  const shader = gl.createShader(type);
+  gl.shaderSource(shader, source);
+  gl.compileShader(shader);
+  if (!gl.getShaderParameter(shader, gl.COMPILE_STATUS)) {
+    const log = gl.getShaderInfoLog(shader);
+    gl.deleteShader(shader);
+    throw new Error(`Shader compile failed: ${log}`);
+  }
+  return shader;
+}
+
+function link(gl, vertexShader, fragmentSource) {
+  const program = gl.createProgram();
+  const fragment = compile(gl, gl.FRAGMENT_SHADER, fragmentSource);
+  gl.attachShader(program, vertexShader);
+  gl.attachShader(program, fragment);
+  gl.linkProgram(program);
+  gl.deleteShader(fragment);
+  if (!gl.getProgramParameter(program, gl.LINK_STATUS)) {
+    throw new Error(`Program link failed: ${gl.getProgramInfoLog(program)}`);
+  }
+  return program;
+}
+
+function createTargetTexture(gl) {
+  const texture = gl.createTexture();
+  gl.bindTexture(gl.TEXTURE_2D, texture);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.LINEAR);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.LINEAR);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+  return texture;
+}
+
+export class PreCorrectionRenderer {
+  /**
+   * @param {HTMLCanvasElement} canvas - Output canvas
+   */
+  constructor(canvas) {
+    const gl = canvas.getContext('webgl2', {
+      alpha: true,
+      antialias: false,
+      depth: false,
+      stencil: false,
+      premultipliedAlpha: true,
+      preserveDrawingBuffer: false,
+      desynchronized: true,
+      powerPreference: 'high-performance',
+    });
+    if (!gl) {
+      throw new Error('WebGL2 is not available');
+    }
+
+    this.canvas = canvas;
+    this.gl = gl;
+    this.width = 0;
+    this.height = 0;
+    this.settings = null;
+    this.blurPrograms = new Map();
+
+    this.vertexShader = compile(gl, gl.VERTEX_SHADER, VERTEX_SHADER);
+    const combine = link(gl, this.vertexShader, COMBINE_SHADER);
+    this.combine = {
+      program: combine,
+      uSource: gl.getUniformLocation(combine, 'uSource'),
+      uBlurred: gl.getUniformLocation(combine, 'uBlurred'),
+      uAmount: gl.getUniformLocation(combine, 'uAmount'),
+    };
+    this.vao = gl.createVertexArray();
+
+    this.sourceTexture = createTargetTexture(gl);
+    this.targets = [0, 1].map(() => ({
+      texture: createTargetTexture(gl),
+      framebuffer: gl.createFramebuffer(),
+    }));
+
+    gl.pixelStorei(gl.UNPACK_FLIP_Y_WEBGL, true);
+  }
+
+  /**
+   * Blur program for a fetch count (compiled on first use, then cached)
+   */
+  blurProgram(fetches) {
+    let entry = this.blurPrograms.get(fetches);
+    if (!entry) {
+      const { gl } = this;
+      const program = link(gl, this.vertexShader, blurShader(fetches));
+      entry = {
+        program,
+        uSource: gl.getUniformLocation(program, 'uSource'),
+        uStep: gl.getUniformLocation(program, 'uStep'),
+        uWeights: gl.getUniformLocation(program, 'uWeights'),
+        uOffsets: gl.getUniformLocation(program, 'uOffsets'),
+      };
+      this.blurPrograms.set(fetches, entry);
+    }
+    return entry;
+  }
+
+  /**
+   * Set pass parameters from buildPreCorrectionPasses()
+   * Warms the program cache so the next frame never compiles.
+   */
+  setSettings(settings) {
+    this.settings = settings;
+    for (const pass of settings.passes) {
+      this.blurProgram(pass.weights.length);
+    }
+  }
+
+  resize(width, height) {
+    if (width === this.width && height === this.height) return;
+
+    const { gl } = this;
+    this.width = width;
+    this.height = height;
+    this.canvas.width = width;
+    this.canvas.height = height;
+
+    for (const target of this.targets) {
+      gl.bindTexture(gl.TEXTURE_2D, target.texture);
+      gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA8, width, height, 0, gl.RGBA, gl.UNSIGNED_BYTE, null);
+      gl.bindFramebuffer(gl.FRAMEBUFFER, target.framebuffer);
+      gl.framebufferTexture2D(gl.FRAMEBUFFER, gl.COLOR_ATTACHMENT0, gl.TEXTURE_2D, target.texture, 0);
+    }
+    gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+  }
+
+  /**
+   * Render one frame of a video source through the pre-correction passes
+   *
+   * @param {HTMLVideoElement} video - Frame source (videoWidth/videoHeight sized)
+   */
+  render(video) {
+    const { gl, settings } = this;
+    if (!settings || !video.videoWidth) return;
+
+    this.resize(video.videoWidth, video.videoHeight);
+    gl.viewport(0, 0, this.width, this.height);
+    gl.bindVertexArray(this.vao);
+
+    gl.activeTexture(gl.TEXTURE0);
+    gl.bindTexture(gl.TEXTURE_2D, this.sourceTexture);
+    gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, gl.RGBA, gl.UNSIGNED_BYTE, video);
+
+    // Directional blur passes, ping-ponging between the two targets
+    let input = this.sourceTexture;
+    settings.passes.forEach((pass, i) => {
+      const target = this.targets[i % 2];
+      const blur = this.blurProgram(pass.weights.length);
+
+      gl.bindFramebuffer(gl.FRAMEBUFFER, target.framebuffer);
+      gl.useProgram(blur.program);
+      gl.activeTexture(gl.TEXTURE0);
+      gl.bindTexture(gl.TEXTURE_2D, input);
+      gl.uniform1i(blur.uSource, 0);
+      gl.uniform2f(blur.uStep, pass.direction[0] / this.width, pass.direction[1] / this.height);
+      gl.uniform1fv(blur.uWeights, pass.weights);
+      gl.uniform1fv(blur.uOffsets, pass.offsets);
+      gl.drawArrays(gl.TRIANGLES, 0, 3);
+
+      input = target.texture;
+    });
+
+    // Unsharp combine straight into the canvas
+    const { combine } = this;
+    gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+    gl.useProgram(combine.program);
+    gl.activeTexture(gl.TEXTURE0);
+    gl.bindTexture(gl.TEXTURE_2D, this.sourceTexture);
+    gl.uniform1i(combine.uSource, 0);
+    gl.activeTexture(gl.TEXTURE1);
+    gl.bindTexture(gl.TEXTURE_2D, input);
+    gl.uniform1i(combine.uBlurred, 1);
+    gl.uniform1f(combine.uAmount, settings.amount);
+    gl.drawArrays(gl.TRIANGLES, 0, 3);
+  }
+
+  dispose() {
+    const { gl } = this;
+    for (const { program } of this.blurPrograms.values()) gl.deleteProgram(program);
+    gl.deleteProgram(this.combine.program);
+    gl.deleteShader(this.vertexShader);
+    gl.deleteTexture(this.sourceTexture);
+    for (const target of this.targets) {
+      gl.deleteTexture(target.texture);
+      gl.deleteFramebuffer(target.framebuffer);
+    }
+    gl.deleteVertexArray(this.vao);
+    this.blurPrograms.clear();
+  }
+}